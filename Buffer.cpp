@@ -6,10 +6,115 @@
  * Created on December 1, 2018, 10:48 PM
  */
 
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <algorithm>
 #include <cassert>
+#include <ostream>
+
+#include "bounded_queue.h"
 
 #include "Buffer.h"
 
+// echo/barrier/header only, flow_mod/group_mod, small packet_out, maximum sized packet_out
+const std::array<Buffer::class_t,Buffer::nClasses> Buffer::rClass = {{
+  {    64, 32, 16 },
+  {   512, 32,  8 },
+  {  2048, 16,  8 },
+  { 66000,  4,  4 }
+}};
+
+namespace {
+
+  typedef std::vector<vByte_t> magazine_t;
+
+  struct depot_t {
+    BoundedQueue<magazine_t> qFull;
+    BoundedQueue<magazine_t> qEmpty; // recycled magazine storage
+    std::atomic<uint64_t> nFill;
+    std::atomic<uint64_t> nMiss;
+    std::atomic<uint64_t> nSpill;
+    std::atomic<uint64_t> nReleased;
+    std::atomic<uint64_t> nFull;
+    std::atomic<uint64_t> nObtained; // by threads which have exited
+    std::atomic<uint64_t> nAdded;
+    depot_t( size_t nDepot )
+    : qFull( nDepot ), qEmpty( nDepot ),
+      nFill( 0 ), nMiss( 0 ), nSpill( 0 ), nReleased( 0 ), nFull( 0 ),
+      nObtained( 0 ), nAdded( 0 )
+    {}
+  };
+
+  typedef std::array<std::unique_ptr<depot_t>,Buffer::nClasses> rDepot_t;
+
+  rDepot_t& Depot() {
+    static rDepot_t rDepot = [](){
+      rDepot_t rDepot;
+      for ( size_t ix = 0; ix < Buffer::nClasses; ix++ ) {
+        rDepot[ ix ] = std::make_unique<depot_t>( Buffer::rClass[ ix ].nDepot );
+      }
+      return rDepot;
+    }();
+    return rDepot;
+  }
+
+  std::atomic<uint64_t> nOversize( 0 );
+
+  // a count written only by its own thread, so a relaxed load and store, no locked add
+  struct counter_t {
+    std::atomic<uint64_t> n;
+    counter_t(): n( 0 ) {}
+    void Increment() { n.store( n.load( std::memory_order_relaxed ) + 1, std::memory_order_relaxed ); }
+    uint64_t Load() const { return n.load( std::memory_order_relaxed ); }
+  };
+
+  struct cache_t;
+
+  // live thread caches, for Stats(), the lock is taken as threads start and exit, not per buffer
+  struct registry_t {
+    std::mutex mutex;
+    std::vector<const cache_t*> vCache;
+  };
+
+  registry_t& Registry() {
+    static registry_t registry;
+    return registry;
+  }
+
+  // the loaded magazine, per class, of the current thread
+  struct cache_t {
+    std::array<magazine_t,Buffer::nClasses> rLoaded;
+    std::array<counter_t,Buffer::nClasses> rObtained;
+    std::array<counter_t,Buffer::nClasses> rAdded;
+    cache_t() {
+      for ( size_t ix = 0; ix < Buffer::nClasses; ix++ ) {
+        rLoaded[ ix ].reserve( Buffer::rClass[ ix ].nMagazine );
+      }
+      registry_t& registry( Registry() );
+      std::lock_guard<std::mutex> lock( registry.mutex );
+      registry.vCache.push_back( this );
+    }
+    ~cache_t() { // thread is exiting, hand its idle buffers and its counts over
+      registry_t& registry( Registry() );
+      std::lock_guard<std::mutex> lock( registry.mutex );
+      for ( size_t ix = 0; ix < Buffer::nClasses; ix++ ) {
+        depot_t& depot( *Depot()[ ix ] );
+        if ( !rLoaded[ ix ].empty() ) {
+          if ( depot.qFull.Push( rLoaded[ ix ] ) ) depot.nFull++;
+        }
+        depot.nObtained.fetch_add( rObtained[ ix ].Load(), std::memory_order_relaxed );
+        depot.nAdded.fetch_add( rAdded[ ix ].Load(), std::memory_order_relaxed );
+      }
+      registry.vCache.erase( std::find( registry.vCache.begin(), registry.vCache.end(), this ) );
+    }
+  };
+
+  thread_local cache_t cache;
+
+} // namespace anon
+
 //Buffer::Buffer( asio::io_context::strand& strand )
 //: m_strandBufferOps( strand )
 //{
@@ -19,30 +124,112 @@ Buffer::Buffer() {}
 
 Buffer::~Buffer() {}
 
-vByte_t Buffer::ObtainBuffer() {
-  //std::unique_lock<std::mutex> lock( m_mutex );
-  if ( m_qBuffersAvailable.empty() ) {
-    vByte_t v;
-    v.reserve( 66000 );
-    m_qBuffersAvailable.push( std::move( v ) );
+vByte_t Buffer::ObtainBuffer( size_t nOctets ) {
+  size_t ix( 0 );
+  while ( ( nClasses > ix ) && ( rClass[ ix ].nOctets < nOctets ) ) ix++;
+  vByte_t vByte;
+  if ( nClasses == ix ) { // bigger than anything pooled
+    nOversize.fetch_add( 1, std::memory_order_relaxed );
+    vByte.reserve( nOctets );
+  }
+  else {
+    magazine_t& magazine( cache.rLoaded[ ix ] );
+    if ( magazine.empty() ) {
+      depot_t& depot( *Depot()[ ix ] );
+      magazine_t full;
+      if ( depot.qFull.Pop( full ) ) {
+        depot.nFull--;
+        depot.nFill.fetch_add( 1, std::memory_order_relaxed );
+        std::swap( magazine, full );
+        depot.qEmpty.Push( full ); // keep the storage, freed if there is no room
+      }
+      else {
+        depot.nMiss.fetch_add( 1, std::memory_order_relaxed );
+        vByte.reserve( rClass[ ix ].nOctets );
+        return vByte;
+      }
+    }
+    vByte = std::move( magazine.back() );
+    magazine.pop_back();
+    cache.rObtained[ ix ].Increment();
   }
-  vByte_t vByte = std::move( m_qBuffersAvailable.front() );
-  m_qBuffersAvailable.pop();
   return vByte;
 }
 
 void Buffer::AddBuffer( vByte_t& vByte) {
-  //std::unique_lock<std::mutex> lock( m_mutex );
   //vByte.clear(); // don't do this as this is used for queued storage
-  assert( 66000 <= vByte.capacity() );
-  m_qBuffersAvailable.push( std::move( vByte ) );
+  // file under the largest class the buffer can still satisfy
+  const size_t capacity = vByte.capacity();
+  size_t ix( nClasses );
+  while ( ( 0 < ix ) && ( rClass[ ix - 1 ].nOctets > capacity ) ) ix--;
+  if ( 0 == ix ) { // too small to be worth keeping
+    vByte_t().swap( vByte );
+  }
+  else {
+    ix--;
+    magazine_t& magazine( cache.rLoaded[ ix ] );
+    if ( rClass[ ix ].nMagazine == magazine.size() ) {
+      depot_t& depot( *Depot()[ ix ] );
+      magazine_t empty;
+      if ( !depot.qEmpty.Pop( empty ) ) {
+        empty.reserve( rClass[ ix ].nMagazine );
+      }
+      std::swap( magazine, empty ); // 'empty' is now the full one
+      if ( depot.qFull.Push( empty ) ) {
+        depot.nFull++;
+        depot.nSpill.fetch_add( 1, std::memory_order_relaxed );
+      }
+      else {
+        depot.nReleased.fetch_add( empty.size(), std::memory_order_relaxed ); // freed on scope exit
+      }
+    }
+    magazine.emplace_back( std::move( vByte ) );
+    cache.rAdded[ ix ].Increment();
+  }
+}
+
+Buffer::rStats_t Buffer::Stats() {
+  rStats_t rStats;
+  registry_t& registry( Registry() );
+  std::lock_guard<std::mutex> lock( registry.mutex ); // threads neither come nor go while summing
+  for ( size_t ix = 0; ix < nClasses; ix++ ) {
+    const depot_t& depot( *Depot()[ ix ] );
+    stats_t& stats( rStats[ ix ] );
+    stats.nObtained = depot.nObtained.load( std::memory_order_relaxed );
+    stats.nAdded = depot.nAdded.load( std::memory_order_relaxed );
+    for ( const cache_t* pCache: registry.vCache ) {
+      stats.nObtained += pCache->rObtained[ ix ].Load();
+      stats.nAdded += pCache->rAdded[ ix ].Load();
+    }
+    stats.nFill = depot.nFill.load( std::memory_order_relaxed );
+    stats.nMiss = depot.nMiss.load( std::memory_order_relaxed );
+    stats.nSpill = depot.nSpill.load( std::memory_order_relaxed );
+    stats.nReleased = depot.nReleased.load( std::memory_order_relaxed );
+    stats.nFull = depot.nFull.load( std::memory_order_relaxed );
+  }
+  return rStats;
 }
 
-bool Buffer::Empty() {
-  //std::unique_lock<std::mutex> lock( m_mutex );
-  return m_qBuffersAvailable.empty();
+uint64_t Buffer::Oversize() {
+  return nOversize.load( std::memory_order_relaxed );
 }
 
-const vByte_t& Buffer::Front() const {
-  return m_qBuffersAvailable.front();
-}
\ No newline at end of file
+std::ostream& operator<<( std::ostream& os, const Buffer& ) {
+  const Buffer::rStats_t rStats( Buffer::Stats() );
+  for ( size_t ix = 0; ix < Buffer::nClasses; ix++ ) {
+    const Buffer::stats_t& stats( rStats[ ix ] );
+    os
+      << ( ( 0 == ix ) ? "" : "; " )
+      << Buffer::rClass[ ix ].nOctets
+      << ":obtained=" << stats.nObtained
+      << ",added=" << stats.nAdded
+      << ",fill=" << stats.nFill
+      << ",miss=" << stats.nMiss
+      << ",spill=" << stats.nSpill
+      << ",released=" << stats.nReleased
+      << ",full=" << stats.nFull
+      ;
+  }
+  os << "; oversize=" << Buffer::Oversize();
+  return os;
+}
@@ -9,16 +9,14 @@
 #ifndef BUFFER_H
 #define BUFFER_H
 
-#include <queue>
-#include <mutex>
+#include <array>
+#include <iosfwd>
 
 //#include <boost/asio/io_context.hpp>
 //#include <boost/asio/strand.hpp>
 
 #include "common.h"
 
-// TODO: make use of strand to obtain and return buffers
-//       use flags to ensure xor(strand, mutex) use
 // TODO: can functions be defined which accept/disseminate buffers and a follow on function?
 //    use template?  Issue is that it needs to be quick in, quick out.  So supplied
 //    function will need to be run in a generic or self-assigned thread
@@ -26,17 +24,49 @@
 
 //namespace asio = boost::asio;
 
+// pool of buffers, in a few size classes so a short message does not pin a jumbo buffer
+//   buffers are shared process wide, no locks are taken:
+//     each thread caches a magazine of idle buffers per class,
+//     an empty magazine is swapped for a full one from a lock-free depot,
+//     a full magazine is swapped into the depot for an empty one,
+//     a full magazine which does not fit in the depot is freed (the high water mark)
+//   a buffer obtained on one thread and added back on another simply
+//     lands in the second thread's magazine
+
 class Buffer {
 public:
 
+  enum { nClasses = 4 };
+
+  struct class_t {
+    size_t nOctets;   // capacity reserved for buffers in this class
+    size_t nMagazine; // buffers per magazine
+    size_t nDepot;    // full magazines kept in the depot, power of two
+  };
+
+  struct stats_t {
+    uint64_t nObtained; // handed out of a thread's magazine
+    uint64_t nAdded;    // taken back into a thread's magazine
+    uint64_t nFill;     // empty magazine exchanged for a full one
+    uint64_t nMiss;     // newly allocated, nothing in the depot
+    uint64_t nSpill;    // full magazine handed to the depot
+    uint64_t nReleased; // buffers freed as the depot was full
+    uint64_t nFull;     // full magazines currently in the depot
+  };
+
+  typedef std::array<stats_t,nClasses> rStats_t;
+
+  static const std::array<class_t,nClasses> rClass;
+
   Buffer();
   //Buffer( asio::io_context::strand& strand );
   virtual ~Buffer();
 
-  vByte_t ObtainBuffer();
+  vByte_t ObtainBuffer( size_t nOctets ); // size hint, buffer is empty with at least this capacity
   void AddBuffer( vByte_t& );
-  bool Empty();
-  const vByte_t& Front() const;
+
+  static rStats_t Stats();
+  static uint64_t Oversize();
 
   //asio::io_context::strand& Strand() { return m_strandBufferOps; }
 
@@ -45,17 +75,11 @@ private:
 
   //asio::io_context::strand m_strandBufferOps;
 
-  // TODO: might be better to maintain the lock outside of here
-  //std::mutex m_mutex;
-
-  typedef std::queue<vByte_t> qBuffers_t;
-
-  qBuffers_t m_qBuffersAvailable;
-  //qBuffers_t m_qTxBuffersToBeWritten;
-
   Buffer( const Buffer& ) = delete;
 
 };
 
+std::ostream& operator<<( std::ostream&, const Buffer& );
+
 #endif /* BUFFER_H */
 
@@ -0,0 +1,54 @@
+/*
+ * File:   allocations.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 9:20 AM
+ */
+
+#include <new>
+#include <atomic>
+#include <cstdlib>
+
+#include "allocations.h"
+
+namespace {
+
+  // counted only while started, otherwise costs a relaxed load
+  std::atomic<bool> bCount( false );
+  std::atomic<uint64_t> nCount( 0 );
+
+} // namespace anon
+
+namespace allocations {
+
+  void Start() {
+    nCount.store( 0 );
+    bCount.store( true );
+  }
+
+  uint64_t Stop() {
+    bCount.store( false );
+    return nCount.load();
+  }
+
+} // namespace allocations
+
+// counting replacements for the global allocator,
+//   the array and nothrow forms default to these
+void* operator new( std::size_t n ) {
+  if ( bCount.load( std::memory_order_relaxed ) ) {
+    nCount.fetch_add( 1, std::memory_order_relaxed );
+  }
+  void* p = std::malloc( ( 0 == n ) ? 1 : n );
+  if ( nullptr == p ) throw std::bad_alloc();
+  return p;
+}
+
+void operator delete( void* p ) noexcept {
+  std::free( p );
+}
+
+void operator delete( void* p, std::size_t ) noexcept {
+  std::free( p );
+}
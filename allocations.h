@@ -0,0 +1,25 @@
+/*
+ * File:   allocations.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 9:20 AM
+ */
+
+#ifndef ALLOCATIONS_H
+#define ALLOCATIONS_H
+
+#include <cstdint>
+
+// Counts calls to the global operator new, on all threads, between Start() and Stop().
+//   allocations.cpp replaces the global operator new and delete to do so; it is linked
+//   into the bench_* programs only, cppofc keeps the library allocator untouched.
+
+namespace allocations {
+
+  void Start();    // clears the count
+  uint64_t Stop(); // calls since Start()
+
+} // namespace allocations
+
+#endif /* ALLOCATIONS_H */
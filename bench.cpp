@@ -0,0 +1,75 @@
+/*
+ * File:   bench.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+#include <atomic>
+#include <cstdlib>
+
+#include <sys/socket.h>
+
+#include "bench.h"
+
+namespace bench {
+
+size_t Arg( int argc, char** argv, int ix, size_t nDefault ) {
+  return ( ix < argc ) ? std::atoi( argv[ ix ] ) : nDefault;
+}
+
+clock_t::time_point Together( size_t nThreads, std::function<void(size_t)> f ) {
+
+  std::atomic<size_t> nReady( 0 );
+  std::atomic<bool> bGo( false );
+  std::vector<std::thread> vThread;
+  for ( size_t ixThread = 0; ixThread < nThreads; ixThread++ ) {
+    vThread.emplace_back(
+      [&,ixThread](){
+        nReady.fetch_add( 1 );
+        while ( !bGo.load( std::memory_order_acquire ) ) std::this_thread::yield();
+        f( ixThread );
+      } );
+  }
+  while ( nThreads > nReady.load() ) std::this_thread::yield();
+
+  const clock_t::time_point tpStart = clock_t::now();
+  bGo.store( true, std::memory_order_release );
+  for ( std::thread& thread: vThread ) thread.join();
+
+  return tpStart;
+}
+
+namespace ip = boost::asio::ip;
+
+Loopback::Loopback()
+: m_acceptor( m_io, ip::tcp::endpoint( ip::address_v4::loopback(), 0 ) ),
+  m_socketSwitch( m_io ), m_socketSession( m_io ),
+  m_bStopped( false )
+{
+  m_socketSwitch.connect( m_acceptor.local_endpoint() );
+  m_socketSwitch.set_option( ip::tcp::no_delay( true ) );
+  m_acceptor.accept( m_socketSession );
+}
+
+Loopback::~Loopback() {
+  Stop();
+}
+
+void Loopback::Run() {
+  for ( size_t ix = 0; ix < io_threads; ix++ ) {
+    m_vThreadIo.emplace_back( [this](){ m_io.run(); } );
+  }
+}
+
+void Loopback::Stop() {
+  if ( !m_bStopped ) {
+    m_bStopped = true;
+    m_io.stop();
+    for ( std::thread& thread: m_vThreadIo ) thread.join();
+    ::shutdown( m_socketSwitch.native_handle(), SHUT_RDWR );
+  }
+}
+
+} // namespace bench
@@ -0,0 +1,84 @@
+/*
+ * File:   bench.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+#include <boost/asio/io_context.hpp>
+#include <boost/asio/ip/tcp.hpp>
+
+// What the bench_* programs share, none of it is in cppofc:
+//   bench_replay     a recording through a tcp_session, replay.h
+//   bench_match      the packet_in match decoder, over a recording's packet_ins
+//   bench_async      a recording's asynchronous messages against the OFPT_SET_ASYNC policy
+//   bench_multipart  a synthetic flow table dump through the multipart engine
+//   bench_learning   packet_in per new flow, mac learning in the controller or the switch
+//   bench_transmit   producer threads contending for one session's transmit queue
+//   bench_buffers    the buffer pool as threads are added
+//   bench_builder    a flow_mod grown with ofp::Append against one sized once with ofp::Builder
+// Each is linked with allocations.o, which counts operator new.
+
+namespace bench {
+
+  typedef std::chrono::steady_clock clock_t;
+
+  inline double Seconds( clock_t::time_point tpBegin, clock_t::time_point tpEnd = clock_t::now() ) {
+    return std::chrono::duration<double>( tpEnd - tpBegin ).count();
+  }
+
+  inline double PerSecond( uint64_t n, double dSeconds ) { return ( 0.0 == dSeconds ) ? 0.0 : n / dSeconds; }
+
+  // argv[ ix ] as a count, nDefault when not given
+  size_t Arg( int argc, char** argv, int ix, size_t nDefault );
+
+  // nThreads run f( ix ) each, released together once all have started, joined before returning;
+  //   the time point is the release, f is timed from there
+  clock_t::time_point Together( size_t nThreads, std::function<void(size_t)> f );
+
+  // a connected loopback pair standing in for a switch and its connection to the controller:
+  //   the session end is moved into a tcp_session, the switch end is read and written with plain calls
+  class Loopback {
+  public:
+
+    enum { io_threads = 4 }; // as many as Control runs
+
+    Loopback();
+    ~Loopback(); // Stop(), when not already
+
+    boost::asio::io_context& Io() { return m_io; }
+    boost::asio::ip::tcp::socket& Session() { return m_socketSession; }
+    int Switch() { return m_socketSwitch.native_handle(); }
+
+    void Run();  // the io threads
+    void Stop(); // stops and joins the io threads, then shuts the switch end, ending its reads
+
+  protected:
+  private:
+
+    boost::asio::io_context m_io;
+    boost::asio::ip::tcp::acceptor m_acceptor;
+    boost::asio::ip::tcp::socket m_socketSwitch;
+    boost::asio::ip::tcp::socket m_socketSession;
+
+    std::vector<std::thread> m_vThreadIo;
+    bool m_bStopped;
+
+    Loopback( const Loopback& ) = delete;
+
+  };
+
+} // namespace bench
+
+#endif /* BENCH_H */
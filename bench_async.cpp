@@ -0,0 +1,127 @@
+/*
+ * File:   bench_async.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Counts a recording's asynchronous messages, and how many the OFPT_SET_ASYNC policy
+//   tcp_session sends would have let through: bench_async <pcap or record file>
+
+#include <ostream>
+#include <iostream>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_async_config.h"
+
+#include "bench.h"
+#include "replay.h"
+#include "tcp_session.h"
+
+namespace {
+
+  struct async_stats_t {
+    enum { nKinds = 6 }; // packet_in, port_status, flow_removed, role_status, table_status, requestforward
+    struct count_t {
+      uint64_t nReceived; // in the recording
+      uint64_t nKept;     // with the policy
+      count_t(): nReceived( 0 ), nKept( 0 ) {}
+    };
+    uint64_t nMessages; // all of the recording's
+    count_t rKind[ nKinds ];
+    count_t total;
+    async_stats_t(): nMessages( 0 ) {}
+  };
+
+  // the master reasons property governing an asynchronous message, and its reason, false for other messages
+  bool AsyncReason( const vByte_t& message, ofp141::ofp_async_config_prop_type& type, uint8_t& reason ) {
+    typedef ofp141::ofp_async_config_prop_type prop;
+    const auto& header( *reinterpret_cast<const ofp141::ofp_header*>( message.data() ) );
+    const size_t nOctets( message.size() );
+    switch ( header.type ) {
+      case ofp141::ofp_type::OFPT_PACKET_IN:
+        if ( sizeof( ofp141::ofp_packet_in ) > nOctets ) return false;
+        type = prop::OFPACPT_PACKET_IN_MASTER;
+        reason = reinterpret_cast<const ofp141::ofp_packet_in&>( header ).reason;
+        return true;
+      case ofp141::ofp_type::OFPT_PORT_STATUS:
+        if ( sizeof( ofp141::ofp_header ) + 1 > nOctets ) return false;
+        type = prop::OFPACPT_PORT_STATUS_MASTER;
+        reason = reinterpret_cast<const ofp141::ofp_port_status&>( header ).reason;
+        return true;
+      case ofp141::ofp_type::OFPT_FLOW_REMOVED:
+        if ( sizeof( ofp141::ofp_flow_removed ) > nOctets ) return false;
+        type = prop::OFPACPT_FLOW_REMOVED_MASTER;
+        reason = reinterpret_cast<const ofp141::ofp_flow_removed&>( header ).reason;
+        return true;
+      case ofp141::ofp_type::OFPT_ROLE_STATUS:
+        if ( sizeof( ofp141::ofp_header ) + 5 > nOctets ) return false;
+        type = prop::OFPACPT_ROLE_STATUS_MASTER;
+        reason = reinterpret_cast<const ofp141::ofp_role_status&>( header ).reason;
+        return true;
+      case ofp141::ofp_type::OFPT_TABLE_STATUS:
+        if ( sizeof( ofp141::ofp_header ) + 1 > nOctets ) return false;
+        type = prop::OFPACPT_TABLE_STATUS_MASTER;
+        reason = reinterpret_cast<const ofp141::ofp_table_status&>( header ).reason;
+        return true;
+      case ofp141::ofp_type::OFPT_REQUESTFORWARD:
+        if ( sizeof( ofp141::ofp_requestforward_header ) > nOctets ) return false;
+        type = prop::OFPACPT_REQUESTFORWARD_MASTER;
+        reason = ( ofp141::ofp_type::OFPT_METER_MOD == reinterpret_cast<const ofp141::ofp_requestforward_header&>( header ).request.type )
+          ? ofp141::ofp_requestforward_reason::OFPRFR_METER_MOD : ofp141::ofp_requestforward_reason::OFPRFR_GROUP_MOD;
+        return true;
+      default:
+        return false;
+    }
+  }
+
+  async_stats_t Async( const Replay::vMessage_t& vMessage, const codec::ofp_async_config::policy_t& policy ) {
+    async_stats_t stats;
+    for ( const vByte_t& message: vMessage ) {
+      stats.nMessages++;
+      ofp141::ofp_async_config_prop_type type;
+      uint8_t reason;
+      if ( AsyncReason( message, type, reason ) ) {
+        async_stats_t::count_t& count( stats.rKind[ type / 2 ] ); // master types are odd, one per kind
+        count.nReceived++;
+        stats.total.nReceived++;
+        if ( policy.Sends( type, reason ) ) {
+          count.nKept++;
+          stats.total.nKept++;
+        }
+      }
+    }
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const async_stats_t& stats ) {
+    static const char* rName[ async_stats_t::nKinds ] = {
+      "packet_in", "port_status", "flow_removed", "role_status", "table_status", "requestforward" };
+    os
+      << "messages=" << stats.nMessages
+      << ",async received=" << stats.total.nReceived
+      << ",kept=" << stats.total.nKept
+      ;
+    for ( size_t ix = 0; ix < async_stats_t::nKinds; ix++ ) {
+      os << "," << rName[ ix ] << "=" << stats.rKind[ ix ].nKept << "/" << stats.rKind[ ix ].nReceived;
+    }
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  if ( 2 > argc ) {
+    std::cout << "Usage: bench_async <pcap or record file>" << std::endl;
+    return 1;
+  }
+
+  Replay replay( argv[1] );
+  std::cout << "async, everything: " << Async( replay.Messages(), codec::ofp_async_config::policy_t::All() ) << std::endl;
+  std::cout << "async, with policy: " << Async( replay.Messages(), tcp_session::DefaultAsyncPolicy() ) << std::endl;
+
+  return 0;
+}
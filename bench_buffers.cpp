@@ -0,0 +1,125 @@
+/*
+ * File:   bench_buffers.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Buffer pool throughput as threads are added: each thread obtains buffers and hands them
+//   to the next thread, which adds them back, as a buffer filled on one io thread is released
+//   by the write completion on another: bench_buffers [buffers] [threads],
+//   buffers per thread, run with 1, 2, 4 .. threads
+
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include <iostream>
+
+#include "Buffer.h"
+#include "bounded_queue.h"
+#include "bench.h"
+
+namespace {
+
+  enum { message_octets = 128 }; // about a learned pair flow_mod
+  enum { buffer_batch = 16 };    // buffers a thread holds before handing them on
+
+  struct buffer_stats_t {
+    uint64_t nThreads;
+    uint64_t nBuffers;    // obtained, and added back, over all threads
+    double dSeconds;
+    Buffer::stats_t pool; // over the run, summed over the classes, nFull as at the end
+    buffer_stats_t(): nThreads( 0 ), nBuffers( 0 ), dSeconds( 0.0 ), pool() {}
+    double BuffersPerSecond() const { return bench::PerSecond( nBuffers, dSeconds ); }
+  };
+
+  buffer_stats_t Buffers( size_t nThreads, size_t nBuffers ) {
+
+    buffer_stats_t stats;
+    stats.nThreads = nThreads;
+    stats.nBuffers = nThreads * nBuffers;
+
+    // each thread's inbound buffers, handed over by the previous thread
+    std::vector<std::unique_ptr<BoundedQueue<vByte_t> > > vRing;
+    for ( size_t ix = 0; ix < nThreads; ix++ ) {
+      vRing.emplace_back( new BoundedQueue<vByte_t>( 4 * buffer_batch ) );
+    }
+
+    const Buffer::rStats_t rBefore( Buffer::Stats() );
+
+    std::atomic<uint64_t> nAdded( 0 );
+    const bench::clock_t::time_point tpStart = bench::Together(
+      nThreads,
+      [&]( size_t ixThread ){
+        Buffer buffer;
+        BoundedQueue<vByte_t>& ringIn( *vRing[ ixThread ] );
+        BoundedQueue<vByte_t>& ringOut( *vRing[ ( ixThread + 1 ) % nThreads ] );
+        vByte_t v;
+        vByte_t vIn;
+        auto fDrain = [&](){
+          while ( ringIn.Pop( vIn ) ) {
+            buffer.AddBuffer( vIn );
+            nAdded.fetch_add( 1, std::memory_order_relaxed );
+          }
+        };
+        for ( size_t ix = 0; ix < nBuffers; ix++ ) {
+          v = buffer.ObtainBuffer( message_octets );
+          v.resize( message_octets ); // as a message is built
+          while ( !ringOut.Push( v ) ) { // the next thread is behind
+            fDrain();
+            std::this_thread::yield();
+          }
+          if ( 0 == ( ( ix + 1 ) % buffer_batch ) ) fDrain();
+        }
+        while ( stats.nBuffers > nAdded.load( std::memory_order_relaxed ) ) {
+          fDrain();
+          std::this_thread::yield();
+        }
+      } );
+    stats.dSeconds = bench::Seconds( tpStart );
+
+    const Buffer::rStats_t rAfter( Buffer::Stats() );
+    for ( size_t ix = 0; ix < Buffer::nClasses; ix++ ) {
+      stats.pool.nObtained += rAfter[ ix ].nObtained - rBefore[ ix ].nObtained;
+      stats.pool.nAdded += rAfter[ ix ].nAdded - rBefore[ ix ].nAdded;
+      stats.pool.nFill += rAfter[ ix ].nFill - rBefore[ ix ].nFill;
+      stats.pool.nMiss += rAfter[ ix ].nMiss - rBefore[ ix ].nMiss;
+      stats.pool.nSpill += rAfter[ ix ].nSpill - rBefore[ ix ].nSpill;
+      stats.pool.nReleased += rAfter[ ix ].nReleased - rBefore[ ix ].nReleased;
+      stats.pool.nFull += rAfter[ ix ].nFull;
+    }
+
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const buffer_stats_t& stats ) {
+    os
+      << "threads=" << stats.nThreads
+      << ",buffers=" << stats.nBuffers
+      << ",seconds=" << stats.dSeconds
+      << ",buffers/sec=" << stats.BuffersPerSecond()
+      << ",magazine obtained=" << stats.pool.nObtained
+      << ",added=" << stats.pool.nAdded
+      << ",depot fill=" << stats.pool.nFill
+      << ",miss=" << stats.pool.nMiss
+      << ",spill=" << stats.pool.nSpill
+      << ",released=" << stats.pool.nReleased
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  const size_t nBuffers = bench::Arg( argc, argv, 1, 1000000 );
+  const size_t nThreadsMax = bench::Arg( argc, argv, 2, 8 );
+  for ( size_t nThreads = 1; nThreads <= nThreadsMax; nThreads *= 2 ) {
+    std::cout << "buffers: " << Buffers( nThreads, nBuffers ) << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,169 @@
+/*
+ * File:   bench_builder.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// A learned pair flow_mod built repeatedly with ofp::Append, growing the buffer a structure
+//   at a time, and with ofp::Builder, sized once: bench_builder [flow_mods]
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <iostream>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "common.h"
+
+#include "codecs/append.h"
+#include "codecs/builder.h"
+#include "codecs/ofp_flow_mod.h"
+
+#include "protocol/ethernet.h"
+
+#include "bench.h"
+
+namespace {
+
+  struct builder_stats_t {
+    uint64_t nMessages;  // built each way
+    uint64_t nOctets;    // of one message
+    double dSecondsAppend;
+    double dSecondsBuilder;
+    bool bSame;          // both ways gave the same octets, xid aside
+    builder_stats_t(): nMessages( 0 ), nOctets( 0 ), dSecondsAppend( 0.0 ), dSecondsBuilder( 0.0 ), bSame( false ) {}
+    double NsAppend() const { return ( 0 == nMessages ) ? 0.0 : 1e9 * dSecondsAppend / nMessages; }
+    double NsBuilder() const { return ( 0 == nMessages ) ? 0.0 : 1e9 * dSecondsBuilder / nMessages; }
+  };
+
+  namespace fm = codec::ofp_flow_mod;
+
+  // a learned pair flow_mod from an access port to a trunk, as the bridge sent it before ofp::Builder
+  void AppendPairFlow( vByte_t& v, uint32_t ofportIn, const fm::mac_t& macSrc, const fm::mac_t& macDst, uint16_t idVlan, uint32_t ofportOut ) {
+
+    v.clear();
+
+    auto* pFlowMod = ofp::Append<fm::ofp_flow_mod_>( v );
+    pFlowMod->init();
+    auto* pMatch = new ( &pFlowMod->match ) fm::ofp_match_;
+
+    v.resize( v.size() - sizeof( pFlowMod->match.pad ) ); // the oxm fields take the place of the padding
+    vByte_t::size_type sizeMatchesStart = v.size();
+    ofp::Append<fm::ofpxmt_ofb_in_port_>( v )->init( ofportIn );
+    ofp::Append<fm::ofpxmt_ofb_eth_mac_>( v )->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST, macDst );
+    ofp::Append<fm::ofpxmt_ofb_eth_mac_>( v )->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC, macSrc );
+    ofp::Append<fm::ofpxmt_ofb_vlan_vid_>( v )->init(); // untagged
+    pMatch = reinterpret_cast<fm::ofp_match_*>( &reinterpret_cast<fm::ofp_flow_mod_*>( v.data() )->match ); // v may have moved
+    pMatch->length += v.size() - sizeMatchesStart;
+
+    v.resize( v.size() + pMatch->fill_size() );
+    pMatch->fill();
+
+    vByte_t::size_type sizeActionsStart = v.size();
+    ofp::Append<fm::ofp_instruction_actions_>( v )->init();
+    ofp::Append<fm::ofp_action_push_vlan_>( v )->init( protocol::ethernet::Ethertype::ieee8021q );
+    ofp::Append<fm::ofp_action_set_field_vlan_id_>( v )->init( idVlan );
+    ofp::Append<fm::ofp_action_output_>( v )->init( ofportOut );
+    reinterpret_cast<fm::ofp_instruction_actions_*>( v.data() + sizeActionsStart )->len = v.size() - sizeActionsStart;
+
+    reinterpret_cast<fm::ofp_flow_mod_*>( v.data() )->header.length = v.size();
+  }
+
+  typedef ofp::Match<fm::ofpxmt_ofb_in_port_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_vlan_vid_> matchPair_t;
+  typedef ofp::Actions<fm::ofp_action_push_vlan_, fm::ofp_action_set_field_vlan_id_, fm::ofp_action_output_> actionsPair_t;
+
+  // the same, sized once and placed, as the bridge sends it now
+  void BuildPairFlow( vByte_t& v, uint32_t ofportIn, const fm::mac_t& macSrc, const fm::mac_t& macDst, uint16_t idVlan, uint32_t ofportOut ) {
+
+    v.clear();
+
+    const size_t nOctets( ofp::FlowModSize<matchPair_t>( actionsPair_t::size ) );
+    ofp::Builder build( v, nOctets );
+
+    auto* pFlowMod = build.Append<fm::ofp_flow_mod_>();
+    pFlowMod->init();
+
+    build.Seek( pFlowMod->match.oxm_fields );
+    build.Append<fm::ofpxmt_ofb_in_port_>()->init( ofportIn );
+    build.Append<fm::ofpxmt_ofb_eth_mac_>()->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST, macDst );
+    build.Append<fm::ofpxmt_ofb_eth_mac_>()->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC, macSrc );
+    build.Append<fm::ofpxmt_ofb_vlan_vid_>()->init(); // untagged
+    pFlowMod->match.length = matchPair_t::length;
+    build.Pad( matchPair_t::size - matchPair_t::length );
+
+    auto* pActions = build.Append<fm::ofp_instruction_actions_>();
+    pActions->init();
+    build.Append<fm::ofp_action_push_vlan_>()->init( protocol::ethernet::Ethertype::ieee8021q );
+    build.Append<fm::ofp_action_set_field_vlan_id_>()->init( idVlan );
+    build.Append<fm::ofp_action_output_>()->init( ofportOut );
+    pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsPair_t::size;
+
+    pFlowMod->header.length = nOctets;
+    assert( build.Complete() );
+  }
+
+  builder_stats_t Builders( size_t nMessages ) {
+
+    builder_stats_t stats;
+    stats.nMessages = nMessages;
+
+    const fm::mac_t macSrc = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+    const fm::mac_t macDst = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+
+    vByte_t vAppend;
+    vByte_t vBuilder;
+    vAppend.reserve( 256 ); // as the bridge's size hint had it
+    vBuilder.reserve( 256 );
+
+    uint64_t nCheck( 0 ); // keeps the loops from being optimised away
+
+    bench::clock_t::time_point tpStart = bench::clock_t::now();
+    for ( size_t ix = 0; ix < nMessages; ix++ ) {
+      AppendPairFlow( vAppend, 1 + ( ix & 0xff ), macSrc, macDst, 10, 9 );
+      nCheck += vAppend[ 8 + ( ix & 0x3f ) ];
+    }
+    stats.dSecondsAppend = bench::Seconds( tpStart );
+
+    tpStart = bench::clock_t::now();
+    for ( size_t ix = 0; ix < nMessages; ix++ ) {
+      BuildPairFlow( vBuilder, 1 + ( ix & 0xff ), macSrc, macDst, 10, 9 );
+      nCheck -= vBuilder[ 8 + ( ix & 0x3f ) ];
+    }
+    stats.dSecondsBuilder = bench::Seconds( tpStart );
+
+    // the last of each, same in_port, xids differ
+    stats.nOctets = vBuilder.size();
+    const size_t ixXid = offsetof( ofp141::ofp_header, xid );
+    stats.bSame
+      =  ( 0 == nCheck )
+      && ( vAppend.size() == vBuilder.size() )
+      && ( 0 == std::memcmp( vAppend.data(), vBuilder.data(), ixXid ) )
+      && ( 0 == std::memcmp( vAppend.data() + sizeof( ofp141::ofp_header ), vBuilder.data() + sizeof( ofp141::ofp_header ), vAppend.size() - sizeof( ofp141::ofp_header ) ) );
+
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const builder_stats_t& stats ) {
+    os
+      << "flow_mods=" << stats.nMessages
+      << ",octets each=" << stats.nOctets
+      << ",append ns/msg=" << stats.NsAppend()
+      << ",builder ns/msg=" << stats.NsBuilder()
+      << ",same octets=" << ( stats.bSame ? "yes" : "no" )
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  const size_t nMessages = bench::Arg( argc, argv, 1, 5000000 );
+  std::cout << "builder: " << Builders( nMessages ) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,432 @@
+/*
+ * File:   bench_learning.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Counts the packet_in each Bridge::LearnMode costs: synthetic conversations between hosts
+//   are run through a model switch, which keeps what the bridge's flow_mods, and their learn
+//   actions, put in tables 0 and 1: bench_learning [flows]
+
+#include <cassert>
+#include <map>
+#include <set>
+#include <deque>
+#include <tuple>
+#include <random>
+#include <vector>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+
+#include <boost/endian/arithmetic.hpp>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "common.h"
+
+#include "codecs/builder.h"
+#include "codecs/ofp_match.h"
+#include "codecs/nx_learn.h"
+
+#include "bridge.h"
+#include "logging.h"
+#include "bench.h"
+
+namespace {
+
+  struct learn_stats_t {
+    uint64_t nFlows;      // conversations, each a few frames in both directions
+    uint64_t nFrames;     // sent by the hosts
+    uint64_t nPacketIns;  // frames the model switch sent to the controller
+    uint64_t nDelivered;  // out a single port, by a flow or a packet_out
+    uint64_t nFlooded;    // out a vlan's group
+    uint64_t nLearned;    // table 1 entries written by the learn action
+    uint64_t nSetup;      // controller to switch messages as rules injection starts
+    uint64_t nMessages;   // controller to switch messages from then on
+    uint64_t nOctets;
+    learn_stats_t()
+    : nFlows( 0 ), nFrames( 0 ), nPacketIns( 0 ), nDelivered( 0 ), nFlooded( 0 ), nLearned( 0 ),
+      nSetup( 0 ), nMessages( 0 ), nOctets( 0 ) {}
+    double PacketInsPerThousand() const { return ( 0 == nFlows ) ? 0.0 : 1000.0 * nPacketIns / nFlows; }
+  };
+
+  // enough of a switch to tell which frames reach the controller:
+  //   tables 0 and 1 hold what the bridge's flow_mods and the learn actions they carry put there,
+  //   a frame matching nothing in table 0 becomes a packet_in, packet_outs to OFPP_TABLE run the tables again;
+  //   intercepts and the table miss flow are not kept, the conversations have no arp, dhcp or dns
+  class SwitchModel {
+  public:
+
+    struct frame_t {
+      uint32_t ofport;
+      uint16_t tci; // 0 when untagged, else the vid with OFPVID_PRESENT
+      uint64_t macSrc;
+      uint64_t macDst;
+    };
+
+    SwitchModel( learn_stats_t& stats ): m_stats( stats ) {}
+
+    // frames from hosts
+    void Offer( const frame_t& frame ) {
+      m_stats.nFrames++;
+      Table0( frame );
+    }
+
+    // a message from the controller, bundled or not
+    void Receive( const vByte_t& v ) {
+      const auto* pHeader = reinterpret_cast<const ofp141::ofp_header*>( v.data() );
+      if ( ofp141::ofp_type::OFPT_BUNDLE_ADD_MESSAGE == pHeader->type ) {
+        pHeader = &reinterpret_cast<const ofp141::ofp_bundle_add_msg*>( pHeader )->message;
+      }
+      const uint8_t* pEnd = reinterpret_cast<const uint8_t*>( pHeader ) + pHeader->length;
+      switch ( pHeader->type ) {
+        case ofp141::ofp_type::OFPT_FLOW_MOD:
+          FlowMod( reinterpret_cast<const ofp141::ofp_flow_mod&>( *pHeader ), pEnd );
+          break;
+        case ofp141::ofp_type::OFPT_PACKET_OUT:
+          m_qPacketOut.emplace_back( reinterpret_cast<const uint8_t*>( pHeader ), pEnd );
+          break;
+        default:
+          break;
+      }
+    }
+
+    // packet_outs are run once the controller is done with the packet_in, not from within Forward
+    void PacketOuts() {
+      while ( !m_qPacketOut.empty() ) {
+        const vByte_t v( std::move( m_qPacketOut.front() ) );
+        m_qPacketOut.pop_front();
+        PacketOut( reinterpret_cast<const ofp141::ofp_packet_out&>( *v.data() ), v.data() + v.size() );
+      }
+    }
+
+    bool PacketIn( frame_t& frame ) {
+      if ( m_qPacketIn.empty() ) return false;
+      frame = m_qPacketIn.front();
+      m_qPacketIn.pop_front();
+      return true;
+    }
+
+    static uint64_t Mac( const uint8_t* p ) {
+      uint64_t mac( 0 );
+      for ( size_t ix = 0; ix < 6; ix++ ) mac = ( mac << 8 ) | p[ ix ];
+      return mac;
+    }
+
+    static void Mac( uint64_t mac, uint8_t* p ) {
+      for ( size_t ix = 6; 0 < ix; ix-- ) { p[ ix - 1 ] = mac & 0xff; mac >>= 8; }
+    }
+
+    // ethernet header, a tag when there is one, ipv4 ethertype, padded to a minimum frame
+    static vByte_t Encode( const frame_t& frame ) {
+      vByte_t v( 60, 0 );
+      Mac( frame.macDst, v.data() );
+      Mac( frame.macSrc, v.data() + 6 );
+      size_t ix( 12 );
+      if ( 0 != frame.tci ) {
+        v[ ix++ ] = 0x81; v[ ix++ ] = 0x00;
+        v[ ix++ ] = ( frame.tci >> 8 ) & 0x0f; v[ ix++ ] = frame.tci & 0xff;
+      }
+      v[ ix++ ] = 0x08; v[ ix++ ] = 0x00;
+      return v;
+    }
+
+  private:
+
+    struct ingress_t {
+      std::vector<codec::nx_learn::learn_t> vLearn;
+      uint16_t tciPush; // 0 unless the frame is tagged on its way to table 1
+      bool bGoto;
+      ingress_t(): tciPush( 0 ), bGoto( false ) {}
+    };
+
+    learn_stats_t& m_stats;
+
+    std::set<std::tuple<uint32_t,uint16_t,uint64_t,uint64_t> > m_setPair; // table 0: in_port, vlan_vid, eth_src, eth_dst
+    std::map<std::pair<uint32_t,uint16_t>,ingress_t> m_mapIngress;      // table 0: in_port, vlan_vid
+    std::map<std::pair<uint16_t,uint64_t>,uint32_t> m_mapLearned;        // table 1: vid, eth_dst to port
+    std::set<uint16_t> m_setFlood;                                       // table 1: vid
+
+    std::deque<frame_t> m_qPacketIn;
+    std::deque<vByte_t> m_qPacketOut;
+
+    void FlowMod( const ofp141::ofp_flow_mod& mod, const uint8_t* pEnd ) {
+
+      codec::ofp_match::match_fields fields;
+      codec::ofp_match::Decode( mod.match, pEnd, fields );
+      typedef ofp141::oxm_ofb_match_fields f;
+
+      ingress_t ingress;
+      bool bFlood( false );
+      const uint8_t* p = reinterpret_cast<const uint8_t*>( &mod.match ) + ofp::Pad8( mod.match.length );
+      while ( ( p + sizeof( ofp141::ofp_instruction_header ) ) <= pEnd ) {
+        const auto& instruction( reinterpret_cast<const ofp141::ofp_instruction_header&>( *p ) );
+        if ( ofp141::ofp_instruction_type::OFPIT_GOTO_TABLE == instruction.type ) ingress.bGoto = true;
+        if ( ofp141::ofp_instruction_type::OFPIT_APPLY_ACTIONS == instruction.type ) {
+          const uint8_t* pAction = p + sizeof( ofp141::ofp_instruction_actions );
+          while ( pAction < ( p + instruction.len ) ) {
+            const auto& action( reinterpret_cast<const ofp141::ofp_action_header&>( *pAction ) );
+            switch ( action.type ) {
+              case ofp141::ofp_action_type::OFPAT_EXPERIMENTER: {
+                codec::nx_learn::learn_t learn;
+                if ( codec::nx_learn::Decode( reinterpret_cast<const ofp141::ofp_action_experimenter_header&>( action ), learn ) ) {
+                  ingress.vLearn.push_back( learn );
+                }
+                }
+                break;
+              case ofp141::ofp_action_type::OFPAT_SET_FIELD: {
+                const auto& set( reinterpret_cast<const ofp141::ofp_action_set_field&>( action ) );
+                const uint32_t header = *reinterpret_cast<const boost::endian::big_uint32_t*>( set.field );
+                if ( OXM_FIELD( header ) == f::OFPXMT_OFB_VLAN_VID ) {
+                  ingress.tciPush = *reinterpret_cast<const boost::endian::big_uint16_t*>( set.field + 4 );
+                }
+                }
+                break;
+              case ofp141::ofp_action_type::OFPAT_GROUP:
+                bFlood = true;
+                break;
+              default:
+                break;
+            }
+            pAction += action.len;
+          }
+        }
+        p += instruction.len;
+      }
+
+      if ( 0 == mod.table_id ) {
+        if ( fields.HasAll( fields.Bit( f::OFPXMT_OFB_IN_PORT ) | fields.Bit( f::OFPXMT_OFB_ETH_SRC ) | fields.Bit( f::OFPXMT_OFB_ETH_DST ) ) ) {
+          m_setPair.emplace( fields.value.in_port, fields.value.vlan_vid, Mac( fields.value.eth_src ), Mac( fields.value.eth_dst ) );
+        }
+        else {
+          if ( fields.HasAll( fields.Bit( f::OFPXMT_OFB_IN_PORT ) | fields.Bit( f::OFPXMT_OFB_VLAN_VID ) ) ) {
+            m_mapIngress[ std::make_pair( fields.value.in_port, fields.value.vlan_vid ) ] = ingress;
+          }
+        }
+      }
+      else {
+        if ( bFlood && fields.Has( f::OFPXMT_OFB_VLAN_VID ) ) {
+          m_setFlood.insert( fields.value.vlan_vid & 0x0fff );
+        }
+      }
+    }
+
+    void PacketOut( const ofp141::ofp_packet_out& out, const uint8_t* pEnd ) {
+      const uint8_t* p = reinterpret_cast<const uint8_t*>( &out ) + sizeof( ofp141::ofp_packet_out );
+      const uint8_t* pFrame = p + out.actions_len;
+      if ( ( pFrame + 14 ) > pEnd ) return; // no ethernet header to go by
+      const bool bTagged( ( 0x81 == pFrame[ 12 ] ) && ( 0x00 == pFrame[ 13 ] ) );
+      if ( bTagged && ( ( pFrame + 16 ) > pEnd ) ) return; // nor the tci
+      frame_t frame;
+      frame.ofport = out.in_port;
+      frame.macDst = Mac( pFrame );
+      frame.macSrc = Mac( pFrame + 6 );
+      frame.tci = bTagged
+        ? ( ofp141::ofp_vlan_id::OFPVID_PRESENT | ( ( ( pFrame[ 14 ] << 8 ) | pFrame[ 15 ] ) & 0x0fff ) )
+        : 0;
+      while ( p < pFrame ) {
+        const auto& action( reinterpret_cast<const ofp141::ofp_action_header&>( *p ) );
+        if ( ofp141::ofp_action_type::OFPAT_OUTPUT == action.type ) {
+          if ( ofp141::ofp_port_no::OFPP_TABLE == reinterpret_cast<const ofp141::ofp_action_output&>( action ).port ) {
+            Table0( frame );
+          }
+          else m_stats.nDelivered++;
+        }
+        if ( ofp141::ofp_action_type::OFPAT_GROUP == action.type ) m_stats.nFlooded++;
+        p += action.len;
+      }
+    }
+
+    void Table0( frame_t frame ) {
+
+      if ( m_setPair.end() != m_setPair.find( std::make_tuple( frame.ofport, frame.tci, frame.macSrc, frame.macDst ) ) ) {
+        m_stats.nDelivered++;
+        return;
+      }
+
+      auto iter = m_mapIngress.find( std::make_pair( frame.ofport, frame.tci ) );
+      if ( m_mapIngress.end() == iter ) {
+        m_stats.nPacketIns++;
+        m_qPacketIn.push_back( frame );
+        return;
+      }
+
+      const ingress_t& ingress( iter->second );
+      for ( const codec::nx_learn::learn_t& learn: ingress.vLearn ) Learn( learn, frame );
+      if ( 0 != ingress.tciPush ) frame.tci = ingress.tciPush;
+      if ( ingress.bGoto ) Table1( frame );
+    }
+
+    // the specs the bridge uses: the vid, as a constant or from the frame, eth_dst from eth_src, output to in_port
+    void Learn( const codec::nx_learn::learn_t& learn, const frame_t& frame ) {
+      namespace nx = codec::nx_learn;
+      uint16_t vid( 0 );
+      uint64_t mac( 0 );
+      uint32_t ofport( 0 );
+      for ( const nx::spec_t& spec: learn.vSpec ) {
+        switch ( spec.eDst ) {
+          case nx::spec_t::match:
+            if ( nx::nxm_of_vlan_tci == spec.dstField ) vid = ( nx::spec_t::immediate == spec.eSrc ) ? spec.value : ( frame.tci & 0x0fff );
+            if ( nx::nxm_of_eth_dst == spec.dstField ) mac = ( nx::spec_t::immediate == spec.eSrc ) ? spec.value : frame.macSrc;
+            break;
+          case nx::spec_t::output:
+            if ( nx::nxm_of_in_port == spec.srcField ) ofport = frame.ofport;
+            break;
+          case nx::spec_t::load:
+            break; // the tag, not needed to count
+        }
+      }
+      if ( m_mapLearned.emplace( std::make_pair( vid, mac ), ofport ).second ) m_stats.nLearned++;
+    }
+
+    void Table1( const frame_t& frame ) {
+      const uint16_t vid( frame.tci & 0x0fff );
+      if ( m_mapLearned.end() != m_mapLearned.find( std::make_pair( vid, frame.macDst ) ) ) m_stats.nDelivered++;
+      else {
+        if ( m_setFlood.end() != m_setFlood.find( vid ) ) m_stats.nFlooded++;
+      }
+    }
+
+  };
+
+  learn_stats_t Learning( Bridge::LearnMode eLearnMode, size_t nFlows ) {
+
+    const Bridge::idVlan_t idVlan( 10 );
+    const size_t nAccessPorts( 8 );
+    const Bridge::ofport_t ofportTrunk( nAccessPorts + 1 );
+    const size_t nHosts( 128 );
+    const size_t nExchanges( 3 ); // round trips per conversation
+
+    learn_stats_t stats;
+    SwitchModel model( stats );
+
+    Bridge bridge;
+    bridge.SetLearnMode( eLearnMode );
+
+    for ( Bridge::ofport_t ofport = 1; ofport <= ofportTrunk; ofport++ ) {
+      Bridge::interface_t interface;
+      interface.ofport = ofport;
+      interface.ifindex = ofport;
+      if ( ofportTrunk == ofport ) {
+        interface.eVlanMode = Bridge::VlanMode::trunk;
+        interface.setTrunk.insert( idVlan );
+      }
+      else {
+        interface.eVlanMode = Bridge::VlanMode::access;
+        interface.tag = idVlan;
+      }
+      bridge.UpdateInterface( interface );
+    }
+
+    bridge.StartRulesInjection(
+      []( size_t nOctets ){ vByte_t v; v.reserve( nOctets ); return v; },
+      [&stats,&model]( vByte_t v ){
+        stats.nMessages++;
+        stats.nOctets += v.size();
+        model.Receive( v );
+      },
+      [&stats,&model]( vByte_t v, const Bridge::payload_t& payload ){ // bundled messages, held behind their add header
+        v.insert( v.end(), payload.pBegin, payload.pBegin + payload.nOctets ); // packet_in payloads here are always copied
+        stats.nMessages++;
+        stats.nOctets += v.size();
+        model.Receive( v );
+      },
+      [&stats]( vByte_t v, Bridge::fCompletion_t fCompletion ){
+        stats.nMessages++;
+        stats.nOctets += v.size();
+        fCompletion( true ); // barriers are answered at once
+      },
+      [&stats,&model]( vByte_t v, Bridge::fCompletion_t fCompletion ){
+        stats.nMessages++;
+        stats.nOctets += v.size();
+        model.Receive( v );
+        fCompletion( true ); // the model refuses nothing
+      } );
+    stats.nSetup = stats.nMessages;
+    stats.nMessages = 0;
+    stats.nOctets = 0;
+
+    // hosts spread over the ports, those on the trunk send tagged
+    auto fHost = [&]( size_t ixHost ){
+      SwitchModel::frame_t frame;
+      frame.ofport = 1 + ixHost % ofportTrunk;
+      frame.tci = ( ofportTrunk == frame.ofport ) ? ( ofp141::ofp_vlan_id::OFPVID_PRESENT | idVlan ) : 0;
+      frame.macSrc = 0x020000000000 + ixHost + 1;
+      frame.macDst = 0;
+      return frame;
+    };
+
+    // the controller's part of a packet_in, as tcp_session does it
+    auto fDrain = [&](){
+      SwitchModel::frame_t frame;
+      while ( model.PacketIn( frame ) ) {
+        const vByte_t v( SwitchModel::Encode( frame ) );
+        const Bridge::idVlan_t vid( frame.tci & 0x0fff );
+        bridge.Update( frame.ofport, vid, Bridge::MacAddress( *reinterpret_cast<const Bridge::mac_t*>( v.data() + 6 ) ) );
+        bridge.Forward(
+          frame.ofport, vid,
+          Bridge::MacAddress( *reinterpret_cast<const Bridge::mac_t*>( v.data() + 6 ) ),
+          Bridge::MacAddress( *reinterpret_cast<const Bridge::mac_t*>( v.data() ) ),
+          Bridge::payload_t( nullptr, v.data(), v.size() ) );
+        model.PacketOuts();
+      }
+    };
+
+    // distinct pairs, in a fixed random order
+    std::vector<std::pair<size_t,size_t> > vPair;
+    for ( size_t a = 0; a < nHosts; a++ ) {
+      for ( size_t b = a + 1; b < nHosts; b++ ) vPair.emplace_back( a, b );
+    }
+    std::mt19937 random( 1 );
+    std::shuffle( vPair.begin(), vPair.end(), random );
+    if ( nFlows < vPair.size() ) vPair.resize( nFlows );
+
+    for ( const auto& pair: vPair ) {
+      stats.nFlows++;
+      SwitchModel::frame_t frameA( fHost( pair.first ) );
+      SwitchModel::frame_t frameB( fHost( pair.second ) );
+      frameA.macDst = frameB.macSrc;
+      frameB.macDst = frameA.macSrc;
+      for ( size_t ix = 0; ix < nExchanges; ix++ ) {
+        model.Offer( frameA );
+        fDrain();
+        model.Offer( frameB );
+        fDrain();
+      }
+    }
+
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const learn_stats_t& stats ) {
+    os
+      << "flows=" << stats.nFlows
+      << ",frames=" << stats.nFrames
+      << ",packet_in=" << stats.nPacketIns
+      << ",packet_in/1000 flows=" << stats.PacketInsPerThousand()
+      << ",delivered=" << stats.nDelivered
+      << ",flooded=" << stats.nFlooded
+      << ",learned by switch=" << stats.nLearned
+      << ",setup messages=" << stats.nSetup
+      << ",messages=" << stats.nMessages
+      << ",octets=" << stats.nOctets
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  logging::SetLevel( logging::warning );
+  const size_t nFlows = bench::Arg( argc, argv, 1, 1000 );
+  const learn_stats_t statsController( Learning( Bridge::LearnMode::controllerLearns, nFlows ) ); // before the label, the bridge prints as it is built
+  std::cout << "learning in controller: " << statsController << std::endl;
+  const learn_stats_t statsSwitch( Learning( Bridge::LearnMode::switchLearns, nFlows ) );
+  std::cout << "learning in switch: " << statsSwitch << std::endl;
+
+  return 0;
+}
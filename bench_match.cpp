@@ -0,0 +1,93 @@
+/*
+ * File:   bench_match.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Times the packet_in match decoder alone, over a recording's packet_ins held in memory:
+//   bench_match <pcap or record file> [passes]
+
+#include <chrono>
+#include <vector>
+#include <ostream>
+#include <iostream>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_match.h"
+
+#include "bench.h"
+#include "replay.h"
+
+namespace {
+
+  struct match_stats_t {
+    uint64_t nMatches;  // decoded
+    uint64_t nFields;   // present, over all matches
+    uint64_t nFailed;   // not result_t::ok
+    double dSeconds;
+    match_stats_t(): nMatches( 0 ), nFields( 0 ), nFailed( 0 ), dSeconds( 0.0 ) {}
+    double MatchesPerSecond() const { return bench::PerSecond( nMatches, dSeconds ); }
+  };
+
+  match_stats_t Matches( const Replay::vMessage_t& vMessage, size_t nPasses ) {
+
+    struct match_t {
+      const ofp141::ofp_match* pMatch;
+      const uint8_t* pEnd;
+    };
+    std::vector<match_t> vMatch;
+    for ( const vByte_t& message: vMessage ) {
+      const auto* pMsg = reinterpret_cast<const ofp141::ofp_packet_in*>( message.data() );
+      if ( ( ofp141::ofp_type::OFPT_PACKET_IN == pMsg->header.type )
+        && ( sizeof( ofp141::ofp_packet_in ) <= message.size() ) ) {
+        vMatch.push_back( match_t{ &pMsg->match, message.data() + message.size() } );
+      }
+    }
+
+    match_stats_t stats;
+    const bench::clock_t::time_point tpStart = bench::clock_t::now();
+    for ( size_t nPass = 0; nPass < nPasses; nPass++ ) {
+      for ( const match_t& match: vMatch ) {
+        codec::ofp_match::match_fields fields;
+        if ( codec::ofp_match::result_t::ok != codec::ofp_match::Decode( *match.pMatch, match.pEnd, fields ) ) {
+          stats.nFailed++;
+        }
+        stats.nFields += __builtin_popcountll( fields.present );
+      }
+    }
+    stats.dSeconds = bench::Seconds( tpStart );
+    stats.nMatches = vMatch.size() * nPasses;
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const match_stats_t& stats ) {
+    os
+      << "matches=" << stats.nMatches
+      << ",fields/match=" << ( ( 0 == stats.nMatches ) ? 0.0 : (double)stats.nFields / stats.nMatches )
+      << ",failed=" << stats.nFailed
+      << ",seconds=" << stats.dSeconds
+      << ",matches/sec=" << (uint64_t)stats.MatchesPerSecond()
+      << ",ns/match=" << ( ( 0 == stats.nMatches ) ? 0.0 : stats.dSeconds * 1e9 / stats.nMatches )
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  if ( 2 > argc ) {
+    std::cout << "Usage: bench_match <pcap or record file> [passes]" << std::endl;
+    return 1;
+  }
+
+  Replay replay( argv[1] );
+  const size_t nPasses = bench::Arg( argc, argv, 2, 1 );
+  std::cout << "match " << replay.Messages().size() << " messages, " << nPasses << " passes" << std::endl;
+  std::cout << "match: " << Matches( replay.Messages(), nPasses ) << std::endl;
+
+  return 0;
+}
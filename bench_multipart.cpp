@@ -0,0 +1,160 @@
+/*
+ * File:   bench_multipart.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Consumes a synthetic flow table dump without a switch: a flow stats reply stream,
+//   one part buffer re-filled, is handed part by part through a tracked transaction
+//   to the multipart engine: bench_multipart [flows]
+
+#include <chrono>
+#include <memory>
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <ostream>
+#include <iostream>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_header.h"
+#include "codecs/builder.h"
+#include "codecs/ofp_flow_mod.h"
+#include "codecs/ofp_multipart.h"
+
+#include "multipart.h"
+#include "allocations.h"
+#include "transactions.h"
+#include "bench.h"
+
+namespace {
+
+  struct dump_stats_t {
+    uint64_t nFlows;       // records visited
+    uint64_t nAllocations; // operator new calls while the parts were consumed
+    double dSeconds;       // consuming the parts, not making them
+    Multipart::status_t status;
+    Multipart::stats_t multipart;
+    dump_stats_t(): nFlows( 0 ), nAllocations( 0 ), dSeconds( 0.0 ), status( Multipart::status_t::active ) {}
+    double FlowsPerSecond() const { return bench::PerSecond( nFlows, dSeconds ); }
+  };
+
+  dump_stats_t Dump( size_t nFlows ) {
+
+    namespace fm = codec::ofp_flow_mod;
+
+    typedef ofp::Match<fm::ofpxmt_ofb_in_port_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_vlan_vid_> match_t;
+    const size_t nRecord
+      = sizeof( ofp141::ofp_flow_stats ) - sizeof( ofp141::ofp_match ) + match_t::size
+      + sizeof( ofp141::ofp_instruction_actions ) + sizeof( ofp141::ofp_action_output );
+    const size_t nPerPart = ( 0xffff - sizeof( ofp141::ofp_multipart_reply ) ) / nRecord; // as ovs fills a part
+
+    dump_stats_t stats;
+
+    Transactions transactions( 4 );
+    const uint32_t xid = transactions.NewXid();
+
+    codec::ofp_multipart::visitor_t visitor;
+    uint64_t nPackets( 0 );
+    visitor.fFlow = [&stats,&nPackets]( const codec::ofp_multipart::flow_t& flow ){
+      if ( flow.fields.Has( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_IN_PORT ) ) {
+        stats.nFlows++;
+        nPackets += flow.stats.packet_count;
+      }
+    };
+    auto pMultipart = std::make_shared<Multipart>(
+      ofp141::ofp_multipart_type::OFPMP_FLOW, visitor,
+      [&stats]( Multipart::status_t status, const Multipart::stats_t& multipart ){
+        stats.status = status;
+        stats.multipart = multipart;
+      } );
+    transactions.Track(
+      xid, ofp141::ofp_type::OFPT_MULTIPART_REQUEST, std::chrono::seconds( 10 ),
+      [pMultipart]( const ofp141::ofp_header& header, const uint8_t* pEnd ){ pMultipart->Part( header, pEnd ); },
+      [pMultipart]( const ofp141::ofp_error_msg* pMsg ){ pMultipart->Error( pMsg ); } );
+
+    vByte_t v; // the one part, re-filled as the switch's next would arrive
+    v.reserve( 0xffff );
+
+    size_t nRemaining( nFlows );
+    uint64_t ixFlow( 0 );
+    do {
+      const size_t nRecords = std::min( nRemaining, nPerPart );
+      nRemaining -= nRecords;
+      const size_t nOctets = sizeof( ofp141::ofp_multipart_reply ) + nRecords * nRecord;
+      ofp::Builder build( v, nOctets );
+
+      auto* pReply = build.Append<ofp141::ofp_multipart_reply>();
+      auto* pHeader = new( &pReply->header ) codec::ofp_header::ofp_header_;
+      pHeader->init();
+      pHeader->type = ofp141::ofp_type::OFPT_MULTIPART_REPLY;
+      pHeader->length = nOctets;
+      pHeader->xid = xid;
+      pReply->type = ofp141::ofp_multipart_type::OFPMP_FLOW;
+      pReply->flags = ( 0 == nRemaining ) ? 0 : ofp141::ofp_multipart_reply_flags::OFPMPF_REPLY_MORE;
+      std::memset( pReply->pad, 0, sizeof( pReply->pad ) );
+
+      for ( size_t ix = 0; ix < nRecords; ix++, ixFlow++ ) {
+        auto* pStats = build.Append<ofp141::ofp_flow_stats>();
+        std::memset( pStats, 0, sizeof( ofp141::ofp_flow_stats ) );
+        pStats->length = nRecord;
+        pStats->priority = 1024;
+        pStats->idle_timeout = 30;
+        pStats->cookie = 0x201;
+        pStats->packet_count = ixFlow;
+        pStats->match.type = ofp141::ofp_match_type::OFPMT_OXM;
+        pStats->match.length = match_t::length;
+        build.Seek( pStats->match.oxm_fields );
+
+        const fm::mac_t macDst = { 0x02, 0, 0, 0, 0, 1 };
+        const fm::mac_t macSrc = { 0x02, 0, (uint8_t)( ixFlow >> 24 ), (uint8_t)( ixFlow >> 16 ), (uint8_t)( ixFlow >> 8 ), (uint8_t)ixFlow };
+        build.Append<fm::ofpxmt_ofb_in_port_>()->init( 1 + ixFlow % 48 );
+        build.Append<fm::ofpxmt_ofb_eth_mac_>()->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST, macDst );
+        build.Append<fm::ofpxmt_ofb_eth_mac_>()->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC, macSrc );
+        build.Append<fm::ofpxmt_ofb_vlan_vid_>()->init( 1 );
+        build.Pad( match_t::size - match_t::length );
+
+        auto* pActions = build.Append<fm::ofp_instruction_actions_>();
+        pActions->init();
+        pActions->len = sizeof( ofp141::ofp_instruction_actions ) + sizeof( ofp141::ofp_action_output );
+        build.Append<fm::ofp_action_output_>()->init( 49 );
+      }
+      assert( build.Complete() );
+
+      allocations::Start();
+      const bench::clock_t::time_point tpStart = bench::clock_t::now();
+      transactions.Complete( pReply->header, v.data() + v.size(), 0 == nRemaining );
+      stats.dSeconds += bench::Seconds( tpStart ); // the parts' synthesis is not counted
+      stats.nAllocations += allocations::Stop();
+    } while ( 0 != nRemaining );
+
+    if ( ( nFlows * ( nFlows - 1 ) / 2 ) != nPackets ) stats.status = Multipart::status_t::malformed; // every record seen once
+
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const dump_stats_t& stats ) {
+    os
+      << stats.status
+      << ",flows=" << stats.nFlows
+      << "," << stats.multipart
+      << ",allocations=" << stats.nAllocations
+      << ",seconds=" << stats.dSeconds
+      << ",flows/sec=" << (uint64_t)stats.FlowsPerSecond()
+      << ",MB/sec=" << ( ( 0.0 == stats.dSeconds ) ? 0.0 : stats.multipart.nOctets / stats.dSeconds / 1e6 )
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  const size_t nFlows = bench::Arg( argc, argv, 1, 100000 );
+  std::cout << "multipart flow dump: " << Dump( nFlows ) << std::endl;
+
+  return 0;
+}
@@ -0,0 +1,42 @@
+/*
+ * File:   bench_replay.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 9:20 AM
+ */
+
+// Measures the controller without a switch, a recording replayed through a tcp_session, replay.h:
+//   built with the other benches, make bench, linked with allocations.o, which counts operator new,
+//   so none of this is in cppofc.
+
+#include <string>
+#include <iostream>
+
+#include "replay.h"
+#include "logging.h"
+#include "bench.h"
+
+int main( int argc, char** argv ) {
+
+  // bench_replay <pcap or record file> [passes] [direct|resubmit|both]
+  //   the last picks how the first packet of a new flow is sent, both compares the two
+  if ( 2 > argc ) {
+    std::cout << "Usage: bench_replay <pcap or record file> [passes] [direct|resubmit|both]" << std::endl;
+    return 1;
+  }
+
+  logging::SetLevel( logging::warning ); // per packet tracing would dominate the measurement
+  Replay replay( argv[1] );
+  const size_t nPasses = bench::Arg( argc, argv, 2, 1 );
+  const std::string sFirstPacket( ( 4 <= argc ) ? argv[3] : "direct" );
+  std::cout << "replay " << replay.Messages().size() << " messages, " << nPasses << " passes" << std::endl;
+  if ( ( "resubmit" == sFirstPacket ) || ( "both" == sFirstPacket ) ) {
+    std::cout << "replay resubmit: " << replay.Run( nPasses, Bridge::FirstPacket::resubmit ) << std::endl;
+  }
+  if ( "resubmit" != sFirstPacket ) {
+    std::cout << "replay direct: " << replay.Run( nPasses, Bridge::FirstPacket::direct ) << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+/*
+ * File:   bench_transmit.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:10 PM
+ */
+
+// Producer threads queue messages into one session concurrently, as io threads and
+//   the ovsdb thread do through the bridge, while the switch side reads them:
+//   bench_transmit [messages] [producers], messages per producer, run with 1, 2, 4 .. producers
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <ostream>
+#include <iostream>
+
+#include <sys/socket.h>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_header.h"
+
+#include "bridge.h"
+#include "logging.h"
+#include "tcp_session.h"
+#include "bench.h"
+
+namespace {
+
+  enum { message_octets = 128 }; // about a learned pair flow_mod
+  enum { max_read = 64 * 1024 };
+
+  struct transmit_stats_t {
+    uint64_t nProducers;
+    uint64_t nMessages;   // over all producers
+    uint64_t nOctets;     // read by the switch side
+    double dSeconds;      // first message queued to last octet read
+    uint64_t nsSendMean;  // per message, acquiring the buffer and queueing it, averaged over producers
+    uint64_t nsSendMax;   // slowest single acquire and queue
+    transmit_stats_t()
+    : nProducers( 0 ), nMessages( 0 ), nOctets( 0 ), dSeconds( 0.0 ), nsSendMean( 0 ), nsSendMax( 0 ) {}
+    double MessagesPerSecond() const { return bench::PerSecond( nMessages, dSeconds ); }
+  };
+
+  transmit_stats_t Transmit( size_t nProducers, size_t nMessages ) {
+
+    transmit_stats_t stats;
+    stats.nProducers = nProducers;
+    stats.nMessages = nProducers * nMessages;
+    const uint64_t nOctetsExpected = stats.nMessages * message_octets;
+
+    Bridge bridge; // the session needs one, nothing reaches it
+
+    bench::Loopback loopback;
+
+    auto pSession = std::make_shared<tcp_session>( bridge, std::move( loopback.Session() ) );
+    pSession->start();
+
+    loopback.Run(); // write completions, which re-arm the writer when producers have queued more
+
+    // the switch side, reads until everything queued has arrived
+    const int fdSwitch = loopback.Switch();
+    bench::clock_t::time_point tpLast;
+    std::thread threadDrain(
+      [fdSwitch,nOctetsExpected,&stats,&tpLast](){
+        std::vector<uint8_t> v( max_read );
+        ssize_t n;
+        while ( ( stats.nOctets < nOctetsExpected ) && ( 0 < ( n = ::recv( fdSwitch, v.data(), v.size(), 0 ) ) ) ) {
+          stats.nOctets += n;
+        }
+        tpLast = bench::clock_t::now();
+      } );
+
+    std::vector<uint64_t> vSendTotal( nProducers );
+    std::vector<uint64_t> vSendMax( nProducers );
+    const bench::clock_t::time_point tpStart = bench::Together(
+      nProducers,
+      [&]( size_t ixProducer ){
+        uint64_t nsTotal( 0 );
+        uint64_t nsMax( 0 );
+        for ( size_t ix = 0; ix < nMessages; ix++ ) {
+          const bench::clock_t::time_point tpBegin = bench::clock_t::now();
+          vByte_t v( pSession->AcquireBuffer( message_octets ) );
+          v.resize( message_octets );
+          auto* pHeader = new( v.data() ) codec::ofp_header::ofp_header_;
+          pHeader->init();
+          pHeader->type = ofp141::ofp_type::OFPT_ECHO_REQUEST;
+          pHeader->length = message_octets;
+          pSession->Transmit( std::move( v ) );
+          const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( bench::clock_t::now() - tpBegin ).count();
+          nsTotal += ns;
+          if ( nsMax < ns ) nsMax = ns;
+        }
+        vSendTotal[ ixProducer ] = nsTotal;
+        vSendMax[ ixProducer ] = nsMax;
+      } );
+    threadDrain.join();
+    stats.dSeconds = bench::Seconds( tpStart, tpLast );
+
+    uint64_t nsTotal( 0 );
+    for ( size_t ix = 0; ix < nProducers; ix++ ) {
+      nsTotal += vSendTotal[ ix ];
+      if ( stats.nsSendMax < vSendMax[ ix ] ) stats.nsSendMax = vSendMax[ ix ];
+    }
+    if ( 0 < stats.nMessages ) stats.nsSendMean = nsTotal / stats.nMessages;
+
+    pSession.reset();
+    loopback.Stop();
+
+    return stats;
+  }
+
+  std::ostream& operator<<( std::ostream& os, const transmit_stats_t& stats ) {
+    os
+      << "producers=" << stats.nProducers
+      << ",messages=" << stats.nMessages
+      << ",octets=" << stats.nOctets
+      << ",seconds=" << stats.dSeconds
+      << ",messages/sec=" << stats.MessagesPerSecond()
+      << ",mean send ns=" << stats.nsSendMean
+      << ",max send ns=" << stats.nsSendMax
+      ;
+    return os;
+  }
+
+} // namespace anon
+
+int main( int argc, char** argv ) {
+
+  logging::SetLevel( logging::warning );
+  const size_t nMessages = bench::Arg( argc, argv, 1, 100000 );
+  const size_t nProducersMax = bench::Arg( argc, argv, 2, 8 );
+  for ( size_t nProducers = 1; nProducers <= nProducersMax; nProducers *= 2 ) {
+    const transmit_stats_t stats( Transmit( nProducers, nMessages ) ); // before the label, the bridge prints as it is built
+    std::cout << "transmit: " << stats << std::endl;
+  }
+
+  return 0;
+}
@@ -0,0 +1,118 @@
+/*
+ * File:   bounded_queue.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 2:15 PM
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <cstdint>
+#include <utility>
+
+// Bounded lock-free queue, after Dmitry Vyukov's array based mpmc queue:
+//   http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+// each cell carries a sequence number which tells producers and consumers
+//   whether the cell is free to fill or ready to drain, so the only contended
+//   operations are a single compare-exchange on the enqueue or dequeue position.
+// Front() is only safe when there is a single consumer.
+
+template<typename T>
+class BoundedQueue {
+public:
+
+  explicit BoundedQueue( size_t nCapacity ) // nCapacity needs to be a power of two
+  : m_pCells( new cell_t[ nCapacity ] ), m_mask( nCapacity - 1 ),
+    m_ixEnqueue( 0 ), m_ixDequeue( 0 )
+  {
+    assert( ( 2 <= nCapacity ) && ( 0 == ( nCapacity & m_mask ) ) );
+    for ( size_t ix = 0; ix < nCapacity; ix++ ) {
+      m_pCells[ ix ].sequence.store( ix, std::memory_order_relaxed );
+    }
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+
+  // moves from t when successful, returns false when the queue is full
+  bool Push( T& t ) {
+    cell_t* pCell;
+    size_t ix = m_ixEnqueue.load( std::memory_order_relaxed );
+    for ( ;; ) {
+      pCell = &m_pCells[ ix & m_mask ];
+      const size_t sequence = pCell->sequence.load( std::memory_order_acquire );
+      const intptr_t diff = (intptr_t)sequence - (intptr_t)ix;
+      if ( 0 == diff ) {
+        if ( m_ixEnqueue.compare_exchange_weak( ix, ix + 1, std::memory_order_relaxed ) ) break;
+      }
+      else {
+        if ( 0 > diff ) return false; // full
+        ix = m_ixEnqueue.load( std::memory_order_relaxed );
+      }
+    }
+    pCell->data = std::move( t );
+    pCell->sequence.store( ix + 1, std::memory_order_release );
+    return true;
+  }
+
+  // returns false when the queue is empty
+  bool Pop( T& t ) {
+    cell_t* pCell;
+    size_t ix = m_ixDequeue.load( std::memory_order_relaxed );
+    for ( ;; ) {
+      pCell = &m_pCells[ ix & m_mask ];
+      const size_t sequence = pCell->sequence.load( std::memory_order_acquire );
+      const intptr_t diff = (intptr_t)sequence - (intptr_t)( ix + 1 );
+      if ( 0 == diff ) {
+        if ( m_ixDequeue.compare_exchange_weak( ix, ix + 1, std::memory_order_relaxed ) ) break;
+      }
+      else {
+        if ( 0 > diff ) return false; // empty
+        ix = m_ixDequeue.load( std::memory_order_relaxed );
+      }
+    }
+    t = std::move( pCell->data );
+    pCell->sequence.store( ix + m_mask + 1, std::memory_order_release );
+    return true;
+  }
+
+  // single consumer only: next element to be popped, nullptr if none is ready
+  const T* Front() const {
+    const size_t ix = m_ixDequeue.load( std::memory_order_relaxed );
+    const cell_t& cell( m_pCells[ ix & m_mask ] );
+    if ( ( ix + 1 ) == cell.sequence.load( std::memory_order_acquire ) ) return &cell.data;
+    return nullptr;
+  }
+
+  bool Empty() const { return nullptr == Front(); }
+
+protected:
+private:
+
+  struct cell_t {
+    std::atomic<size_t> sequence;
+    T data;
+  };
+
+  typedef char pad_t[ 64 ]; // keep the two positions on separate cache lines
+
+  pad_t m_pad0;
+  const std::unique_ptr<cell_t[]> m_pCells;
+  const size_t m_mask;
+  pad_t m_pad1;
+  std::atomic<size_t> m_ixEnqueue;
+  pad_t m_pad2;
+  std::atomic<size_t> m_ixDequeue;
+  pad_t m_pad3;
+
+  BoundedQueue( const BoundedQueue& ) = delete;
+  BoundedQueue& operator=( const BoundedQueue& ) = delete;
+
+};
+
+#endif /* BOUNDED_QUEUE_H */
+
@@ -8,13 +8,17 @@
 
 #include "hexdump.h"
 
+#include "logging.h"
 #include "bridge.h"
 #include "openflow/openflow-spec1.4.1.h"
 
-#include "codecs/append.h"
+#include "codecs/builder.h"
 #include "codecs/ofp_group_mod.h"
 #include "codecs/ofp_flow_mod.h"
 #include "codecs/ofp_barrier.h"
+#include "codecs/ofp_bundle.h"
+#include "codecs/ofp_meter_mod.h"
+#include "codecs/nx_learn.h"
 #include "codecs/ofp_packet_out.h"
 #include "protocol/ethernet.h"
 
@@ -38,8 +42,32 @@
  ovs-appctl dpif/dump-flows ovsbr0  -- post 1.10
  */
 
+namespace {
+
+  namespace fm = codec::ofp_flow_mod;
+
+  // message layouts, sized at compile time for ofp::Builder
+  typedef ofp::Match<fm::ofpxmt_ofb_eth_type_, fm::ofpxmt_ofb_metadata_> matchArp_t;
+  typedef ofp::Match<fm::ofpxmt_ofb_eth_type_, fm::ofpxmt_ofb_ip_proto_, fm::ofpxmt_ofb_port_, fm::ofpxmt_ofb_metadata_> matchUdpPort_t;
+
+  typedef ofp::Actions<fm::ofp_action_output_> actionsOutput_t;
+  typedef ofp::Actions<fm::ofp_action_set_field_metadata_, fm::ofp_action_output_> actionsResubmit_t;
+  typedef ofp::Actions<fm::ofp_action_set_field_metadata_, ofp141::ofp_action_group> actionsFlood_t;
+
+  // switchLearns
+  typedef ofp::Match<fm::ofpxmt_ofb_in_port_, fm::ofpxmt_ofb_vlan_vid_> matchIngress_t;
+  typedef ofp::Match<fm::ofpxmt_ofb_vlan_vid_> matchVlan_t;
+  typedef ofp::Actions<fm::ofp_action_push_vlan_, fm::ofp_action_set_field_vlan_id_> actionsPush_t;
+  typedef ofp::Actions<ofp141::ofp_action_group> actionsGroup_t;
+
+}
+
 Bridge::Bridge( )
-: m_bRulesInjectionActive( false ), m_bGroupTrunkAllAdded( false )
+: m_bRulesInjectionActive( false ), m_bGroupTrunkAllAdded( false ),
+  m_eFirstPacket( FirstPacket::direct ), m_eLearnMode( LearnMode::controllerLearns ),
+  m_templates( FlowTemplates::flow_t{ 0x201, 1024, 30, ofp141::ofp_flow_mod_flags::OFPFF_SEND_FLOW_REM } ), // cookie, priority, idle_timeout, flags
+  m_rateMeter( DefaultMeterRates() ),
+  m_bUseBundles( true )
 {
   std::cout << "Bridge::Bridge construction" << std::endl;
 }
@@ -53,23 +81,19 @@ Bridge::MacStatus Bridge::Update( nPort_t nPort, idVlan_t idVlan, const MacAddre
     throw std::runtime_error( "Bridge::Update need port > 0" );
   }
 
+  std::unique_lock<std::mutex> lock( m_mutex ); // packet_in pipeline workers run concurrently
+
   MacStatus status( StatusQuo );
 
   if ( macSource.IsMulticast() ) {
     status = Multicast;
-    std::cout
-      << "bridge: found source multicast " << macSource.Value()
-      << " on port " << nPort
-      << std::endl;
+    LOG_WARNING( "bridge: found source multicast {} on port {}", logging::hex( macSource.Value(), 6, ':' ), nPort );
     // this is an illegal option, source mac cannot be multicast
   }
   else {
     if ( macSource.IsBroadcast() ) {
       status = Broadcast;
-      std::cout
-        << "bridge: found source broadcast " << macSource.Value()
-        << " on port " << nPort
-        << std::endl;
+      LOG_WARNING( "bridge: found source broadcast {} on port {}", logging::hex( macSource.Value(), 6, ':' ), nPort );
       // will need to evaluate this, and look at the meanings
     }
     else {
@@ -78,10 +102,7 @@ Bridge::MacStatus Bridge::Update( nPort_t nPort, idVlan_t idVlan, const MacAddre
         std::pair<MacAddress, MacInfo> pair( macSource, MacInfo( nPort ) );
         iterMapMac = m_mapMac.insert( m_mapMac.begin(), pair ); // vlan is dealt with below
         status = Learned;
-        std::cout
-          << "bridge: mac " << HexDump<const uint8_t*>( macSource.Value(), macSource.Value() + 6, ':' )
-          << " learned on port " << nPort
-          << std::endl;
+        LOG_INFO( "bridge: mac {} learned on port {}", logging::hex( macSource.Value(), 6, ':' ), nPort );
       }
       else {
         if ( nPort != iterMapMac->second.m_inPort ) { // mac moved (check for flap sometime)
@@ -90,11 +111,9 @@ Bridge::MacStatus Bridge::Update( nPort_t nPort, idVlan_t idVlan, const MacAddre
           mac_info.m_cntMoved++;
           mac_info.m_setVlanEncountered.clear();
           status = Moved;
-          std::cout
-            << "bridge: mac " << HexDump<const uint8_t*>( macSource.Value(), macSource.Value() + 6, ':' )
-            << " moved to port " << nPort
-            << " flap count " << mac_info.m_cntMoved
-            << std::endl;
+          LOG_INFO(
+            "bridge: mac {} moved to port {} flap count {}",
+            logging::hex( macSource.Value(), 6, ':' ), nPort, mac_info.m_cntMoved );
         }
       }
       if ( 0 != idVlan ) {
@@ -102,10 +121,7 @@ Bridge::MacStatus Bridge::Update( nPort_t nPort, idVlan_t idVlan, const MacAddre
         setVlan_t::iterator iterSetVlan = setVlanEncountered.find( idVlan );
         if ( setVlanEncountered.end() == iterSetVlan ) {
           setVlanEncountered.insert( idVlan );
-          std::cout
-            << "bridge: mac " << HexDump<const uint8_t*>( macSource.Value(), macSource.Value() + 6, ':' )
-            << " has vlan " << idVlan
-            << std::endl;
+          LOG_INFO( "bridge: mac {} has vlan {}", logging::hex( macSource.Value(), 6, ':' ), idVlan );
         }
       }
     }
@@ -117,26 +133,24 @@ Bridge::MacStatus Bridge::Update( nPort_t nPort, idVlan_t idVlan, const MacAddre
 // TODO:  two parameters:  1) forward via group or outport only, and 2) add metadata to match
 void Bridge::Forward( ofport_t ofp_ingress, idVlan_t vlan,
                       const MacAddress& macSrc, const MacAddress& macDst,
-                      uint8_t* pPacket, size_t nOctets
+                      const payload_t& payload
 ) {
 
+  std::unique_lock<std::mutex> lock( m_mutex ); // packet_in pipeline workers run concurrently
+
   bool bSomethingOdd( false );
 
   bSomethingOdd |= macSrc.IsBroadcast();
   bSomethingOdd |= macSrc.IsMulticast();
 
   if ( bSomethingOdd ) {
-    std::cout
-      << "bridge::forward: src is broadcast or multicast, ignoring"
-      << std::endl;
+    LOG_WARNING( "bridge::forward: src is broadcast or multicast, ignoring" );
   }
   else {
 
     mapMac_t::iterator iterMapMacSrc = m_mapMac.find( macSrc );
     if ( m_mapMac.end() == iterMapMacSrc ) {
-      std::cout
-        << "bridge:;forward: src mac is not in lookup, ignoring, should have already been set"
-        << std::endl;
+      LOG_WARNING( "bridge::forward: src mac is not in lookup, ignoring, should have already been set" );
     }
     else {
 
@@ -146,9 +160,7 @@ void Bridge::Forward( ofport_t ofp_ingress, idVlan_t vlan,
 
       mapInterface_t::iterator iterInterface = m_mapInterface.find( ofp_ingress );
       if ( m_mapInterface.end() == iterInterface ) {
-        std::cout
-          << "bridge::forward - couldn't find inbound interface " << ofp_ingress
-          << std::endl;
+        LOG_WARNING( "bridge::forward - couldn't find inbound interface {}", ofp_ingress );
       }
       else {
 
@@ -167,6 +179,14 @@ void Bridge::Forward( ofport_t ofp_ingress, idVlan_t vlan,
 
         assert( 0 != vlan ); // not sure what other conditions we are going to have for now
 
+        if ( ( LearnMode::switchLearns == m_eLearnMode ) && HasIngress( interfaceSrc, vlan, bSrcAccess ) ) {
+          // the ingress flow learns the source and the learned table forwards or floods, as for any other frame
+          LOG_TRACE( "bridge::forward to the tables from {} in vlan {}", ofp_ingress, vlan );
+          m_statsForward.nToTables++;
+          TransmitResubmit( ofp_ingress, payload );
+          return;
+        }
+
         bool bBroadcast( false );
 
         bBroadcast |= macDst.IsBroadcast(); // probably redundant comparison, given map lookup below
@@ -177,175 +197,387 @@ void Bridge::Forward( ofport_t ofp_ingress, idVlan_t vlan,
 
         if ( bBroadcast ) {
           // route via group
-          std::cout
-            << "bridge::forward broadcast from " << ofp_ingress
-            << ", to vlan " << vlan
-            << ", on group " << vlan + ( bSrcAccess ? 10000 : 20000 )
-            << ", packet size of " << nOctets
-            << std::endl;
+          LOG_TRACE(
+            "bridge::forward broadcast from {}, to vlan {}, on group {}, packet size of {}",
+            ofp_ingress, vlan, vlan + ( bSrcAccess ? 10000 : 20000 ), payload.nOctets );
 
-          vByte_t v = std::move( m_fAcquireBuffer() );
-          v.clear();
+          const size_t nOctets( ofp::PacketOutSize( actionsFlood_t::size ) );
+          vByte_t v = std::move( m_fAcquireBuffer( nOctets + payload.CopyOctets() ) );
+          ofp::Builder build( v, nOctets );
 
-          auto* pOut = ofp::Append<codec::ofp_packet_out::ofp_packet_out_>( v );
+          auto* pOut = build.Append<codec::ofp_packet_out::ofp_packet_out_>();
           pOut->initv2( ofp_ingress );
 
-          vByte_t::size_type sizePreAction = v.size();
-
-          auto* pActionSetMetadata = ofp::Append<codec::ofp_flow_mod::ofp_action_set_field_metadata_>( v );
+          auto* pActionSetMetadata = build.Append<codec::ofp_flow_mod::ofp_action_set_field_metadata_>();
           pActionSetMetadata->init( 1 );  // todo, pass this in at some point, currently used to bypass static flows
 
-          auto* pGroup = ofp::Append<ofp141::ofp_action_group>( v );
+          auto* pGroup = build.Append<ofp141::ofp_action_group>();
           pGroup->type = ofp141::ofp_action_type::OFPAT_GROUP;
           pGroup->len  = sizeof( ofp141::ofp_action_group );
           pGroup->group_id = vlan + ( bSrcAccess ? 10000 : 20000 );
 
-          pOut->actions_len = v.size() - sizePreAction;
+          pOut->actions_len = actionsFlood_t::size;
+          assert( build.Complete() );
 
-          vByte_t::size_type size = v.size();
-          v.resize( v.size() + nOctets );
-          auto* pAppend = v.data() + size;
-          std::memcpy( pAppend, pPacket, nOctets );
-          pOut->header.length = v.size();
-
-          assert( 0 != m_fTransmitBuffer );
-          m_fTransmitBuffer( std::move( v ) );
+          TransmitPacketOut( std::move( v ), payload );
         }
         else {
+
+          const ofport_t ofportDst( iterMapMacDst->second.m_inPort );
+          mapInterface_t::iterator iterInterfaceDst = m_mapInterface.find( ofportDst );
+          assert( m_mapInterface.end() != iterInterfaceDst );
+          interface_t& interfaceDst( iterInterfaceDst->second );
+
+          // the vlan arrives tagged on a trunk, and leaves tagged unless the egress port carries it untagged
+          assert( ( vlan == interfaceDst.tag ) || ( interfaceDst.setTrunk.end() != interfaceDst.setTrunk.find( vlan ) ) );
+          const FlowTemplates::Shape shape( FlowTemplates::ToShape( bSrcAccess, vlan == interfaceDst.tag ) );
+
+          const flow_key_t key( ofp_ingress, vlan, bSrcAccess, macSrc, macDst );
+          if ( Installed( key ) ) {
+            // the packet_in was on its way up as the flow went in
+            LOG_TRACE( "bridge::forward installed from {} in vlan {} out port {}", ofp_ingress, vlan, ofportDst );
+            TransmitDirect( ofp_ingress, shape, vlan, ofportDst, payload );
+            return;
+          }
+          if ( !BeginPending( key ) ) {
+            // the conversation's flow_mod is still on its way in, the packet takes the flow's actions,
+            //   resubmitting would only bring it back as another packet_in
+            LOG_TRACE( "bridge::forward pending from {} in vlan {} out port {}", ofp_ingress, vlan, ofportDst );
+            TransmitDirect( ofp_ingress, shape, vlan, ofportDst, payload );
+            return;
+          }
+
           // install rules into table and route via tables
-          std::cout
-            << "bridge::forward specific from " << ofp_ingress
-            << " in vlan " << vlan;
+          const size_t nOctets( m_templates.FlowModSize( shape ) );
+          vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+          ofp::Builder build( v, nOctets );
+          m_templates.FlowMod( build, shape, ofp_ingress, vlan, macSrc.Value(), macDst.Value(), ofportDst );
+          assert( build.Complete() );
+
+          LOG_TRACE(
+            "bridge::forward specific from {} in vlan {} out port {}",
+            ofp_ingress, vlan, ofportDst );
+
+          m_statsForward.nFlows++;
+          m_statsForward.nMessages++;
+          m_statsForward.nOctets += v.size();
+
+          if ( FirstPacket::direct == m_eFirstPacket ) {
+            // the packet_out carries the flow's own actions, so the frame goes straight out
+            //   without waiting for the flow_mod to be in the table, and no barrier follows:
+            //   the flow_mod's own xid ends the pending state, on its error, or once its window passes
+            m_fTransmitTracked( std::move( v ), [this,key]( bool bCompleted ){ EndPending( key, bCompleted ); } );
+            m_statsForward.nMessages++;
+            m_statsForward.nOctets += TransmitDirect( ofp_ingress, shape, vlan, ofportDst, payload );
+          }
+          else {
+            m_fTransmitBuffer( std::move( v ) );
 
-          vByte_t v = std::move( m_fAcquireBuffer() );
-          v.clear();
+            // === a barrier to ensure flow rules are installed prior to
+            //       resubmitting the packet to the tables
+            TransmitBarrier( key );
 
-          auto* pFlowMod = ofp::Append<codec::ofp_flow_mod::ofp_flow_mod_>( v );
-          pFlowMod->init();
-          pFlowMod->idle_timeout = 30;
-          pFlowMod->cookie = 0x201;
-          pFlowMod->priority = 1024;
+            // === then send the packet back to the tables for processing,
+            //        flow rules have been installed above
+            m_statsForward.nMessages++;
+            m_statsForward.nOctets += TransmitResubmit( ofp_ingress, payload );
+          }
 
-          auto* pMatch = new ( &pFlowMod->match ) codec::ofp_flow_mod::ofp_match_;
-          //pMatch->init();  // already performed in init above
+        }
+      }
+    }
+  }
 
-          assert( 4 ==  sizeof( pFlowMod->match.pad ) );
-          v.resize( v.size() - sizeof( pFlowMod->match.pad ) );  // subtract the padding field in ofp_match
-          vByte_t::size_type sizeMatchesStart = v.size();
+}
 
-          auto* pMatchInPort = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_in_port_>( v );
-          pMatchInPort->init( ofp_ingress );
+// a packet_out with the same actions as the flow, returns octets sent
+size_t Bridge::TransmitDirect(
+  ofport_t ofp_ingress, FlowTemplates::Shape shape, idVlan_t vlan, ofport_t ofportDst, const payload_t& payload
+) {
+  const FlowTemplates::Egress egress( FlowTemplates::ToEgress( shape ) );
+  const size_t nOctets( m_templates.PacketOutSize( egress ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets + payload.CopyOctets() ) );
+  ofp::Builder build( v, nOctets );
+  m_templates.PacketOut( build, egress, ofp_ingress, vlan, ofportDst );
+  assert( build.Complete() );
+
+  return TransmitPacketOut( std::move( v ), payload );
+}
 
-          auto* pMatchDstMac = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_mac_>( v );
-          pMatchDstMac->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST, macDst.Value() );
+size_t Bridge::TransmitResubmit( ofport_t ofp_ingress, const payload_t& payload ) {
 
-          auto* pMatchSrcMac = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_mac_>( v );
-          pMatchSrcMac->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC, macSrc.Value() );
+  const size_t nOctets( ofp::PacketOutSize( actionsResubmit_t::size ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets + payload.CopyOctets() ) );
+  ofp::Builder build( v, nOctets );
 
-          auto* pMatchVlan   = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_vlan_vid_>( v );
-          if ( bSrcAccess ) {
-            pMatchVlan->init();
-          }
-          else {
-            pMatchVlan->init( vlan );
-          }
+  auto*  pOut = build.Append<codec::ofp_packet_out::ofp_packet_out_>();
+  pOut->initv2( ofp_ingress );
 
-          pMatch->length += v.size() - sizeMatchesStart;
+  auto* pActionSetMetadata = build.Append<codec::ofp_flow_mod::ofp_action_set_field_metadata_>();
+  pActionSetMetadata->init( 1 );  // todo, pass this in at some point, currently used to bypass static flows
 
-          v.resize( v.size() + pMatch->fill_size() );
-          pMatch->fill();
+  auto* pOutput = build.Append<codec::ofp_flow_mod::ofp_action_output_>();
+  pOutput->init( ofp141::ofp_port_no::OFPP_TABLE );
 
-          mapInterface_t::iterator iterInterfaceDst = m_mapInterface.find( iterMapMacDst->second.m_inPort );
-          assert( m_mapInterface.end() != iterInterfaceDst );
-          interface_t& interfaceDst( iterInterfaceDst->second );
+  pOut->actions_len = actionsResubmit_t::size;
+  assert( build.Complete() );
 
-          vByte_t::size_type sizeActionsStart = v.size();
+  return TransmitPacketOut( std::move( v ), payload );
+}
 
-          auto* pActions = ofp::Append<codec::ofp_flow_mod::ofp_instruction_actions_>( v );
-          pActions->init();
+// the reply ends the conversation's pending state, the flow_mod sent before it has been applied
+void Bridge::TransmitBarrier( const flow_key_t& key ) {
 
-          if ( bSrcAccess ) { // working with source access port
-            if ( vlan == interfaceDst.tag ) {} // pass packet to access port
-            else {
-              // attach the 802.1q header
-              assert( interfaceDst.setTrunk.end() != interfaceDst.setTrunk.find( vlan ) );
+  vByte_t v = std::move( m_fAcquireBuffer( sizeof( codec::ofp_barrier::ofp_barrier_ ) ) );
+  ofp::Builder build( v, sizeof( codec::ofp_barrier::ofp_barrier_ ) );
 
-              auto* pActionPushVlan = ofp::Append<codec::ofp_flow_mod::ofp_action_push_vlan_>( v );
-              pActionPushVlan->init( 0x8100 );
+  auto* pBarrier = build.Append<codec::ofp_barrier::ofp_barrier_>();
+  pBarrier->init();
 
-              auto* pActionSetVlan  = ofp::Append<codec::ofp_flow_mod::ofp_action_set_field_vlan_id_>( v );
-              pActionSetVlan->init( vlan );
-            }
-          }
-          else { // working with source trunk port
-            if ( vlan == interfaceDst.tag ) { // destination access port, so pop vlan
-              auto* pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_pop_vlan_>( v );
-              pAction->init();
-            }
-            else { // pass packet onto trunk port
-              assert( interfaceDst.setTrunk.end() != interfaceDst.setTrunk.find( vlan ) );
-            }
-          }
+  m_statsForward.nMessages++;
+  m_statsForward.nOctets += v.size();
+  m_fTransmitRequest( std::move( v ), [this,key]( bool bCompleted ){ EndPending( key, bCompleted ); } );
+}
 
-          auto* pOutput = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
-          pOutput->init( iterMapMacDst->second.m_inPort );
+// true when the conversation has no flow_mod in flight, and now has
+bool Bridge::BeginPending( const flow_key_t& key ) {
+  std::unique_lock<std::mutex> lock( m_mutexPending );
+  auto result = m_mapPending.emplace( key, 0 );
+  if ( !result.second ) {
+    result.first->second++;
+    m_statsForward.nSuppressed++;
+  }
+  return result.second;
+}
 
-          std::cout << " out port " << iterMapMacDst->second.m_inPort << std::endl;
+// on the session's socket thread, or its timer on a timeout, so not under m_mutex
+void Bridge::EndPending( const flow_key_t& key, bool bCompleted ) {
+  std::unique_lock<std::mutex> lock( m_mutexPending );
+  mapPending_t::iterator iter = m_mapPending.find( key );
+  if ( m_mapPending.end() != iter ) {
+    if ( bCompleted ) {
+      m_statsForward.nInstalled++;
+      if ( m_flows.Insert( LiveKey( key ), FlowIndex::clock_t::now() ) ) {
+        m_mapMacFlows[ key.macSrc ]++;
+        m_mapMacFlows[ key.macDst ]++;
+      }
+    }
+    else {
+      m_statsForward.nFailed++;
+      LOG_WARNING( "bridge: flow from port {} not confirmed, {} packets sent meanwhile", key.ofportIn, iter->second );
+    }
+    m_mapPending.erase( iter );
+  }
+}
 
-          pActions->len = v.size() - sizeActionsStart;
+FlowIndex::key_t Bridge::LiveKey( const flow_key_t& key ) const {
+  return FlowIndex::key_t( m_templates.Cookie(), key.ofportIn, key.vidMatch, key.macSrc.Value(), key.macDst.Value() );
+}
 
-          pFlowMod->header.length = v.size();
+// a packet_in for a flow the switch should hold: within the window, it crossed the flow_mod,
+//   after it, the flow went without a flow_removed reaching us, so it is installed again
+bool Bridge::Installed( const flow_key_t& key ) {
+  std::unique_lock<std::mutex> lock( m_mutexPending );
+  const FlowIndex::key_t keyLive( LiveKey( key ) );
+  const FlowIndex::clock_t::time_point* pInstalled = m_flows.Find( keyLive );
+  if ( nullptr == pInstalled ) return false;
+  if ( ( FlowIndex::clock_t::now() - *pInstalled ) < std::chrono::milliseconds( crossing_window_ms ) ) {
+    m_statsForward.nSkipped++;
+    return true;
+  }
+  m_statsForward.nStale++;
+  m_flows.Drop( keyLive );
+  ReleaseMacFlows( key.macSrc );
+  ReleaseMacFlows( key.macDst );
+  return false;
+}
 
-          m_fTransmitBuffer( std::move( v ) );
+bool Bridge::ReleaseMacFlows( const MacAddress& mac ) {
+  mapMacFlows_t::iterator iter = m_mapMacFlows.find( mac );
+  if ( ( m_mapMacFlows.end() != iter ) && ( 0 == --iter->second ) ) {
+    m_mapMacFlows.erase( iter );
+    return true;
+  }
+  return false;
+}
 
-          // === append a barrier message to ensure flow rules are installed prior to
-          //       resubmitting packet to tables
-          //if ( false )
-          {
-            vByte_t v = std::move( m_fAcquireBuffer() );
-            v.clear();
+void Bridge::AgeMac( const MacAddress& mac, const nPort_t* pPort ) {
+  mapMac_t::iterator iterMac = m_mapMac.find( mac );
+  if ( ( m_mapMac.end() != iterMac ) && ( ( nullptr == pPort ) || ( *pPort == iterMac->second.m_inPort ) ) ) {
+    LOG_INFO( "bridge: mac {} aged out on port {}", logging::hex( mac.Value(), 6, ':' ), iterMac->second.m_inPort );
+    m_mapMac.erase( iterMac );
+    m_statsForward.nAged++;
+  }
+}
 
-            auto* pBarrier = ofp::Append<codec::ofp_barrier::ofp_barrier_>( v );
-            pBarrier->init();
+// from the session's socket thread; a mac is forgotten once the last flow from or to it idles out,
+//   as it has neither sent nor been sent anything for the idle timeout; a source is kept when it has
+//   since moved from the flow's in_port, a destination has no port in the match to check against
+bool Bridge::FlowRemoved( const codec::ofp_flow_removed::removed_t& removed ) {
+
+  if ( m_templates.Cookie() != removed.cookie ) return false;
+
+  typedef codec::ofp_match::match_fields fields_t;
+  static const uint64_t bitsKey
+    = fields_t::Bit( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_IN_PORT )
+    | fields_t::Bit( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_VLAN_VID )
+    | fields_t::Bit( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC )
+    | fields_t::Bit( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST );
+  const fields_t& fields( removed.fields );
+  if ( !fields.HasAll( bitsKey ) ) {
+    LOG_WARNING( "bridge: flow_removed with cookie {} lacks the learned pair match", removed.cookie );
+    return true;
+  }
 
-            m_fTransmitBuffer( std::move( v ) );
-          }
+  const FlowIndex::key_t key(
+    removed.cookie, fields.value.in_port, fields.value.vlan_vid, fields.value.eth_src, fields.value.eth_dst );
+  const MacAddress macSrc( fields.value.eth_src );
+  const MacAddress macDst( fields.value.eth_dst );
 
-          // === append command to send packet back to the tables for processing
-          //        flow rules have been installed above
-          //if ( false )
-          {
-            vByte_t v = std::move( m_fAcquireBuffer() );
-            v.clear();
+  std::unique_lock<std::mutex> lock( m_mutex );
+  std::unique_lock<std::mutex> lockPending( m_mutexPending );
+
+  if ( m_flows.Removed( key, removed.packet_count, removed.byte_count ) ) {
+    const bool bLastFrom( ReleaseMacFlows( macSrc ) );
+    const bool bLastTo( ReleaseMacFlows( macDst ) );
+    if ( ofp141::ofp_flow_removed_reason::OFPRR_IDLE_TIMEOUT == removed.reason ) {
+      const nPort_t nPortIn( fields.value.in_port );
+      if ( bLastFrom ) AgeMac( macSrc, &nPortIn );
+      if ( bLastTo ) AgeMac( macDst, nullptr );
+    }
+  }
+  return true;
+}
 
-            auto*  pOut = ofp::Append<codec::ofp_packet_out::ofp_packet_out_>( v );
-            pOut->initv2( ofp_ingress );
+size_t Bridge::TransmitPacketOut( vByte_t v, const payload_t& payload ) {
+  auto* pOut = new( v.data() ) codec::ofp_packet_out::ofp_packet_out_;
+  size_t nOctets;
+  if ( payload.Buffered() ) { // the switch still has the frame
+    pOut->buffer_id = payload.idBuffer;
+    pOut->header.length = nOctets = v.size();
+    m_fTransmitBuffer( std::move( v ) );
+  }
+  else if ( payload.pHolder ) { // gathered straight out of the receive buffer on transmit
+    pOut->header.length = nOctets = v.size() + payload.nOctets;
+    assert( 0 != m_fTransmitWithPayload );
+    m_fTransmitWithPayload( std::move( v ), payload );
+  }
+  else {
+    pOut->header.length = nOctets = v.size() + payload.nOctets; // before the insert, which may move the buffer
+    v.insert( v.end(), payload.pBegin, payload.pBegin + payload.nOctets );
+    assert( 0 != m_fTransmitBuffer );
+    m_fTransmitBuffer( std::move( v ) );
+  }
+  return nOctets;
+}
 
-            vByte_t::size_type sizePreAction = v.size();
+void Bridge::SetFirstPacket( FirstPacket eFirstPacket ) {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_eFirstPacket = eFirstPacket;
+}
 
-            auto* pActionSetMetadata = ofp::Append<codec::ofp_flow_mod::ofp_action_set_field_metadata_>( v );
-            pActionSetMetadata->init( 1 );  // todo, pass this in at some point, currently used to bypass static flows
+void Bridge::SetLearnMode( LearnMode eLearnMode ) {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_eLearnMode = eLearnMode;
+}
 
-            auto* pOutput = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
-            pOutput->init( ofp141::ofp_port_no::OFPP_TABLE );
+void Bridge::SetUseBundles( bool bUseBundles ) {
+  m_bUseBundles = bUseBundles;
+}
 
-            pOut->actions_len = v.size() - sizePreAction;
+Bridge::forward_stats_t Bridge::ForwardStats() {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  std::unique_lock<std::mutex> lockPending( m_mutexPending );
+  forward_stats_t stats( m_statsForward );
+  stats.nPending = m_mapPending.size();
+  stats.nLive = m_flows.Size();
+  stats.index = m_flows.Stats();
+  return stats;
+}
+
+std::ostream& operator<<( std::ostream& os, const Bridge::forward_stats_t& stats ) {
+  os
+    << "new flows=" << stats.nFlows
+    << ",messages=" << stats.nMessages
+    << ",octets=" << stats.nOctets
+    << ",messages/flow=" << stats.MessagesPerFlow()
+    << ",octets/flow=" << stats.OctetsPerFlow()
+    << ",installed=" << stats.nInstalled
+    << ",failed=" << stats.nFailed
+    << ",pending=" << stats.nPending
+    << ",duplicates suppressed=" << stats.nSuppressed
+    << ",crossed installs skipped=" << stats.nSkipped
+    << ",stale=" << stats.nStale
+    << ",live=" << stats.nLive
+    << ",macs aged=" << stats.nAged
+    << ",to tables=" << stats.nToTables
+    << ",index " << stats.index
+    ;
+  return os;
+}
 
-            vByte_t::size_type size = v.size();
-            v.resize( v.size() + nOctets );
-            auto* pAppend = v.data() + size;
-            std::memcpy( pAppend, pPacket, nOctets );
+namespace {
+  const char* szMeterClass[] = { "miss", "arp", "dhcp", "dns" };
+}
 
-            pOut->header.length = v.size();
+// rates are what a controller keeps up with while the other classes are busy too
+Bridge::meter_rates_t Bridge::DefaultMeterRates() {
+  meter_rates_t rates;
+  rates[ meterMiss ] = meter_rate_t{ 500, 100 };
+  rates[ meterArp ]  = meter_rate_t{ 200, 50 };
+  rates[ meterDhcp ] = meter_rate_t{ 50, 20 };
+  rates[ meterDns ]  = meter_rate_t{ 200, 50 };
+  return rates;
+}
 
-            m_fTransmitBuffer( std::move( v ) );
-          }
+void Bridge::SetMeterRates( const meter_rates_t& rates ) {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  m_rateMeter = rates;
+}
 
-        }
-      }
-    }
+uint32_t Bridge::Meter( MeterClass eClass ) {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  return MeterFor( eClass );
+}
+
+// counters restart with the meter, when the switch reconnects
+void Bridge::UpdateMeter( const codec::ofp_multipart::meter_t& meter ) {
+
+  const uint32_t idMeter( meter.stats.meter_id );
+  if ( ( 0 == idMeter ) || ( nMeterClasses < idMeter ) ) return; // not one of ours
+  const MeterClass eClass( (MeterClass)( idMeter - 1 ) );
+
+  uint64_t nShed( 0 );
+  for ( size_t ix = 0; ix < meter.nBands; ix++ ) {
+    nShed += meter.pBands[ ix ].packet_band_count;
+  }
+
+  std::unique_lock<std::mutex> lock( m_mutex );
+  meter_stats_t& stats( m_statsMeter[ eClass ] );
+  const uint64_t nShedBefore( ( nShed < stats.nShed ) ? 0 : stats.nShed );
+  stats.nFlows = meter.stats.flow_count;
+  stats.nPackets = meter.stats.packet_in_count;
+  stats.nShed = nShed;
+  stats.nPolls++;
+  if ( nShedBefore < nShed ) {
+    LOG_WARNING( "bridge: meter {} ({} at {} pps) shed {} packet_in since the last poll, {} in all",
+      idMeter, szMeterClass[ eClass ], m_rateMeter[ eClass ].pps, nShed - nShedBefore, nShed );
   }
+}
+
+Bridge::meter_stats_array_t Bridge::MeterStats() {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  return m_statsMeter;
+}
 
+std::ostream& operator<<( std::ostream& os, const Bridge::meter_stats_t& stats ) {
+  os
+    << "flows=" << stats.nFlows
+    << ",packets=" << stats.nPackets
+    << ",shed=" << stats.nShed
+    << ",polls=" << stats.nPolls
+    ;
+  return os;
 }
 
 void Bridge::UpdateInterface( const interface_t& interface_ ) {
@@ -427,7 +659,24 @@ void Bridge::UpdateInterface( const interface_t& interface_ ) {
 
       //std::cout << "** Bridge::m_bRulesInjectionActive passed" << std::endl;
 
-      BuildGroups();
+      setVlan_t setVlanChanged; // their flood flows are sent along with their groups
+      for ( const auto& entry: m_mapVlanToPort ) {
+        if ( entry.second.bGroupNeedsUpdate ) setVlanChanged.insert( entry.first );
+      }
+
+      Program( [this,&interface,&setVlanChanged]( const fTransmitBuffer_t& fTransmit ){
+        BuildGroups( fTransmit );
+        if ( LearnMode::switchLearns == m_eLearnMode ) {
+          InsertIngress( fTransmit, interface );
+          for ( idVlan_t idVlan: setVlanChanged ) InsertFlood( fTransmit, idVlan );
+          if ( !setVlanChanged.empty() ) { // ports carrying every vlan take the new ones too
+            for ( ofport_t ofport: m_setPortWithAllVlans ) {
+              mapInterface_t::const_iterator iter = m_mapInterface.find( ofport );
+              if ( ( m_mapInterface.end() != iter ) && ( ofport != interface.ofport ) ) InsertIngress( fTransmit, iter->second );
+            }
+          }
+        }
+      } );
 
     }
   }
@@ -440,7 +689,10 @@ void Bridge::DelInterface( ofport_t ) {
 void Bridge::UpdateState( ofport_t, OpState admin_state, OpState link_state ) {
 }
 
-void Bridge::StartRulesInjection( fAcquireBuffer_t fAcquireBuffer, fTransmitBuffer_t fTransmitBuffer ) {
+void Bridge::StartRulesInjection(
+  fAcquireBuffer_t fAcquireBuffer, fTransmitBuffer_t fTransmitBuffer, fTransmitWithPayload_t fTransmitWithPayload,
+  fTransmitRequest_t fTransmitRequest, fTransmitTracked_t fTransmitTracked
+) {
 
   //std::cout << "** Bridge::m_bRulesInjectionActive locking" << std::endl;
 
@@ -450,215 +702,400 @@ void Bridge::StartRulesInjection( fAcquireBuffer_t fAcquireBuffer, fTransmitBuff
   m_fAcquireBuffer =  std::move( fAcquireBuffer );
   assert( nullptr != fTransmitBuffer );
   m_fTransmitBuffer = std::move( fTransmitBuffer );
+  assert( nullptr != fTransmitWithPayload );
+  m_fTransmitWithPayload = std::move( fTransmitWithPayload );
+  assert( nullptr != fTransmitRequest );
+  m_fTransmitRequest = std::move( fTransmitRequest );
+  assert( nullptr != fTransmitTracked );
+  m_fTransmitTracked = std::move( fTransmitTracked );
 
   //std::cout << "** Bridge::m_bRulesInjectionActive to be set" << std::endl;
 
   m_bRulesInjectionActive = true;
 
+  { // a new connection, whatever the switch held is programmed over
+    std::unique_lock<std::mutex> lockPending( m_mutexPending );
+    m_flows.Clear();
+    m_mapMacFlows.clear();
+  }
+
   //std::cout << "** Bridge::m_bRulesInjectionActive is set" << std::endl;
 
+  InsertMeters(); // ahead of the flows referring to them
+
   // TODO: send what we know
-  BuildGroups();
-  InsertArpIntercept();
-  InsertDhcpIntercept( 67 );
-  InsertDhcpIntercept( 68 );
-  InsertDnsIntercept( protocol::ethernet::Ethertype::ipv4, ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_DST, 17 );
-  InsertDnsIntercept( protocol::ethernet::Ethertype::ipv4, ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_SRC, 17 );
+  Program(
+    [this]( const fTransmitBuffer_t& fTransmit ){
+      BuildGroups( fTransmit );
+      InsertArpIntercept( fTransmit );
+      InsertDhcpIntercept( fTransmit, 67 );
+      InsertDhcpIntercept( fTransmit, 68 );
+      InsertDnsIntercept( fTransmit, protocol::ethernet::Ethertype::ipv4, ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_DST, 17 );
+      InsertDnsIntercept( fTransmit, protocol::ethernet::Ethertype::ipv4, ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_SRC, 17 );
+      if ( LearnMode::switchLearns == m_eLearnMode ) {
+        for ( const auto& entry: m_mapInterface ) InsertIngress( fTransmit, entry.second );
+        for ( const auto& entry: m_mapVlanToPort ) InsertFlood( fTransmit, entry.first );
+      }
+    } );
 }
 
-void Bridge::InsertArpIntercept() {
+// with bundles, the switch applies the batch at commit, all or nothing, so a vlan's groups
+//   are never seen half rebuilt; otherwise each message is applied as it arrives.
+// a refused commit has the builder send the batch again unbundled, later batches go unbundled too
+void Bridge::Program( std::function<void(const fTransmitBuffer_t&)> f ) {
+  if ( m_bUseBundles ) {
+    codec::ofp_bundle::Builder bundle(
+      m_fAcquireBuffer, m_fTransmitBuffer, m_fTransmitRequest,
+      [this]( vByte_t v, codec::ofp_bundle::Builder::pMessage_t pMessage ){
+        const payload_t payload( pMessage, pMessage->data(), pMessage->size() );
+        m_fTransmitWithPayload( std::move( v ), payload );
+      } );
+    f( bundle.Transmit() );
+    const size_t nMessages( bundle.Messages() );
+    bundle.Commit( [this,nMessages]( bool bCommitted ){ // m_mutex may or may not be held here
+      if ( !bCommitted ) {
+        m_bUseBundles = false;
+        LOG_WARNING( "bridge: bundle of {} messages not committed, sent unbundled, bundles now off", nMessages );
+      }
+    } );
+  }
+  else {
+    f( m_fTransmitBuffer );
+  }
+}
+
+// sent on their own, ahead of any bundle, ovs does not take meter_mod into a bundle;
+//   whatever meters a previous connection left are removed first, so each is added afresh
+void Bridge::InsertMeters() {
+
+  m_fTransmitBuffer( std::move( codec::ofp_meter_mod::CreateDelete(
+    std::move( m_fAcquireBuffer( codec::ofp_meter_mod::DeleteSize() ) ), ofp141::ofp_meter::OFPM_ALL ) ) );
+
+  for ( size_t ix = 0; ix < nMeterClasses; ix++ ) {
+    const MeterClass eClass( (MeterClass)ix );
+    const uint32_t idMeter( MeterFor( eClass ) );
+    if ( 0 != idMeter ) {
+      const meter_rate_t& rate( m_rateMeter[ eClass ] );
+      m_fTransmitBuffer( std::move( codec::ofp_meter_mod::Create(
+        std::move( m_fAcquireBuffer( codec::ofp_meter_mod::Size() ) ),
+        ofp141::ofp_meter_mod_command::OFPMC_ADD, idMeter, rate.pps, rate.burst ) ) );
+      LOG_INFO( "bridge: meter {} for {} packet_in at {} pps, burst {}", idMeter, szMeterClass[ eClass ], rate.pps, rate.burst );
+    }
+  }
+}
+
+size_t Bridge::MeterSize( uint32_t idMeter ) {
+  return ( 0 == idMeter ) ? 0 : sizeof( codec::ofp_flow_mod::ofp_instruction_meter_ );
+}
+
+void Bridge::AppendMeter( ofp::Builder& build, uint32_t idMeter ) {
+  if ( 0 != idMeter ) {
+    auto* pMeter = build.Append<codec::ofp_flow_mod::ofp_instruction_meter_>();
+    pMeter->init( idMeter );
+  }
+}
+
+void Bridge::InsertArpIntercept( const fTransmitBuffer_t& fTransmit ) {
 
   //std::cout << "InsertArpIntercept" << std::endl;
 
-  vByte_t v = std::move( m_fAcquireBuffer() );
+  const uint32_t idMeter( MeterFor( meterArp ) );
+  const size_t nOctets( ofp::FlowModSize<matchArp_t>( actionsOutput_t::size ) + MeterSize( idMeter ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
 
-  auto* pMod = ofp::Append<codec::ofp_flow_mod::ofp_flow_mod_>( v );
+  auto* pMod = build.Append<codec::ofp_flow_mod::ofp_flow_mod_>();
   pMod->init();
   pMod->cookie = 0x102;
   pMod->priority = 2048;
 
-  auto* pMatch = new ( &pMod->match ) codec::ofp_flow_mod::ofp_match_;
-
-  assert( 4 ==  sizeof( pMod->match.pad ) );
-  v.resize( v.size() - sizeof( pMod->match.pad ) );  // subtract the padding field in ofp_match
-  vByte_t::size_type sizeMatchesStart = v.size();
+  build.Seek( pMod->match.oxm_fields ); // the fields take the place of ofp_match.pad
 
-  auto* pMatchEthernetType = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>( v );
+  auto* pMatchEthernetType = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>();
   pMatchEthernetType->init( protocol::ethernet::Ethertype::arp );
 
-  auto* pMatchMetadata = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>( v );
+  auto* pMatchMetadata = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>();
   pMatchMetadata->init( 0 );
 
-  pMatch->length += v.size() - sizeMatchesStart;
-
-  v.resize( v.size() + pMatch->fill_size() );
-  pMatch->fill();
+  pMod->match.length = matchArp_t::length;
+  build.Pad( matchArp_t::size - matchArp_t::length );
 
-  vByte_t::size_type sizeActionsStart = v.size();
+  AppendMeter( build, idMeter );
 
-  auto* pActions = ofp::Append<codec::ofp_flow_mod::ofp_instruction_actions_>( v );
+  auto* pActions = build.Append<codec::ofp_flow_mod::ofp_instruction_actions_>();
   pActions->init();
 
-  auto* pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
+  auto* pAction = build.Append<codec::ofp_flow_mod::ofp_action_output_>();
   pAction->init(); // defaults to controller
   pAction->max_len = ofp141::ofp_controller_max_len::OFPCML_NO_BUFFER;
 
-  //pActions->len += sizeof( codec::ofp_flow_mod::ofp_action_output_ );
-  pActions->len = v.size() - sizeActionsStart;
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsOutput_t::size;
 
-  pMod->header.length = v.size();
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
 
-  m_fTransmitBuffer( std::move( v ) );
+  fTransmit( std::move( v ) );
 }
 
-void Bridge::InsertDhcpIntercept( uint16_t port ) {
+void Bridge::InsertDhcpIntercept( const fTransmitBuffer_t& fTransmit, uint16_t port ) {
 
   //std::cout << "InsertDhcpIntercept" << std::endl;
 
-  vByte_t v = std::move( m_fAcquireBuffer() );
+  const uint32_t idMeter( MeterFor( meterDhcp ) );
+  const size_t nOctets( ofp::FlowModSize<matchUdpPort_t>( actionsOutput_t::size ) + MeterSize( idMeter ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
 
-  auto* pMod = ofp::Append<codec::ofp_flow_mod::ofp_flow_mod_>( v );
+  auto* pMod = build.Append<codec::ofp_flow_mod::ofp_flow_mod_>();
   pMod->init();
   pMod->cookie = 0x103;
   pMod->priority = 2048;
 
-  auto* pMatch = new ( &pMod->match ) codec::ofp_flow_mod::ofp_match_;
+  build.Seek( pMod->match.oxm_fields ); // the fields take the place of ofp_match.pad
 
-  assert( 4 ==  sizeof( pMod->match.pad ) );
-  v.resize( v.size() - sizeof( pMod->match.pad ) );  // subtract the padding field in ofp_match
-  vByte_t::size_type sizeMatchesStart = v.size();
-
-  auto* pMatchEthernetType = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>( v );
+  auto* pMatchEthernetType = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>();
   pMatchEthernetType->init( protocol::ethernet::Ethertype::ipv4 );
 
-  auto* pMatchProtocol = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_ip_proto_>( v );
+  auto* pMatchProtocol = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_ip_proto_>();
   pMatchProtocol->init( 17 );
 
-  auto* pMatchPort = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_port_>( v );
+  auto* pMatchPort = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_port_>();
   pMatchPort->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_DST, port );
 
-  auto* pMatchMetadata = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>( v );
+  auto* pMatchMetadata = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>();
   pMatchMetadata->init( 0 );
 
-  pMatch->length += v.size() - sizeMatchesStart;
-
-  v.resize( v.size() + pMatch->fill_size() );
-  pMatch->fill();
+  pMod->match.length = matchUdpPort_t::length;
+  build.Pad( matchUdpPort_t::size - matchUdpPort_t::length );
 
-  vByte_t::size_type sizeActionsStart = v.size();
+  AppendMeter( build, idMeter );
 
-  auto* pActions = ofp::Append<codec::ofp_flow_mod::ofp_instruction_actions_>( v );
+  auto* pActions = build.Append<codec::ofp_flow_mod::ofp_instruction_actions_>();
   pActions->init();
 
-  auto* pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
+  auto* pAction = build.Append<codec::ofp_flow_mod::ofp_action_output_>();
   pAction->init(); // defaults to controller
   pAction->max_len = ofp141::ofp_controller_max_len::OFPCML_NO_BUFFER;
 
-  pActions->len = v.size() - sizeActionsStart;
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsOutput_t::size;
 
-  pMod->header.length = v.size();
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
 
-  m_fTransmitBuffer( std::move( v ) );
+  fTransmit( std::move( v ) );
 }
 
-void Bridge::InsertDnsIntercept( uint16_t ethertype, uint16_t field, uint8_t protocol ) {
+void Bridge::InsertDnsIntercept( const fTransmitBuffer_t& fTransmit, uint16_t ethertype, uint16_t field, uint8_t protocol ) {
 
   //std::cout << "InsertDnsIntercept" << std::endl;
 
-  vByte_t v = std::move( m_fAcquireBuffer() );
+  const uint32_t idMeter( MeterFor( meterDns ) );
+  const size_t nOctets( ofp::FlowModSize<matchUdpPort_t>( actionsOutput_t::size ) + MeterSize( idMeter ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
 
-  auto* pMod = ofp::Append<codec::ofp_flow_mod::ofp_flow_mod_>( v );
+  auto* pMod = build.Append<codec::ofp_flow_mod::ofp_flow_mod_>();
   pMod->init();
   pMod->cookie = 0x104;
   pMod->priority = 2048;
 
-  auto* pMatch = new ( &pMod->match ) codec::ofp_flow_mod::ofp_match_;
-
-  assert( 4 ==  sizeof( pMod->match.pad ) );
-  v.resize( v.size() - sizeof( pMod->match.pad ) );  // subtract the padding field in ofp_match
-  vByte_t::size_type sizeMatchesStart = v.size();
+  build.Seek( pMod->match.oxm_fields ); // the fields take the place of ofp_match.pad
 
-  auto* pMatchEthernetType = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>( v );
+  auto* pMatchEthernetType = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_eth_type_>();
   pMatchEthernetType->init( ethertype );
 
-  auto* pMatchProtocol = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_ip_proto_>( v );
+  auto* pMatchProtocol = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_ip_proto_>();
   pMatchProtocol->init( protocol );
 
-  auto* pMatchPort = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_port_>( v );
+  auto* pMatchPort = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_port_>();
   //pMatchPort->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_UDP_DST, 53 );
   pMatchPort->init( (ofp141::oxm_ofb_match_fields)field, 53 );
 
-  auto* pMatchMetadata = ofp::Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>( v );
+  auto* pMatchMetadata = build.Append<codec::ofp_flow_mod::ofpxmt_ofb_metadata_>();
   pMatchMetadata->init( 0 );
 
-  pMatch->length += v.size() - sizeMatchesStart;
+  pMod->match.length = matchUdpPort_t::length;
+  build.Pad( matchUdpPort_t::size - matchUdpPort_t::length );
 
-  v.resize( v.size() + pMatch->fill_size() );
-  pMatch->fill();
+  AppendMeter( build, idMeter );
 
-  vByte_t::size_type sizeActionsStart = v.size();
-
-  auto* pActions = ofp::Append<codec::ofp_flow_mod::ofp_instruction_actions_>( v );
+  auto* pActions = build.Append<codec::ofp_flow_mod::ofp_instruction_actions_>();
   pActions->init();
 
-  auto* pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
+  auto* pAction = build.Append<codec::ofp_flow_mod::ofp_action_output_>();
   pAction->init(); // defaults to controller
   pAction->max_len = ofp141::ofp_controller_max_len::OFPCML_NO_BUFFER;
 
-  pActions->len = v.size() - sizeActionsStart;
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsOutput_t::size;
+
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
+
+  fTransmit( std::move( v ) );
+}
+
+// untagged frames are taken by the port's access vlan, tagged frames by the vlans it trunks,
+//   a trunk of every vlan takes those the bridge knows of
+bool Bridge::HasIngress( const interface_t& interface, idVlan_t idVlan, bool bSrcAccess ) const {
+  if ( bSrcAccess ) return true;
+  switch ( interface.eVlanMode ) {
+    case VlanMode::trunk:
+    case VlanMode::native_tagged:
+      return interface.setTrunk.empty()
+        ? ( m_mapVlanToPort.end() != m_mapVlanToPort.find( idVlan ) )
+        : ( interface.setTrunk.end() != interface.setTrunk.find( idVlan ) );
+    default:
+      return false;
+  }
+}
+
+void Bridge::InsertIngress( const fTransmitBuffer_t& fTransmit, const interface_t& interface ) {
+  switch ( interface.eVlanMode ) {
+    case VlanMode::access:
+      InsertIngressFlow( fTransmit, interface.ofport, interface.tag, true );
+      break;
+    case VlanMode::native_tagged:
+      // the native vlan untagged, then the tagged vlans as on a trunk
+      InsertIngressFlow( fTransmit, interface.ofport, interface.tag, true );
+      // fall through
+    case VlanMode::trunk:
+      if ( interface.setTrunk.empty() ) {
+        for ( const auto& entry: m_mapVlanToPort ) InsertIngressFlow( fTransmit, interface.ofport, entry.first, false );
+      }
+      else {
+        for ( idVlan_t idVlan: interface.setTrunk ) InsertIngressFlow( fTransmit, interface.ofport, idVlan, false );
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+// table 0, a port's frames in one vlan:
+//   learn the source into table 1: vlan and eth_dst=eth_src, to output:in_port, popping the tag for an access port,
+//   untagged frames are then tagged, so table 1 and the flood groups see every frame tagged,
+//   and go on to table 1
+void Bridge::InsertIngressFlow( const fTransmitBuffer_t& fTransmit, ofport_t ofport, idVlan_t idVlan, bool bUntagged ) {
+
+  namespace nx = codec::nx_learn;
+
+  mapInterface_t::const_iterator iterInterface = m_mapInterface.find( ofport );
+  assert( m_mapInterface.end() != iterInterface );
+  const bool bPop( VlanMode::access == iterInterface->second.eVlanMode ); // as the learned port wants its frames
+
+  nx::learn_t learn;
+  learn.table_id = table_learned;
+  learn.priority = 1024;
+  learn.idle_timeout = learned_idle_timeout;
+  learn.cookie = 0x202;
+  learn.vSpec.push_back( nx::spec_t::MatchValue( nx::nxm_of_vlan_tci, idVlan, 12 ) );
+  learn.vSpec.push_back( nx::spec_t::Match( nx::nxm_of_eth_dst, nx::nxm_of_eth_src, 48 ) );
+  if ( bPop ) learn.vSpec.push_back( nx::spec_t::Load( nx::nxm_of_vlan_tci, 0, 16 ) );
+  learn.vSpec.push_back( nx::spec_t::Output( nx::nxm_of_in_port, 16 ) );
+
+  const size_t nActions( nx::Size( learn ) + ( bUntagged ? actionsPush_t::size : 0 ) );
+  const size_t nOctets( ofp::FlowModSize<matchIngress_t>( nActions ) + sizeof( fm::ofp_instructions_goto_table ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
+
+  auto* pMod = build.Append<fm::ofp_flow_mod_>();
+  pMod->init();
+  pMod->cookie = 0x105;
+  pMod->priority = 512; // under the intercepts and any learned pair flows
+
+  build.Seek( pMod->match.oxm_fields ); // the fields take the place of ofp_match.pad
 
-  pMod->header.length = v.size();
+  auto* pMatchInPort = build.Append<fm::ofpxmt_ofb_in_port_>();
+  pMatchInPort->init( ofport );
 
-  m_fTransmitBuffer( std::move( v ) );
+  auto* pMatchVlan = build.Append<fm::ofpxmt_ofb_vlan_vid_>();
+  if ( bUntagged ) pMatchVlan->init(); // OFPVID_NONE
+  else pMatchVlan->init( idVlan );
+
+  pMod->match.length = matchIngress_t::length;
+  build.Pad( matchIngress_t::size - matchIngress_t::length );
+
+  auto* pActions = build.Append<fm::ofp_instruction_actions_>();
+  pActions->init();
+
+  nx::Append( build, learn );
+
+  if ( bUntagged ) {
+    auto* pPush = build.Append<fm::ofp_action_push_vlan_>();
+    pPush->init( protocol::ethernet::Ethertype::ieee8021q );
+    auto* pSetVlan = build.Append<fm::ofp_action_set_field_vlan_id_>();
+    pSetVlan->init( idVlan );
+  }
+
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + nActions;
+
+  auto* pGoto = build.Append<fm::ofp_instructions_goto_table>();
+  pGoto->init( table_learned );
+
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
+
+  fTransmit( std::move( v ) );
 }
 
-void Bridge::BuildGroups() {
+// table 1, below the learned flows: a vlan's unknown and broadcast destinations go to its flood group,
+//   the one for tagged ingress, as the ingress flows have tagged every frame
+void Bridge::InsertFlood( const fTransmitBuffer_t& fTransmit, idVlan_t idVlan ) {
+
+  const size_t nOctets( ofp::FlowModSize<matchVlan_t>( actionsGroup_t::size ) );
+  vByte_t v = std::move( m_fAcquireBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
+
+  auto* pMod = build.Append<fm::ofp_flow_mod_>();
+  pMod->init();
+  pMod->table_id = table_learned;
+  pMod->cookie = 0x106;
+  pMod->priority = 1;
+
+  build.Seek( pMod->match.oxm_fields );
+
+  auto* pMatchVlan = build.Append<fm::ofpxmt_ofb_vlan_vid_>();
+  pMatchVlan->init( idVlan );
+
+  pMod->match.length = matchVlan_t::length;
+  build.Pad( matchVlan_t::size - matchVlan_t::length );
+
+  auto* pActions = build.Append<fm::ofp_instruction_actions_>();
+  pActions->init();
+
+  auto* pGroup = build.Append<ofp141::ofp_action_group>();
+  pGroup->type = ofp141::ofp_action_type::OFPAT_GROUP;
+  pGroup->len  = sizeof( ofp141::ofp_action_group );
+  pGroup->group_id = idVlan + 20000;
+
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsGroup_t::size;
+
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
+
+  fTransmit( std::move( v ) );
+}
+
+void Bridge::BuildGroups( const fTransmitBuffer_t& fTransmit ) {
+
+  typedef FlowTemplates::Egress op; // pass, push, pop
 
   struct BuildGroup {
-    enum op { pass, push, pop };
+    const FlowTemplates& templates;
     vByte_t v;
+    ofp::Builder build; // sized for the whole group_mod up front
     codec::ofp_group_mod::ofp_group_mod_* pMod;
-    BuildGroup( vByte_t v_ ): pMod( nullptr), v( std::move( v_ ) ) {}
+    BuildGroup( const FlowTemplates& templates_, vByte_t v_, size_t nOctets )
+    : templates( templates_ ), v( std::move( v_ ) ), build( v, nOctets ), pMod( nullptr ) {}
     void AddCommand( ofp141::ofp_group_mod_command cmd, Bridge::idGroup_t idGroup ) {
       //std::cout << "BuildGroup::AddCommand" << std::endl;
-      v.clear();
-      pMod = ofp::Append<codec::ofp_group_mod::ofp_group_mod_>( v );
+      pMod = build.Append<codec::ofp_group_mod::ofp_group_mod_>();
       pMod->init( cmd, idGroup );
       //std::cout << "BuildGroup::AddCommand: " << pMod->header.length << std::endl;
     }
     void AddOutput( op op_, Bridge::idVlan_t idVlan, Bridge::ofport_t ofport ) {
-
-      //std::cout << "BuildGroup::AddOutput" << std::endl;
-
-      size_t sizeStarting = v.size();
-
-      auto pBucket = ofp::Append<codec::ofp_group_mod::ofp_bucket_>( v );
-      pBucket->init();
-
-      switch ( op_ ) {
-        case op::pass:
-          // nothing to do
-          break;
-        case op::pop: {
-          auto pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_pop_vlan_>( v );
-          pAction->init();
-          }
-          break;
-        case op::push:
-          auto pActionPushVlan = ofp::Append<codec::ofp_flow_mod::ofp_action_push_vlan_>( v );
-          pActionPushVlan->init( 0x8100 );
-          auto pActionSetField = ofp::Append<codec::ofp_flow_mod::ofp_action_set_field_vlan_id_>( v );
-          pActionSetField->init( idVlan );
-          break;
-      }
-
-      auto pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
-      pAction->init( ofport );
-      pAction->max_len = 0;
-      //std::cout << "BuildGroup::pAction port " << pAction->port << std::endl;
-
-      pBucket->len = v.size() - sizeStarting;
-      pMod->header.length = v.size();
+      templates.Bucket( build, op_, idVlan, ofport );
+      pMod->header.length = build.Offset();
       //std::cout << "BuildGroup::AddOutput: " << pMod->header.length << std::endl;
     }
   };
@@ -679,8 +1116,14 @@ void Bridge::BuildGroups() {
       //std::cout << "** BuildGroup: vlan " << idVlan << " update " << std::endl;
 
       // build group for idVlan
-      BuildGroup groupAccess( std::move( m_fAcquireBuffer() ) ); // in_port is access, build outports
-      BuildGroup groupTrunk(  std::move( m_fAcquireBuffer() ) ); // in_port is trunk,  build outports
+      const size_t nAccess( v2p.setPortAccess.size() );
+      const size_t nTrunk( v2p.setPortTrunk.size() + m_setPortWithAllVlans.size() );
+      const size_t nGroupAccessOctets = ofp::GroupModSize( // access to access, access to trunk
+        nAccess * m_templates.BucketSize( op::pass ) + nTrunk * m_templates.BucketSize( op::push ) );
+      const size_t nGroupTrunkOctets = ofp::GroupModSize( // trunk to access, trunk to trunk
+        nAccess * m_templates.BucketSize( op::pop ) + nTrunk * m_templates.BucketSize( op::pass ) );
+      BuildGroup groupAccess( m_templates, std::move( m_fAcquireBuffer( nGroupAccessOctets ) ), nGroupAccessOctets ); // in_port is access, build outports
+      BuildGroup groupTrunk(  m_templates, std::move( m_fAcquireBuffer( nGroupTrunkOctets ) ), nGroupTrunkOctets ); // in_port is trunk,  build outports
 
       if ( v2p.bGroupAdded ) {
         //pMod->init( ofp141::ofp_group_mod_command::OFPGC_MODIFY, 10000 + idVlan );
@@ -696,37 +1139,37 @@ void Bridge::BuildGroups() {
       // add buckets for access
       if ( !v2p.setPortAccess.empty() ) {
         for ( auto ofport: v2p.setPortAccess ) {
-          groupAccess.AddOutput( BuildGroup::op::pass, idVlan, ofport ); // access to access
-          groupTrunk.AddOutput(  BuildGroup::op::pop,  idVlan, ofport );  // trunk to access
+          groupAccess.AddOutput( op::pass, idVlan, ofport ); // access to access
+          groupTrunk.AddOutput(  op::pop,  idVlan, ofport );  // trunk to access
         }
       }
 
       // add buckets for trunk
       if ( !v2p.setPortTrunk.empty() ) {
         for ( auto ofport: v2p.setPortTrunk ) {
-          groupAccess.AddOutput( BuildGroup::op::push, idVlan, ofport ); // access to trunk
-          groupTrunk.AddOutput(  BuildGroup::op::pass, idVlan, ofport ); // trunk to trunk
+          groupAccess.AddOutput( op::push, idVlan, ofport ); // access to trunk
+          groupTrunk.AddOutput(  op::pass, idVlan, ofport ); // trunk to trunk
         }
       }
 
       // add buckets for trunk-all
       if ( !m_setPortWithAllVlans.empty() ) {
         for ( auto ofport: m_setPortWithAllVlans ) {
-          groupAccess.AddOutput( BuildGroup::op::push, idVlan, ofport ); // access to trunk
-          groupTrunk.AddOutput(  BuildGroup::op::pass, idVlan, ofport ); // trunk to trunk
+          groupAccess.AddOutput( op::push, idVlan, ofport ); // access to trunk
+          groupTrunk.AddOutput(  op::pass, idVlan, ofport ); // trunk to trunk
         }
       }
 
       v2p.bGroupAdded = true;
       v2p.bGroupNeedsUpdate = false;
 
-      assert( 0 != groupAccess.v.size() );
-      assert( 0 != groupTrunk.v.size() );
+      assert( groupAccess.build.Complete() );
+      assert( groupTrunk.build.Complete() );
 
       //std::cout << "** BuildGroup: vlan " << idVlan << " queue access " << groupAccess.v.size() << std::endl;
-      m_fTransmitBuffer( std::move( groupAccess.v ) );
+      fTransmit( std::move( groupAccess.v ) );
       //std::cout << "** BuildGroup: vlan " << idVlan << " queue trunk " << groupTrunk.v.size() << std::endl;
-      m_fTransmitBuffer( std::move( groupTrunk.v ) );
+      fTransmit( std::move( groupTrunk.v ) );
     }
 
   }
@@ -737,7 +1180,9 @@ void Bridge::BuildGroups() {
 
       //std::cout << "** BuildGroup: trunk-all" << std::endl;
 
-      BuildGroup groupTrunkAll( std::move( m_fAcquireBuffer() ) ); // in_port is trunk-all, build outports
+      const size_t nGroupOctets = ofp::GroupModSize(
+        m_setPortWithAllVlans.size() * m_templates.BucketSize( op::pass ) );
+      BuildGroup groupTrunkAll( m_templates, std::move( m_fAcquireBuffer( nGroupOctets ) ), nGroupOctets ); // in_port is trunk-all, build outports
       if ( m_bGroupTrunkAllAdded ) {
         groupTrunkAll.AddCommand( ofp141::ofp_group_mod_command::OFPGC_MODIFY, 20000 );
       }
@@ -747,13 +1192,13 @@ void Bridge::BuildGroups() {
       }
       // build bucket for trunk-all ports
       for ( auto ofport: m_setPortWithAllVlans ) {
-        groupTrunkAll.AddOutput( BuildGroup::op::pass, 0, ofport ); // 0 vlan is ignored with pass
+        groupTrunkAll.AddOutput( op::pass, 0, ofport ); // 0 vlan is ignored with pass
       }
 
-      assert( 0 != groupTrunkAll.v.size() );
+      assert( groupTrunkAll.build.Complete() );
 
-      //std::cout << "** BuildGroup: m_fTransmitBuffer " << " queue trunk all " << groupTrunkAll.v.size() << std::endl;
-      m_fTransmitBuffer( std::move( groupTrunkAll.v ) );
+      //std::cout << "** BuildGroup: fTransmit " << " queue trunk all " << groupTrunkAll.v.size() << std::endl;
+      fTransmit( std::move( groupTrunkAll.v ) );
     }
   }
 
@@ -10,20 +10,28 @@
 #define BRIDGE_H
 
 #include <set>
+#include <atomic>
+#include <array>
+#include <iosfwd>
 #include <map>
 #include <mutex>
+#include <memory>
 #include <string>
 #include <functional>
 #include <unordered_map>
 
 #include "common.h"
+#include "openflow/openflow-spec1.4.1.h"
 #include "protocol/ethernet/address.h"
 
-// TODO: add io_context
-//   allows a strand to be added and used for syncing updates from ovsdb and requests from tcp_session
-//   which means that a pipeline of packet processing is required from tcp_session.
-//   will need to do this any way to deal with packets requiring long duration processing such as
-//      dns lookups, squid lookups, ....
+#include "flow_index.h"
+#include "flow_templates.h"
+#include "codecs/ofp_flow_removed.h"
+#include "codecs/ofp_multipart.h"
+
+// packet_in is processed in tcp_session's pipeline workers, so Update and Forward
+//   lock, as does the ovsdb thread's UpdateInterface
+// TODO: long duration processing such as dns lookups, squid lookups, ...., should be a stage of its own
 
 // TODO: in tcp_session decodes, confirm access port is not receiving trunk info
 
@@ -40,13 +48,90 @@ public:
   typedef std::set<idVlan_t> setVlan_t;
   typedef std::set<ofport_t> setPort_t;
 
-  typedef std::function<vByte_t(void)> fAcquireBuffer_t;
+  // packet_in payload, left in place in the session's receive buffer,
+  //   or held by the switch, in which case only the buffer_id goes back out
+  struct payload_t {
+    std::shared_ptr<const vByte_t> pHolder; // keeps the receive buffer alive, nullptr if it needs to be copied
+    const uint8_t* pBegin;
+    size_t nOctets;
+    uint32_t idBuffer; // switch side buffer, OFP_NO_BUFFER if the full frame was supplied
+    payload_t( std::shared_ptr<const vByte_t> pHolder_, const uint8_t* pBegin_, size_t nOctets_,
+               uint32_t idBuffer_ = OFP_NO_BUFFER )
+    : pHolder( std::move( pHolder_ ) ), pBegin( pBegin_ ), nOctets( nOctets_ ), idBuffer( idBuffer_ ) {}
+    bool Buffered() const { return OFP_NO_BUFFER != idBuffer; }
+    size_t CopyOctets() const { return ( Buffered() || pHolder ) ? 0 : nOctets; } // octets appended to the packet_out
+  };
+
+  typedef std::function<vByte_t(size_t)> fAcquireBuffer_t; // size hint in octets
   typedef std::function<void(vByte_t)> fTransmitBuffer_t;
+  typedef std::function<void(vByte_t,const payload_t&)> fTransmitWithPayload_t; // payload follows the buffer on the wire
+  // a message expecting a reply, fCompletion_t is called with true on the reply, false on an error or no reply in time,
+  //   possibly before fTransmitRequest_t returns
+  typedef std::function<void(bool bCompleted)> fCompletion_t;
+  typedef std::function<void(vByte_t,fCompletion_t)> fTransmitRequest_t;
+  // a message the switch answers only when it fails, as a flow_mod, fCompletion_t is called with false on an error,
+  //   true once the sender's window passes without one, possibly before fTransmitTracked_t returns
+  typedef std::function<void(vByte_t,fCompletion_t)> fTransmitTracked_t;
 
   enum OpState { unknOpState, up, down };
   enum MacStatus { StatusQuo, Multicast, Broadcast, Learned, Moved }; // add 'Flap' ?
   enum VlanMode { access, trunk, dot1q_tunnel, native_tagged, native_untagged };
 
+  // the first packet of a new unicast flow, sent along with the flow's flow_mod:
+  //   resubmit: barrier, then a packet_out to OFPP_TABLE, so the packet meets the new flow
+  //   direct:   a packet_out with the flow's own vlan and output actions, no barrier
+  enum FirstPacket { resubmit, direct };
+
+  // where unicast forwarding is learned:
+  //   controllerLearns: each new conversation comes up as packet_in, the bridge installs its learned pair flow
+  //   switchLearns: table 0 has an ingress flow per port and vlan, whose NXAST_LEARN writes
+  //     vlan and source mac to in_port into table 1, which forwards, or floods to the vlan's group on a miss;
+  //     packet_in is left to the intercepts and to ports or vlans without an ingress flow,
+  //     which are handed back to the tables once the bridge has seen them
+  enum LearnMode { controllerLearns, switchLearns };
+
+  // what Forward sends for new unicast flows, and what it does not send for packets of flows still pending
+  struct forward_stats_t {
+    uint64_t nFlows;
+    uint64_t nMessages;
+    uint64_t nOctets;
+    uint64_t nInstalled;  // barrier replied, no longer pending
+    uint64_t nFailed;     // barrier unanswered
+    uint64_t nPending;    // flows awaiting their barrier
+    uint64_t nSuppressed; // packets of a pending flow, sent without another flow_mod
+    uint64_t nSkipped;    // packets of an installed flow, which crossed its flow_mod, sent without another
+    uint64_t nStale;      // installed flows still sending packet_in, believed gone and installed again
+    uint64_t nAged;       // macs forgotten once the last flow from or to them idled out
+    uint64_t nLive;       // flows the switch holds, by flow_removed accounting
+    uint64_t nToTables;   // switchLearns, packet_in handed back to the learning tables
+    FlowIndex::stats_t index;
+    forward_stats_t()
+    : nFlows( 0 ), nMessages( 0 ), nOctets( 0 ),
+      nInstalled( 0 ), nFailed( 0 ), nPending( 0 ), nSuppressed( 0 ),
+      nSkipped( 0 ), nStale( 0 ), nAged( 0 ), nLive( 0 ), nToTables( 0 ) {}
+    double MessagesPerFlow() const { return ( 0 == nFlows ) ? 0.0 : (double)nMessages / nFlows; }
+    double OctetsPerFlow() const { return ( 0 == nFlows ) ? 0.0 : (double)nOctets / nFlows; }
+  };
+
+  // packet_in rate limits, a meter for each class of controller bound flow,
+  //   what exceeds its rate is dropped by the switch, so a storm in one class costs the others nothing
+  enum MeterClass { meterMiss, meterArp, meterDhcp, meterDns, nMeterClasses };
+  struct meter_rate_t {
+    uint32_t pps;   // 0 leaves the class unmetered
+    uint32_t burst; // packets
+  };
+  typedef std::array<meter_rate_t,nMeterClasses> meter_rates_t;
+
+  // from meter stats polls, per class
+  struct meter_stats_t {
+    uint32_t nFlows;     // flows using the meter
+    uint64_t nPackets;   // into the meter
+    uint64_t nShed;      // dropped by its band
+    uint64_t nPolls;
+    meter_stats_t(): nFlows( 0 ), nPackets( 0 ), nShed( 0 ), nPolls( 0 ) {}
+  };
+  typedef std::array<meter_stats_t,nMeterClasses> meter_stats_array_t;
+
   struct interface_t {
     idVlan_t tag; // port access vlan; TODO: test tag is not member of trunk
     setVlan_t setTrunk; // a set of vlan numbers
@@ -71,15 +156,29 @@ public:
   void UpdateState( ofport_t, OpState admin_state, OpState link_state );
 
   // from tcp_session on putting more smarts into bridge:
-  void StartRulesInjection( fAcquireBuffer_t, fTransmitBuffer_t );
+  void StartRulesInjection( fAcquireBuffer_t, fTransmitBuffer_t, fTransmitWithPayload_t, fTransmitRequest_t, fTransmitTracked_t );
 
   // currently from tcp_session wondering how to forward packets
   MacStatus Update( nPort_t nPort, idVlan_t idVlan, const MacAddress& macSource );
   void Forward( ofport_t ofp_ingress, idVlan_t vlan,
                 const MacAddress& macSrc, const MacAddress& macDst,
-                uint8_t* pPacket, size_t nOctets
+                const payload_t& payload
                 );
 
+  // a learned pair flow idled out or was deleted, false when the flow is not one of those
+  bool FlowRemoved( const codec::ofp_flow_removed::removed_t& );
+
+  void SetFirstPacket( FirstPacket );
+  void SetLearnMode( LearnMode ); // before StartRulesInjection
+  void SetUseBundles( bool ); // before StartRulesInjection, cleared when the switch refuses a bundle
+  forward_stats_t ForwardStats();
+
+  static meter_rates_t DefaultMeterRates();
+  void SetMeterRates( const meter_rates_t& ); // takes effect at the next StartRulesInjection
+  uint32_t Meter( MeterClass ); // the meter id for flows of the class, 0 when unmetered
+  void UpdateMeter( const codec::ofp_multipart::meter_t& ); // an OFPMP_METER record
+  meter_stats_array_t MeterStats();
+
 private:
 
   struct MacInfo {
@@ -119,13 +218,88 @@ private:
 
   fAcquireBuffer_t m_fAcquireBuffer;
   fTransmitBuffer_t m_fTransmitBuffer;
+  fTransmitWithPayload_t m_fTransmitWithPayload;
+  fTransmitRequest_t m_fTransmitRequest;
+  fTransmitTracked_t m_fTransmitTracked;
 
-  void BuildGroups();
-  void InsertArpIntercept();
-  void InsertDhcpIntercept( uint16_t port );
-  void InsertDnsIntercept( uint16_t ethertype, uint16_t match, uint8_t protocol );
+  FirstPacket m_eFirstPacket;
+  LearnMode m_eLearnMode;
+  forward_stats_t m_statsForward;
+
+  // a unicast conversation, from its flow_mod being sent until the barrier behind it is answered
+  struct flow_key_t {
+    ofport_t ofportIn;
+    idVlan_t idVlan;
+    uint16_t vidMatch; // the flow's vlan_vid match, follows from ofportIn
+    MacAddress macSrc;
+    MacAddress macDst;
+    flow_key_t( ofport_t ofportIn_, idVlan_t idVlan_, bool bSrcAccess, const MacAddress& macSrc_, const MacAddress& macDst_ )
+    : ofportIn( ofportIn_ ), idVlan( idVlan_ ),
+      vidMatch( bSrcAccess ? (uint16_t)ofp141::ofp_vlan_id::OFPVID_NONE : (uint16_t)( idVlan_ | ofp141::ofp_vlan_id::OFPVID_PRESENT ) ),
+      macSrc( macSrc_ ), macDst( macDst_ ) {}
+    bool operator==( const flow_key_t& rhs ) const {
+      return ( ofportIn == rhs.ofportIn ) && ( idVlan == rhs.idVlan ) && ( macSrc == rhs.macSrc ) && ( macDst == rhs.macDst );
+    }
+  };
+  struct flow_key_hash_t {
+    size_t operator()( const flow_key_t& key ) const {
+      return
+          std::hash<MacAddress>{}( key.macSrc ) ^ ( std::hash<MacAddress>{}( key.macDst ) << 1 )
+        ^ ( key.ofportIn << 16 ) ^ key.idVlan;
+    }
+  };
+  typedef std::unordered_map<flow_key_t,size_t,flow_key_hash_t> mapPending_t; // packets seen while pending
+  mapPending_t m_mapPending;
+  std::mutex m_mutexPending; // completions arrive without m_mutex, taken after m_mutex when both are held
+
+  bool BeginPending( const flow_key_t& ); // false when already pending
+  void EndPending( const flow_key_t&, bool bCompleted );
+
+  // learned pair flows the switch holds, from barrier reply to flow_removed, also under m_mutexPending
+  enum { crossing_window_ms = 1000 }; // a packet_in this soon after the install crossed the flow_mod
+  FlowIndex m_flows;
+  typedef std::unordered_map<MacAddress,size_t> mapMacFlows_t; // live flows from or to each mac
+  mapMacFlows_t m_mapMacFlows;
+
+  FlowIndex::key_t LiveKey( const flow_key_t& ) const;
+  bool Installed( const flow_key_t& ); // false, with the flow dropped from the index, once it is stale
+  bool ReleaseMacFlows( const MacAddress& ); // true when the mac's last live flow is gone
+  void AgeMac( const MacAddress&, const nPort_t* pPort ); // unless it has since moved from *pPort
+
+  size_t TransmitPacketOut( vByte_t, const payload_t& ); // header and actions already in the buffer, returns octets sent
+  size_t TransmitDirect( ofport_t ofp_ingress, FlowTemplates::Shape, idVlan_t, ofport_t ofportDst, const payload_t& );
+  size_t TransmitResubmit( ofport_t ofp_ingress, const payload_t& ); // to OFPP_TABLE, past the intercepts
+  void TransmitBarrier( const flow_key_t& );
+
+  const FlowTemplates m_templates; // learned pair flow_mods, direct packet_outs, group buckets
+
+  meter_rates_t m_rateMeter;
+  meter_stats_array_t m_statsMeter;
+  static uint32_t MeterId( MeterClass eClass ) { return eClass + 1; } // meter ids start at 1
+  uint32_t MeterFor( MeterClass eClass ) const { return ( 0 == m_rateMeter[ eClass ].pps ) ? 0 : MeterId( eClass ); }
+  void InsertMeters();
+  static size_t MeterSize( uint32_t idMeter ); // octets of the instruction, 0 without a meter
+  static void AppendMeter( ofp::Builder&, uint32_t idMeter );
+
+  std::atomic<bool> m_bUseBundles; // group and flow programming is committed to the switch as a bundle
+  void Program( std::function<void(const fTransmitBuffer_t&)> ); // the function transmits the batch
+
+  void BuildGroups( const fTransmitBuffer_t& );
+  void InsertArpIntercept( const fTransmitBuffer_t& );
+  void InsertDhcpIntercept( const fTransmitBuffer_t&, uint16_t port );
+  void InsertDnsIntercept( const fTransmitBuffer_t&, uint16_t ethertype, uint16_t match, uint8_t protocol );
+
+  // switchLearns
+  enum { table_learned = 1, learned_idle_timeout = 300 };
+  bool HasIngress( const interface_t&, idVlan_t, bool bSrcAccess ) const; // an ingress flow takes the frame
+  void InsertIngress( const fTransmitBuffer_t&, const interface_t& );
+  void InsertIngressFlow( const fTransmitBuffer_t&, ofport_t, idVlan_t, bool bUntagged );
+  void InsertFlood( const fTransmitBuffer_t&, idVlan_t );
 
 };
 
+std::ostream& operator<<( std::ostream&, const Bridge::forward_stats_t& );
+std::ostream& operator<<( std::ostream&, const Bridge::meter_stats_t& );
+
 #endif /* BRIDGE_H */
 
@@ -9,6 +9,9 @@
 #ifndef OFP_APPEND_H
 #define OFP_APPEND_H
 
+#include <new>
+#include <cstring>
+
 namespace ofp {
 
   template<typename T>
@@ -17,6 +20,7 @@ namespace ofp {
     size_t placeholder( v.size() );
     size_t new_size = placeholder + increment;
     v.resize( new_size );
+    std::memset( v.data() + placeholder, 0, increment ); // vByte_t leaves new octets uninitialized
     T* p = new( v.data() + placeholder ) T;
     return p;
   }
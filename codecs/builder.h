@@ -0,0 +1,121 @@
+/*
+ * File:   builder.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 12:20 AM
+ */
+
+#ifndef OFP_BUILDER_H
+#define OFP_BUILDER_H
+
+#include <new>
+#include <cassert>
+#include <cstring>
+#include <initializer_list>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+#include "../common.h"
+
+// messages laid out from their structure types:
+//   the octets of a flow_mod, packet_out or group_mod are summed at compile time from
+//   the structures going into it, the buffer is sized once, then each structure is placed
+//   where it belongs, rather than ofp::Append growing the buffer a structure at a time.
+// action lists chosen at run time are sized by picking among the compile time sums.
+
+namespace ofp {
+
+  // octets of a list of structures
+  template<typename... T>
+  constexpr size_t SizeOf() {
+    size_t nOctets( 0 );
+    for ( size_t n: { size_t( 0 ), sizeof( T )... } ) nOctets += n;
+    return nOctets;
+  }
+
+  constexpr size_t Pad8( size_t nOctets ) { return ( nOctets + 7 ) & ~size_t( 7 ); }
+
+  // an ofp_match of OXM fields, pg 63 v1.4.1 s7.2.2
+  template<typename... Oxm>
+  struct Match {
+    static constexpr size_t length = sizeof( ofp141::ofp_match ) - sizeof( ofp141::ofp_match::pad ) + SizeOf<Oxm...>(); // as in ofp_match.length
+    static constexpr size_t size = Pad8( length );
+  };
+
+  // actions, or the structures of any list
+  template<typename... Action>
+  struct Actions {
+    static constexpr size_t size = SizeOf<Action...>();
+  };
+
+  // with a single instruction holding nActions octets of actions
+  template<typename Match_>
+  constexpr size_t FlowModSize( size_t nActions ) {
+    return sizeof( ofp141::ofp_flow_mod ) - sizeof( ofp141::ofp_match ) + Match_::size
+      + sizeof( ofp141::ofp_instruction_actions ) + nActions;
+  }
+
+  constexpr size_t PacketOutSize( size_t nActions ) { // before any payload
+    return sizeof( ofp141::ofp_packet_out ) + nActions;
+  }
+
+  constexpr size_t BucketSize( size_t nActions ) {
+    return sizeof( ofp141::ofp_bucket ) + nActions;
+  }
+
+  constexpr size_t GroupModSize( size_t nBuckets ) { // octets of all the buckets
+    return sizeof( ofp141::ofp_group_mod ) + nBuckets;
+  }
+
+  // the buffer is sized once, without zero filling, structures are then placed one after the other:
+  //   each placed structure's init(), or its caller, writes all of its octets, Pad() zeroes the rest
+  class Builder {
+  public:
+
+    Builder( vByte_t& v, size_t nOctets ): m_v( v ), m_ix( 0 ) {
+      m_v.resize( nOctets );
+    }
+
+    template<typename T>
+    T* Append() {
+      assert( ( m_ix + sizeof( T ) ) <= m_v.size() );
+      T* p = new( m_v.data() + m_ix ) T;
+      m_ix += sizeof( T );
+      return p;
+    }
+
+    // octets encoded beforehand, as by a template, returns where they were placed
+    uint8_t* Copy( const vByte_t& v ) {
+      assert( ( m_ix + v.size() ) <= m_v.size() );
+      uint8_t* p = m_v.data() + m_ix;
+      std::memcpy( p, v.data(), v.size() );
+      m_ix += v.size();
+      return p;
+    }
+
+    // zeroes, as for the padding after an ofp_match
+    void Pad( size_t nOctets ) {
+      assert( ( m_ix + nOctets ) <= m_v.size() );
+      std::memset( m_v.data() + m_ix, 0, nOctets );
+      m_ix += nOctets;
+    }
+
+    // continue from within what has been placed, as with the oxm fields overlaying ofp_match.pad
+    void Seek( const void* p ) {
+      const size_t ix = reinterpret_cast<const uint8_t*>( p ) - m_v.data();
+      assert( ix <= m_ix );
+      m_ix = ix;
+    }
+
+    size_t Offset() const { return m_ix; }
+    bool Complete() const { return m_v.size() == m_ix; } // the precomputed size was used exactly
+
+  private:
+    vByte_t& m_v;
+    size_t m_ix;
+  };
+
+} // namespace ofp
+
+#endif /* OFP_BUILDER_H */
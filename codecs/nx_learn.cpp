@@ -0,0 +1,248 @@
+/*
+ * File:   nx_learn.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 7:05 AM
+ */
+
+#include <ostream>
+
+#include "builder.h"
+#include "nx_learn.h"
+
+namespace {
+
+  // flow_mod_spec header, nicira-ext.h
+  const uint16_t nx_learn_src_immediate = 1 << 13; // NX_LEARN_SRC_FIELD is 0
+  const uint16_t nx_learn_dst_load      = 1 << 11; // NX_LEARN_DST_MATCH is 0
+  const uint16_t nx_learn_dst_output    = 2 << 11;
+  const uint16_t nx_learn_dst_mask      = 3 << 11;
+  const uint16_t nx_learn_n_bits_mask   = 0x3ff;
+
+  const size_t nFieldRef = sizeof( uint32_t ) + sizeof( uint16_t ); // nxm header and offset
+
+  // immediates take whole 16 bit words, right aligned
+  size_t ImmediateSize( uint16_t nBits ) { return 2 * ( ( nBits + 15 ) / 16 ); }
+
+  void PutField( uint8_t* p, uint32_t header, uint16_t ofs ) {
+    auto* pHeader = reinterpret_cast<boost::endian::big_uint32_t*>( p );
+    *pHeader = header;
+    auto* pOfs = reinterpret_cast<boost::endian::big_uint16_t*>( p + sizeof( uint32_t ) );
+    *pOfs = ofs;
+  }
+
+  const uint8_t* GetField( const uint8_t* p, uint32_t& header, uint16_t& ofs ) {
+    header = *reinterpret_cast<const boost::endian::big_uint32_t*>( p );
+    ofs = *reinterpret_cast<const boost::endian::big_uint16_t*>( p + sizeof( uint32_t ) );
+    return p + nFieldRef;
+  }
+
+} // namespace anon
+
+namespace codec {
+namespace nx_learn {
+
+spec_t spec_t::Match( uint32_t dst, uint32_t src, uint16_t nBits, uint16_t ofs ) {
+  spec_t spec;
+  spec.eSrc = field;
+  spec.eDst = match;
+  spec.nBits = nBits;
+  spec.srcField = src;
+  spec.srcOfs = ofs;
+  spec.dstField = dst;
+  spec.dstOfs = ofs;
+  return spec;
+}
+
+spec_t spec_t::MatchValue( uint32_t dst, uint64_t value, uint16_t nBits, uint16_t ofs ) {
+  spec_t spec;
+  spec.eSrc = immediate;
+  spec.eDst = match;
+  spec.nBits = nBits;
+  spec.value = value;
+  spec.dstField = dst;
+  spec.dstOfs = ofs;
+  return spec;
+}
+
+spec_t spec_t::Load( uint32_t dst, uint64_t value, uint16_t nBits, uint16_t ofs ) {
+  spec_t spec( MatchValue( dst, value, nBits, ofs ) );
+  spec.eDst = load;
+  return spec;
+}
+
+spec_t spec_t::Output( uint32_t src, uint16_t nBits ) {
+  spec_t spec;
+  spec.eSrc = field;
+  spec.eDst = output;
+  spec.nBits = nBits;
+  spec.srcField = src;
+  return spec;
+}
+
+size_t spec_t::Size() const {
+  return sizeof( uint16_t )
+    + ( ( field == eSrc ) ? nFieldRef : ImmediateSize( nBits ) )
+    + ( ( output == eDst ) ? 0 : nFieldRef );
+}
+
+size_t Size( const learn_t& learn ) {
+  size_t nOctets( sizeof( nx_action_learn_ ) );
+  for ( const spec_t& spec: learn.vSpec ) nOctets += spec.Size();
+  return ofp::Pad8( nOctets );
+}
+
+void Append( ofp::Builder& build, const learn_t& learn ) {
+
+  const size_t nOctets( Size( learn ) );
+
+  auto* pLearn = build.Append<nx_action_learn_>();
+  pLearn->type = ofp141::ofp_action_type::OFPAT_EXPERIMENTER;
+  pLearn->len = nOctets;
+  pLearn->vendor = nx_vendor_id;
+  pLearn->subtype = nxast_learn;
+  pLearn->idle_timeout = learn.idle_timeout;
+  pLearn->hard_timeout = learn.hard_timeout;
+  pLearn->priority = learn.priority;
+  pLearn->cookie = learn.cookie;
+  pLearn->flags = learn.flags;
+  pLearn->table_id = learn.table_id;
+  pLearn->pad = 0;
+  pLearn->fin_idle_timeout = 0;
+  pLearn->fin_hard_timeout = 0;
+
+  size_t nSpecs( 0 );
+  for ( const spec_t& spec: learn.vSpec ) {
+    assert( nx_learn_n_bits_mask >= spec.nBits );
+    const size_t nSpec( spec.Size() );
+    nSpecs += nSpec;
+    build.Pad( nSpec ); // the immediate's leading octets stay zero
+    uint8_t* p = reinterpret_cast<uint8_t*>( pLearn ) + sizeof( nx_action_learn_ ) + nSpecs - nSpec;
+
+    uint16_t header( spec.nBits );
+    if ( spec_t::immediate == spec.eSrc ) header |= nx_learn_src_immediate;
+    if ( spec_t::load == spec.eDst ) header |= nx_learn_dst_load;
+    if ( spec_t::output == spec.eDst ) header |= nx_learn_dst_output;
+    *reinterpret_cast<boost::endian::big_uint16_t*>( p ) = header;
+    p += sizeof( uint16_t );
+
+    if ( spec_t::field == spec.eSrc ) {
+      PutField( p, spec.srcField, spec.srcOfs );
+      p += nFieldRef;
+    }
+    else {
+      const size_t nImmediate( ImmediateSize( spec.nBits ) );
+      uint64_t value( spec.value );
+      for ( size_t ix = nImmediate; ( 0 < ix ) && ( 0 != value ); ix-- ) {
+        p[ ix - 1 ] = value & 0xff;
+        value >>= 8;
+      }
+      p += nImmediate;
+    }
+
+    if ( spec_t::output != spec.eDst ) {
+      PutField( p, spec.dstField, spec.dstOfs );
+    }
+  }
+
+  build.Pad( nOctets - sizeof( nx_action_learn_ ) - nSpecs ); // a zero header ends the specs
+}
+
+bool Decode( const ofp141::ofp_action_experimenter_header& action, learn_t& learn ) {
+
+  if ( ofp141::ofp_action_type::OFPAT_EXPERIMENTER != action.type ) return false;
+  if ( nx_vendor_id != action.experimenter ) return false;
+  if ( sizeof( nx_action_learn_ ) > action.len ) return false;
+
+  const auto& nx( reinterpret_cast<const nx_action_learn_&>( action ) );
+  if ( nxast_learn != nx.subtype ) return false;
+
+  learn.table_id = nx.table_id;
+  learn.priority = nx.priority;
+  learn.idle_timeout = nx.idle_timeout;
+  learn.hard_timeout = nx.hard_timeout;
+  learn.flags = nx.flags;
+  learn.cookie = nx.cookie;
+  learn.vSpec.clear();
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>( &nx ) + sizeof( nx_action_learn_ );
+  const uint8_t* pEnd = reinterpret_cast<const uint8_t*>( &nx ) + action.len;
+
+  while ( ( p + sizeof( uint16_t ) ) <= pEnd ) {
+    const uint16_t header = *reinterpret_cast<const boost::endian::big_uint16_t*>( p );
+    if ( 0 == header ) break; // padding
+    p += sizeof( uint16_t );
+
+    spec_t spec;
+    spec.nBits = header & nx_learn_n_bits_mask;
+    spec.eSrc = ( 0 != ( header & nx_learn_src_immediate ) ) ? spec_t::immediate : spec_t::field;
+    switch ( header & nx_learn_dst_mask ) {
+      case 0:                  spec.eDst = spec_t::match; break;
+      case nx_learn_dst_load:   spec.eDst = spec_t::load; break;
+      case nx_learn_dst_output: spec.eDst = spec_t::output; break;
+      default: return false;
+    }
+
+    if ( ( p + spec.Size() - sizeof( uint16_t ) ) > pEnd ) return false;
+
+    if ( spec_t::field == spec.eSrc ) {
+      p = GetField( p, spec.srcField, spec.srcOfs );
+    }
+    else {
+      const size_t nImmediate( ImmediateSize( spec.nBits ) );
+      for ( size_t ix = 0; ix < nImmediate; ix++ ) spec.value = ( spec.value << 8 ) | p[ ix ];
+      p += nImmediate;
+    }
+
+    if ( spec_t::output != spec.eDst ) {
+      p = GetField( p, spec.dstField, spec.dstOfs );
+    }
+
+    learn.vSpec.push_back( spec );
+  }
+
+  return true;
+}
+
+} // namespace nx_learn
+} // namespace codec
+
+// in the ovs-ofctl manner: learn(table=1,idle_timeout=300,priority=1024,cookie=0x202,0x00000206[0..47]=0x00000406[0..47],...)
+std::ostream& operator<<( std::ostream& os, const codec::nx_learn::learn_t& learn ) {
+  typedef codec::nx_learn::spec_t spec_t;
+  auto field = [&os]( uint32_t header, uint16_t ofs, uint16_t nBits ){
+    os << "0x" << std::hex << header << std::dec << "[" << ofs << ".." << ( ofs + nBits - 1 ) << "]";
+  };
+  os
+    << "learn(table=" << (uint16_t)learn.table_id
+    << ",idle_timeout=" << learn.idle_timeout
+    << ",hard_timeout=" << learn.hard_timeout
+    << ",priority=" << learn.priority
+    << ",cookie=0x" << std::hex << learn.cookie << std::dec
+    << ",flags=" << learn.flags
+    ;
+  for ( const spec_t& spec: learn.vSpec ) {
+    os << ",";
+    switch ( spec.eDst ) {
+      case spec_t::match:
+        field( spec.dstField, spec.dstOfs, spec.nBits );
+        os << "=";
+        break;
+      case spec_t::load:
+        os << "load:";
+        break;
+      case spec_t::output:
+        os << "output:";
+        break;
+    }
+    if ( spec_t::field == spec.eSrc ) field( spec.srcField, spec.srcOfs, spec.nBits );
+    else os << "0x" << std::hex << spec.value << std::dec;
+    if ( spec_t::load == spec.eDst ) {
+      os << "->";
+      field( spec.dstField, spec.dstOfs, spec.nBits );
+    }
+  }
+  os << ")";
+  return os;
+}
@@ -0,0 +1,115 @@
+/*
+ * File:   nx_learn.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 7:05 AM
+ */
+
+#ifndef NX_LEARN_H
+#define NX_LEARN_H
+
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+namespace ofp {
+  class Builder;
+}
+
+// the Nicira learn action, NXAST_LEARN, as an OFPAT_EXPERIMENTER action,
+//   layout from openvswitch include/openflow/nicira-ext.h ( pointers in notes.txt ):
+//   executing it adds or modifies a flow in another table, built from the packet at hand,
+//   so the switch learns without a packet_in.
+// the new flow is described by flow_mod_specs following the fixed part:
+//   a 16 bit header ( source, destination, bit count ), then the source, a field or an immediate value,
+//   then the destination, a field to match or to load, or nothing for an output.
+// fields are named by NXM headers, 32 bits: class, field, hasmask, length ( OXM uses the same encoding ).
+
+namespace codec {
+namespace nx_learn {
+
+  enum { nx_vendor_id = 0x00002320, nxast_learn = 16 };
+
+  constexpr uint32_t NxmHeader( uint16_t class_, uint8_t field, uint8_t length ) {
+    return ( uint32_t( class_ ) << 16 ) | ( uint32_t( field ) << 9 ) | length;
+  }
+  constexpr uint8_t NxmLength( uint32_t header ) { return header & 0xff; } // octets
+
+  // NXM_OF_* fields, class 0x0000, ovs-fields(7)
+  const uint32_t nxm_of_in_port  = NxmHeader( 0x0000, 0, 2 );
+  const uint32_t nxm_of_eth_dst  = NxmHeader( 0x0000, 1, 6 );
+  const uint32_t nxm_of_eth_src  = NxmHeader( 0x0000, 2, 6 );
+  const uint32_t nxm_of_vlan_tci = NxmHeader( 0x0000, 4, 2 ); // vid in bits 0..11, 0x1000 set when tagged, loading 0 pops the tag
+
+  enum flags { send_flow_rem = 1, delete_learned = 2 }; // NX_LEARN_F_*
+
+  struct nx_action_learn_ {
+    boost::endian::big_uint16_t type;     // OFPAT_EXPERIMENTER
+    boost::endian::big_uint16_t len;      // with the specs, padded to a multiple of 8
+    boost::endian::big_uint32_t vendor;   // nx_vendor_id
+    boost::endian::big_uint16_t subtype;  // nxast_learn
+    boost::endian::big_uint16_t idle_timeout;
+    boost::endian::big_uint16_t hard_timeout;
+    boost::endian::big_uint16_t priority;
+    boost::endian::big_uint64_t cookie;
+    boost::endian::big_uint16_t flags;
+    boost::endian::big_uint8_t table_id;
+    boost::endian::big_uint8_t pad;
+    boost::endian::big_uint16_t fin_idle_timeout;
+    boost::endian::big_uint16_t fin_hard_timeout;
+    // flow_mod_specs follow
+  };
+
+  struct spec_t {
+    enum Src { field, immediate };
+    enum Dst { match, load, output };
+    Src eSrc;
+    Dst eDst;
+    uint16_t nBits;    // 11 bits on the wire, immediates are limited to 64 here
+    uint32_t srcField; // eSrc field
+    uint16_t srcOfs;
+    uint64_t value;    // eSrc immediate
+    uint32_t dstField; // eDst match or load
+    uint16_t dstOfs;
+
+    spec_t()
+    : eSrc( field ), eDst( match ), nBits( 0 ), srcField( 0 ), srcOfs( 0 ), value( 0 ), dstField( 0 ), dstOfs( 0 ) {}
+
+    // the learned flow matches dst[ofs..] against the packet's src[ofs..], as NXM_OF_ETH_DST[]=NXM_OF_ETH_SRC[]
+    static spec_t Match( uint32_t dst, uint32_t src, uint16_t nBits, uint16_t ofs = 0 );
+    // the learned flow matches dst[ofs..] against a constant
+    static spec_t MatchValue( uint32_t dst, uint64_t value, uint16_t nBits, uint16_t ofs = 0 );
+    // the learned flow loads a constant into dst[ofs..]
+    static spec_t Load( uint32_t dst, uint64_t value, uint16_t nBits, uint16_t ofs = 0 );
+    // the learned flow outputs to the port the packet's src holds, as output:NXM_OF_IN_PORT[]
+    static spec_t Output( uint32_t src, uint16_t nBits );
+
+    size_t Size() const; // octets on the wire
+  };
+
+  struct learn_t {
+    uint8_t table_id;
+    uint16_t priority;
+    uint16_t idle_timeout;
+    uint16_t hard_timeout;
+    uint16_t flags;
+    uint64_t cookie;
+    std::vector<spec_t> vSpec;
+    learn_t(): table_id( 0 ), priority( 0 ), idle_timeout( 0 ), hard_timeout( 0 ), flags( 0 ), cookie( 0 ) {}
+  };
+
+  size_t Size( const learn_t& ); // the whole action, padded
+  void Append( ofp::Builder&, const learn_t& );
+
+  // false when the action is not an NXAST_LEARN, or its specs overrun it
+  bool Decode( const ofp141::ofp_action_experimenter_header&, learn_t& );
+
+} // namespace nx_learn
+} // namespace codec
+
+std::ostream& operator<<( std::ostream&, const codec::nx_learn::learn_t& );
+
+#endif /* NX_LEARN_H */
@@ -10,6 +10,8 @@
 #include <string>
 #include <iostream>
 
+#include "builder.h"
+#include "ofp_header.h"
 #include "ofp_async_config.h"
 
 namespace codec {
@@ -84,4 +86,43 @@ void ofp_async_config::Decode( const ofp141::ofp_async_config_prop_header& prope
   }
 }
 
-} // namespace codec
\ No newline at end of file
+vByte_t ofp_async_config::CreateSet( vByte_t v, const policy_t& policy ) {
+  const size_t nOctets( SetSize() );
+  v.clear();
+  ofp::Builder build( v, nOctets );
+
+  auto* pHeader = build.Append<ofp_header::ofp_header_>();
+  pHeader->init();
+  pHeader->type = ofp141::ofp_type::OFPT_SET_ASYNC;
+  pHeader->length = nOctets;
+  ofp_header::NewXid( *pHeader );
+
+  for ( size_t ix = 0; ix < policy_t::nTypes; ix++ ) {
+    auto* pReasons = build.Append<ofp141::ofp_async_config_prop_reasons>();
+    pReasons->type = ix;
+    pReasons->length = sizeof( ofp141::ofp_async_config_prop_reasons );
+    pReasons->mask = policy.rMask[ ix ];
+  }
+
+  assert( build.Complete() );
+  return v;
+}
+
+bool ofp_async_config::Decode( const ofp141::ofp_async_config& msg, const uint8_t* pEnd, policy_t& policy ) {
+  const uint8_t* p = reinterpret_cast<const uint8_t*>( msg.properties );
+  const uint8_t* pLimit = reinterpret_cast<const uint8_t*>( &msg ) + msg.header.length;
+  if ( pLimit > pEnd ) return false;
+  while ( ( p + sizeof( ofp141::ofp_async_config_prop_header ) ) <= pLimit ) {
+    const auto* pProperty = reinterpret_cast<const ofp141::ofp_async_config_prop_header*>( p );
+    if ( ( sizeof( ofp141::ofp_async_config_prop_header ) > pProperty->length ) || ( ( p + pProperty->length ) > pLimit ) ) {
+      return false;
+    }
+    if ( ( policy_t::nTypes > pProperty->type ) && ( sizeof( ofp141::ofp_async_config_prop_reasons ) <= pProperty->length ) ) {
+      policy.rMask[ pProperty->type ] = reinterpret_cast<const ofp141::ofp_async_config_prop_reasons*>( p )->mask;
+    }
+    p += pProperty->length;
+  }
+  return true;
+}
+
+} // namespace codec
@@ -9,6 +9,8 @@
 #ifndef OFP_ASCYNC_CONFIG_H
 #define OFP_ASCYNC_CONFIG_H
 
+#include <array>
+#include <cstdint>
 #include <functional>
 
 #include "../openflow/openflow-spec1.4.1.h"
@@ -22,8 +24,32 @@ namespace codec {
 class ofp_async_config {
   const ofp141::ofp_async_config& m_packet;
 public:
-  ofp_async_config( const ofp141::ofp_async_config& );
+
+  // the reasons each asynchronous message is sent for, a mask per OFPACPT_* reasons property,
+  //   bit n of a mask lets the message through for reason n (OFPR_*, OFPPR_*, OFPRR_*, ...)
+  struct policy_t {
+    enum { nTypes = ofp141::ofp_async_config_prop_type::OFPACPT_REQUESTFORWARD_MASTER + 1 };
+    std::array<uint32_t,nTypes> rMask;
+    policy_t() { rMask.fill( 0 ); } // nothing is sent
+    static policy_t All() { policy_t policy; policy.rMask.fill( ~uint32_t( 0 ) ); return policy; }
+    policy_t& Set( ofp141::ofp_async_config_prop_type type, uint32_t mask ) { rMask[ type ] = mask; return *this; }
+    uint32_t Mask( ofp141::ofp_async_config_prop_type type ) const { return rMask[ type ]; }
+    bool Sends( ofp141::ofp_async_config_prop_type type, uint8_t reason ) const {
+      return ( 32 > reason ) && ( 0 != ( rMask[ type ] & ( uint32_t( 1 ) << reason ) ) );
+    }
+    bool operator==( const policy_t& rhs ) const { return rMask == rhs.rMask; }
+  };
+
+  ofp_async_config( const ofp141::ofp_async_config& ); // prints the masks
   virtual ~ofp_async_config( );
+
+  // OFPT_SET_ASYNC with a reasons property for each type, the switch does not reply unless in error
+  static size_t SetSize() { return sizeof( ofp141::ofp_async_config ) + policy_t::nTypes * sizeof( ofp141::ofp_async_config_prop_reasons ); }
+  static vByte_t CreateSet( vByte_t, const policy_t& );
+
+  // the masks of a OFPT_GET_ASYNC_REPLY, types not in it are left as they were; false when a property overruns the message
+  static bool Decode( const ofp141::ofp_async_config&, const uint8_t* pEnd, policy_t& );
+
 private:
   typedef std::function<void( const ofp141::ofp_async_config_prop_header&)> funcPropertyHeader_t;
   
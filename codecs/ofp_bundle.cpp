@@ -0,0 +1,126 @@
+/*
+ * File:   ofp_bundle.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 11:40 PM
+ */
+
+#include <atomic>
+
+#include "ofp_bundle.h"
+
+namespace codec {
+namespace ofp_bundle {
+
+std::atomic<uint32_t> idBundle {}; // bundles are built on the io and ovsdb threads
+
+uint32_t NewBundleId() {
+  uint32_t id;
+  do {
+    id = ++idBundle;
+  } while ( 0 == id ); // 0 marks a builder without an open bundle
+  return id;
+}
+
+Builder::Builder(
+  fAcquireBuffer_t fAcquireBuffer, fTransmitBuffer_t fTransmitBuffer, fTransmitRequest_t fTransmitRequest,
+  fTransmitHeld_t fTransmitHeld, uint16_t flags
+)
+: m_fAcquireBuffer( std::move( fAcquireBuffer ) ),
+  m_fTransmitBuffer( std::move( fTransmitBuffer ) ),
+  m_fTransmitRequest( std::move( fTransmitRequest ) ),
+  m_fTransmitHeld( std::move( fTransmitHeld ) ),
+  m_flags( flags ), m_idBundle( 0 ), m_nMessages( 0 )
+{
+  assert( nullptr != m_fAcquireBuffer );
+  assert( nullptr != m_fTransmitBuffer );
+  assert( ( nullptr == m_fTransmitRequest ) || ( nullptr != m_fTransmitHeld ) );
+}
+
+Builder::~Builder() {
+  if ( 0 != m_idBundle ) {
+    Control( ofp141::ofp_bundle_ctrl_type::OFPBCT_DISCARD_REQUEST );
+  }
+}
+
+void Builder::Control( ofp141::ofp_bundle_ctrl_type type, fCompletion_t fCompletion ) {
+  vByte_t v = std::move( m_fAcquireBuffer( sizeof( ofp_bundle_ctrl_msg_ ) ) );
+  v.resize( sizeof( ofp_bundle_ctrl_msg_ ) );
+  auto* pMsg = new( v.data() ) ofp_bundle_ctrl_msg_;
+  pMsg->init( m_idBundle, type, m_flags );
+  if ( nullptr == fCompletion ) {
+    m_fTransmitBuffer( std::move( v ) );
+  }
+  else {
+    m_fTransmitRequest( std::move( v ), std::move( fCompletion ) );
+  }
+}
+
+void Builder::Add( vByte_t v ) {
+  assert( sizeof( ofp141::ofp_header ) <= v.size() );
+  if ( 0 == m_idBundle ) {
+    m_idBundle = NewBundleId();
+    if ( nullptr == m_fTransmitRequest ) {
+      Control( ofp141::ofp_bundle_ctrl_type::OFPBCT_OPEN_REQUEST );
+    }
+    else {
+      m_pvMessage = std::make_shared<vMessage_t>();
+      // a refused open is followed by a refused commit, which does the recovery
+      Control( ofp141::ofp_bundle_ctrl_type::OFPBCT_OPEN_REQUEST, []( bool ){} );
+    }
+  }
+  auto* pMessage = new( v.data() ) codec::ofp_header::ofp_header_;
+  if ( 0 == pMessage->xid ) {
+    ::codec::ofp_header::NewXid( *pMessage );
+  }
+  if ( m_pvMessage ) {
+    // the message is held until the commit is answered, its bundle header goes in a buffer of its own
+    pMessage_t pMessage( std::make_shared<const vByte_t>( std::move( v ) ) );
+    vByte_t vAdd = std::move( m_fAcquireBuffer( sizeof( ofp_bundle_add_msg_ ) ) );
+    vAdd.resize( sizeof( ofp_bundle_add_msg_ ) );
+    auto* pAdd = new( vAdd.data() ) ofp_bundle_add_msg_;
+    pAdd->init( m_idBundle, m_flags, *reinterpret_cast<const ofp141::ofp_header*>( pMessage->data() ) );
+    assert( vAdd.size() + pMessage->size() == pAdd->header.length );
+    m_pvMessage->push_back( pMessage );
+    m_fTransmitHeld( std::move( vAdd ), std::move( pMessage ) );
+  }
+  else {
+    // the message keeps its buffer, shifted along behind the bundle header
+    v.insert( v.begin(), sizeof( ofp_bundle_add_msg_ ), 0 );
+    auto* pAdd = new( v.data() ) ofp_bundle_add_msg_;
+    pAdd->init( m_idBundle, m_flags, *reinterpret_cast<const ofp141::ofp_header*>( v.data() + sizeof( ofp_bundle_add_msg_ ) ) );
+    assert( v.size() == pAdd->header.length );
+    m_fTransmitBuffer( std::move( v ) );
+  }
+  m_nMessages++;
+}
+
+void Builder::Commit( fCompletion_t fCommitted ) {
+  if ( 0 != m_idBundle ) {
+    if ( nullptr == m_fTransmitRequest ) {
+      Control( ofp141::ofp_bundle_ctrl_type::OFPBCT_COMMIT_REQUEST );
+      if ( nullptr != fCommitted ) fCommitted( true );
+    }
+    else {
+      Control(
+        ofp141::ofp_bundle_ctrl_type::OFPBCT_COMMIT_REQUEST,
+        [fAcquireBuffer=m_fAcquireBuffer,fTransmitBuffer=m_fTransmitBuffer,pvMessage=std::move( m_pvMessage ),fCommitted]( bool bCompleted ){
+          if ( !bCompleted ) { // shared with the transmit queue until written, so each is copied out
+            for ( const pMessage_t& pMessage: *pvMessage ) {
+              vByte_t v = std::move( fAcquireBuffer( pMessage->size() ) );
+              v.assign( pMessage->begin(), pMessage->end() );
+              fTransmitBuffer( std::move( v ) );
+            }
+          }
+          pvMessage->clear();
+          if ( nullptr != fCommitted ) fCommitted( bCompleted );
+        } );
+    }
+    m_idBundle = 0;
+    m_nMessages = 0;
+  }
+}
+
+} // namespace ofp_bundle
+} // namespace codec
@@ -0,0 +1,116 @@
+/*
+ * File:   ofp_bundle.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 11:40 PM
+ */
+
+#ifndef OFP_BUNDLE_H
+#define OFP_BUNDLE_H
+
+#include <new>
+#include <cassert>
+#include <memory>
+#include <vector>
+#include <functional>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+#include "../common.h"
+#include "ofp_header.h"
+
+// bundles, section 7.3.9, page 108 of v1.4.1:
+//   messages added to an open bundle are only applied by the switch on commit,
+//   with OFPBF_ATOMIC all or none of them, with OFPBF_ORDERED in the order added
+
+namespace codec {
+namespace ofp_bundle {
+
+uint32_t NewBundleId();
+
+struct ofp_bundle_ctrl_msg_: public ofp141::ofp_bundle_ctrl_msg {
+  void init( uint32_t idBundle, ofp141::ofp_bundle_ctrl_type type_, uint16_t flags_ ) {
+    auto* pHeader = new( &header ) codec::ofp_header::ofp_header_;
+    pHeader->init();
+    ::codec::ofp_header::NewXid( *pHeader );
+    header.type = ofp141::ofp_type::OFPT_BUNDLE_CONTROL;
+    header.length = sizeof( ofp_bundle_ctrl_msg_ );
+    bundle_id = idBundle;
+    type = type_;
+    flags = flags_;
+  }
+};
+
+// ofp_bundle_add_msg without the embedded message's header, the whole message follows
+struct ofp_bundle_add_msg_ {
+  ofp141::ofp_header header;
+  boost::endian::big_uint32_t bundle_id;
+  boost::endian::big_uint16_t pad;
+  boost::endian::big_uint16_t flags;
+  // the message must carry the same xid, no properties are added so no padding follows it
+  void init( uint32_t idBundle, uint16_t flags_, const ofp141::ofp_header& message ) {
+    auto* pHeader = new( &header ) codec::ofp_header::ofp_header_;
+    pHeader->init();
+    header.type = ofp141::ofp_type::OFPT_BUNDLE_ADD_MESSAGE;
+    header.length = sizeof( ofp_bundle_add_msg_ ) + message.length;
+    header.xid = message.xid;
+    bundle_id = idBundle;
+    pad = 0;
+    flags = flags_;
+  }
+};
+OFP_ASSERT(sizeof(ofp_bundle_add_msg_) == 16);
+
+// collects messages into one bundle:
+//   opened with the first message added, nothing is sent for an empty batch,
+//   Commit() sends the commit, uncommitted bundles are discarded when the builder goes
+// with fTransmitRequest, open and commit expect their replies: should the switch refuse the
+//   commit, or not answer, the messages added are sent again on their own, unbundled,
+//   and fCommitted is called with false; each message is then held, not copied, behind its
+//   bundle add header by fTransmitHeld until the commit is answered, copied only to be resent
+class Builder {
+public:
+
+  typedef std::function<vByte_t(size_t)> fAcquireBuffer_t; // size hint in octets
+  typedef std::function<void(vByte_t)> fTransmitBuffer_t;
+  typedef std::function<void(bool bCompleted)> fCompletion_t; // true on the reply, false on an error or no reply in time
+  typedef std::function<void(vByte_t,fCompletion_t)> fTransmitRequest_t;
+  typedef std::shared_ptr<const vByte_t> pMessage_t;
+  typedef std::function<void(vByte_t,pMessage_t)> fTransmitHeld_t; // the message follows the buffer on the wire
+
+  Builder(
+    fAcquireBuffer_t, fTransmitBuffer_t, fTransmitRequest_t = nullptr, fTransmitHeld_t = nullptr,
+    uint16_t flags = ofp141::ofp_bundle_flags::OFPBF_ATOMIC | ofp141::ofp_bundle_flags::OFPBF_ORDERED );
+  virtual ~Builder();
+
+  void Add( vByte_t ); // a complete message, wrapped in place in a bundle add message
+  void Commit( fCompletion_t fCommitted = nullptr ); // may be called before Commit returns
+
+  // a transmit function which adds to this bundle, for code built around fTransmitBuffer_t
+  fTransmitBuffer_t Transmit() { return [this]( vByte_t v ){ Add( std::move( v ) ); }; }
+
+  size_t Messages() const { return m_nMessages; }
+
+private:
+
+  typedef std::vector<pMessage_t> vMessage_t;
+
+  fAcquireBuffer_t m_fAcquireBuffer;
+  fTransmitBuffer_t m_fTransmitBuffer;
+  fTransmitRequest_t m_fTransmitRequest;
+  fTransmitHeld_t m_fTransmitHeld;
+  const uint16_t m_flags;
+  uint32_t m_idBundle; // 0 when not open
+  size_t m_nMessages;
+  std::shared_ptr<vMessage_t> m_pvMessage; // those added, held for sending unbundled, with fTransmitRequest
+
+  void Control( ofp141::ofp_bundle_ctrl_type, fCompletion_t = nullptr );
+
+  Builder( const Builder& ) = delete;
+};
+
+} // namespace ofp_bundle
+} // namespace codec
+
+#endif /* OFP_BUNDLE_H */
@@ -16,6 +16,7 @@
 #include <tuple>
 
 #include "../openflow/openflow-spec1.4.1.h"
+#include "../logging.h"
 #include "../protocol/ethernet/address.h"
 #include "ofp_header.h"
 
@@ -24,7 +25,6 @@ namespace ofp_flow_mod {
 
   typedef protocol::ethernet::address_t mac_t;
 
-  typedef std::function<void( uint32_t )> fInPortCookie_t; // in_port
   //typedef std::function<void( mac_t& )> fEth_t;
 
   // included in oxm fields.
@@ -36,7 +36,7 @@ namespace ofp_flow_mod {
 
     uint16_t oxm_class() { return m_class; }
     uint8_t oxm_field() { return (uint8_t)m_mixed >> 1; }
-    bool oxm_hasmask() { return (uint8_t)m_mixed && 0x01; }
+    bool oxm_hasmask() { return (uint8_t)m_mixed & 0x01; }
     uint8_t oxm_length() { return m_length; }
   };
 
@@ -169,56 +169,6 @@ namespace ofp_flow_mod {
       return pPad;
     }
 
-    // TODO: will need to refactor as different matches are required
-    // decodes *this ofp_match structure
-    // 2018/12/08, really only need IN_PORT for now
-    void decode( fInPortCookie_t fDecode ) {
-      const uint16_t lenMatches( length - 4 );
-      uint16_t cnt( 0 );
-      oxm_header_* p;
-      bool bFoundInPort( false );
-      while ( lenMatches > cnt ) {
-        p = new( &ofp141::ofp_match::oxm_fields[cnt] ) oxm_header_;
-        std::cout
-          << "ofp_match: "
-          << "class=" << std::hex << p->oxm_class() << std::dec
-          << ",field=" << (uint16_t)p->oxm_field()
-          << ",hasmask=" << p->oxm_hasmask()
-          << ",length=" << (uint16_t)p->oxm_length()
-          << std::endl;
-        switch ( p->oxm_field() ) {
-          case ofp141::OFPXMT_OFB_IN_PORT: {
-            assert( sizeof(uint32_t) == p->oxm_length() );
-            ofpxmt_ofb_in_port_* pInPort = new( p ) ofpxmt_ofb_in_port_;
-            std::cout << "in_port=" << pInPort->port << std::endl;
-            if ( nullptr != fDecode ) {
-              fDecode( pInPort->port );
-            } // if
-            bFoundInPort = true;
-            } // case
-            break;
-          case ofp141::OFPXMT_OFB_ETH_DST: {
-            assert( 6 == p->oxm_length() );
-            ofpxmt_ofb_eth_mac_* pMac = new( p ) ofpxmt_ofb_eth_mac_;
-            //if ( nullptr != std::get<fEthDest_t>( rfMatch ) ) {
-            //  std::get<fEthDest_t>( rfMatch )( pMac->mac );
-            //}
-            }
-          case ofp141::OFPXMT_OFB_ETH_SRC: {
-            assert( 6 == p->oxm_length() );
-            ofpxmt_ofb_eth_mac_* pMac = new( p ) ofpxmt_ofb_eth_mac_;
-            //if ( nullptr != std::get<fEthSrc_t>( rfMatch ) ) {
-            //  std::get<fEthSrc_t>( rfMatch )( pMac->mac );
-            //}
-            }
-          default:
-            std::cout << "**** ofp_match: unknown field" << std::endl;
-        }
-        cnt += sizeof( oxm_header_ ) + p->oxm_length();
-        assert( lenMatches >= cnt );
-      }
-    assert( bFoundInPort );
-    }
   };
 
   // pg 74 v1.4.1 s7.2.3 (a default empty entry)
@@ -316,6 +266,15 @@ namespace ofp_flow_mod {
     }
   };
 
+  // pg 75 v1.4.1 s7.2.3, precedes the other instructions, as the meter applies first
+  struct ofp_instruction_meter_: public ofp141::ofp_instruction_meter {
+    void init( uint32_t meter_id_ ) {
+      type = ofp141::ofp_instruction_type::OFPIT_METER;
+      len = sizeof( ofp141::ofp_instruction_meter );
+      meter_id = meter_id_;
+    }
+  };
+
   // pg 75 v1.4.1 s7.2.3
   struct ofp_instruction_actions_: public ofp141::ofp_instruction_actions {
     void init( ofp141::ofp_instruction_type type_ = ofp141::ofp_instruction_type::OFPIT_APPLY_ACTIONS ) {
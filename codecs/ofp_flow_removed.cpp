@@ -0,0 +1,62 @@
+/*
+ * File:   ofp_flow_removed.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:20 AM
+ */
+
+#include <ostream>
+
+#include "ofp_flow_removed.h"
+
+namespace codec {
+namespace ofp_flow_removed {
+
+ofp_match::result_t Decode( const ofp141::ofp_flow_removed& msg, const uint8_t* pEnd, removed_t& removed ) {
+
+  if ( ( reinterpret_cast<const uint8_t*>( &msg ) + sizeof( ofp141::ofp_flow_removed ) ) > pEnd ) {
+    return ofp_match::result_t::truncated;
+  }
+
+  removed.cookie = msg.cookie;
+  removed.priority = msg.priority;
+  removed.reason = msg.reason;
+  removed.table_id = msg.table_id;
+  removed.duration_sec = msg.duration_sec;
+  removed.idle_timeout = msg.idle_timeout;
+  removed.hard_timeout = msg.hard_timeout;
+  removed.packet_count = msg.packet_count;
+  removed.byte_count = msg.byte_count;
+
+  return ofp_match::Decode( msg.match, pEnd, removed.fields );
+}
+
+const char* Reason( uint8_t reason ) {
+  switch ( reason ) {
+    case ofp141::ofp_flow_removed_reason::OFPRR_IDLE_TIMEOUT: return "idle timeout";
+    case ofp141::ofp_flow_removed_reason::OFPRR_HARD_TIMEOUT: return "hard timeout";
+    case ofp141::ofp_flow_removed_reason::OFPRR_DELETE:       return "delete";
+    case ofp141::ofp_flow_removed_reason::OFPRR_GROUP_DELETE: return "group delete";
+    case ofp141::ofp_flow_removed_reason::OFPRR_METER_DELETE: return "meter delete";
+    case ofp141::ofp_flow_removed_reason::OFPRR_EVICTION:     return "eviction";
+    default: return "unknown";
+  }
+}
+
+} // namespace ofp_flow_removed
+} // namespace codec
+
+std::ostream& operator<<( std::ostream& os, const codec::ofp_flow_removed::removed_t& removed ) {
+  os
+    << "cookie=0x" << std::hex << removed.cookie << std::dec
+    << ",priority=" << removed.priority
+    << ",reason=" << codec::ofp_flow_removed::Reason( removed.reason )
+    << ",table=" << (uint16_t)removed.table_id
+    << ",duration=" << removed.duration_sec
+    << ",packets=" << removed.packet_count
+    << ",bytes=" << removed.byte_count
+    << ",match=" << removed.fields
+    ;
+  return os;
+}
@@ -0,0 +1,49 @@
+/*
+ * File:   ofp_flow_removed.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:20 AM
+ */
+
+#ifndef OFP_FLOW_REMOVED_H
+#define OFP_FLOW_REMOVED_H
+
+#include <iosfwd>
+#include <cstdint>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+#include "ofp_match.h"
+
+// flow removed, pg 142 v1.4.1 s7.4.2
+//   sent for flows installed with OFPFF_SEND_FLOW_REM, the match comes back as it was installed,
+//   decoded here with the rest of the message into host order fields.
+
+namespace codec {
+namespace ofp_flow_removed {
+
+  struct removed_t {
+    uint64_t cookie;
+    uint16_t priority;
+    uint8_t  reason;   // ofp141::ofp_flow_removed_reason
+    uint8_t  table_id;
+    uint32_t duration_sec;
+    uint16_t idle_timeout;
+    uint16_t hard_timeout;
+    uint64_t packet_count;
+    uint64_t byte_count;
+    ofp_match::match_fields fields;
+  };
+
+  // result_t::ok, or why the match could not be decoded, the fixed fields are filled in regardless
+  ofp_match::result_t Decode( const ofp141::ofp_flow_removed&, const uint8_t* pEnd, removed_t& );
+
+  const char* Reason( uint8_t );
+
+} // namespace ofp_flow_removed
+} // namespace codec
+
+std::ostream& operator<<( std::ostream&, const codec::ofp_flow_removed::removed_t& );
+
+#endif /* OFP_FLOW_REMOVED_H */
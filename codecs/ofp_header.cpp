@@ -6,16 +6,23 @@
  * Created on June 5, 2017, 1:13 PM
  */
 
+#include <atomic>
+
 #include "ofp_header.h"
 
 namespace codec {
 namespace ofp_header {
 
-uint32_t xid {};
+std::atomic<uint32_t> xid {}; // messages are built on several threads
 
+// the upper half of the xid space is left to each session's Transactions,
+//   0 is skipped on wrap, as init() leaves it for a header still to be given an xid
 void NewXid( ofp_header_& header ) {
-  xid++;
-  header.xid = xid;
+  uint32_t id;
+  do {
+    id = ++xid & 0x7fffffff;
+  } while ( 0 == id );
+  header.xid = id;
 }
 
 void CopyXid( const ofp_header_& src, ofp_header_& dst ) {
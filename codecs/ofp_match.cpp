@@ -0,0 +1,249 @@
+/*
+ * File:   ofp_match.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 1:10 AM
+ */
+
+#include <cstring>
+#include <ostream>
+#include <iomanip>
+
+#include "ofp_match.h"
+
+namespace {
+
+  using codec::ofp_match::values_t;
+
+  enum kind_t : uint8_t { none, integer, mac, ipv4, ipv6 };
+
+  struct field_t {
+    uint8_t idField;   // as a check on the table's order
+    kind_t kind;
+    uint8_t nWire;     // octets of the value, doubled on the wire when masked
+    uint8_t nStorage;  // octets of the integer in values_t, 0 for addresses
+    uint16_t offset;   // in values_t
+    const char* szName;
+  };
+
+  #define OXM_FIELD_ENTRY( id, member, kind, octets ) \
+    { ofp141::oxm_ofb_match_fields::id, kind, octets, \
+      ( ( kind == mac ) || ( kind == ipv6 ) ) ? 0 : sizeof( values_t::member ), \
+      offsetof( values_t, member ), #member }
+
+  // indexed by oxm_ofb_match_fields, lengths from pg 64-66 v1.4.1 s7.2.3.7
+  constexpr field_t rField[ codec::ofp_match::nFields ] = {
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IN_PORT,        in_port,        integer, 4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IN_PHY_PORT,    in_phy_port,    integer, 4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_METADATA,       metadata,       integer, 8 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ETH_DST,        eth_dst,        mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ETH_SRC,        eth_src,        mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ETH_TYPE,       eth_type,       integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_VLAN_VID,       vlan_vid,       integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_VLAN_PCP,       vlan_pcp,       integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IP_DSCP,        ip_dscp,        integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IP_ECN,         ip_ecn,         integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IP_PROTO,       ip_proto,       integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV4_SRC,       ipv4_src,       ipv4,    4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV4_DST,       ipv4_dst,       ipv4,    4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_TCP_SRC,        tcp_src,        integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_TCP_DST,        tcp_dst,        integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_UDP_SRC,        udp_src,        integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_UDP_DST,        udp_dst,        integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_SCTP_SRC,       sctp_src,       integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_SCTP_DST,       sctp_dst,       integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ICMPV4_TYPE,    icmpv4_type,    integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ICMPV4_CODE,    icmpv4_code,    integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ARP_OP,         arp_op,         integer, 2 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ARP_SPA,        arp_spa,        ipv4,    4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ARP_TPA,        arp_tpa,        ipv4,    4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ARP_SHA,        arp_sha,        mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ARP_THA,        arp_tha,        mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_SRC,       ipv6_src,       ipv6,   16 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_DST,       ipv6_dst,       ipv6,   16 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_FLABEL,    ipv6_flabel,    integer, 4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ICMPV6_TYPE,    icmpv6_type,    integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_ICMPV6_CODE,    icmpv6_code,    integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_ND_TARGET, ipv6_nd_target, ipv6,   16 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_ND_SLL,    ipv6_nd_sll,    mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_ND_TLL,    ipv6_nd_tll,    mac,     6 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_MPLS_LABEL,     mpls_label,     integer, 4 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_MPLS_TC,        mpls_tc,        integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFP_MPLS_BOS,       mpls_bos,       integer, 1 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_PBB_ISID,       pbb_isid,       integer, 3 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_TUNNEL_ID,      tunnel_id,      integer, 8 ),
+    OXM_FIELD_ENTRY( OFPXMT_OFB_IPV6_EXTHDR,    ipv6_exthdr,    integer, 2 ),
+    { 40, none, 0, 0, 0, nullptr }, // OFPXMT_OFB_TCP_FLAGS arrives with v1.5
+    OXM_FIELD_ENTRY( OFPXMT_OFB_PBB_UCA,        pbb_uca,        integer, 1 )
+  };
+
+  #undef OXM_FIELD_ENTRY
+
+  constexpr bool Ordered() {
+    for ( size_t ix = 0; ix < codec::ofp_match::nFields; ix++ ) {
+      if ( ix != rField[ ix ].idField ) return false;
+    }
+    return true;
+  }
+  static_assert( Ordered(), "rField is indexed by oxm_ofb_match_fields" );
+
+  const size_t nOxmHeader = 4;
+
+  void Store( const field_t& field, const uint8_t* pWire, values_t& values ) {
+    uint8_t* pValue = reinterpret_cast<uint8_t*>( &values ) + field.offset;
+    if ( 0 == field.nStorage ) {
+      std::memcpy( pValue, pWire, field.nWire );
+    }
+    else {
+      uint64_t value( 0 );
+      for ( size_t ix = 0; ix < field.nWire; ix++ ) {
+        value = ( value << 8 ) | pWire[ ix ];
+      }
+      switch ( field.nStorage ) {
+        case 1: *pValue = value; break;
+        case 2: *reinterpret_cast<uint16_t*>( pValue ) = value; break;
+        case 4: *reinterpret_cast<uint32_t*>( pValue ) = value; break;
+        case 8: *reinterpret_cast<uint64_t*>( pValue ) = value; break;
+      }
+    }
+  }
+
+  void Emit( std::ostream& os, const field_t& field, const values_t& values ) {
+    const uint8_t* pValue = reinterpret_cast<const uint8_t*>( &values ) + field.offset;
+    uint64_t value( 0 );
+    switch ( field.nStorage ) {
+      case 1: value = *pValue; break;
+      case 2: value = *reinterpret_cast<const uint16_t*>( pValue ); break;
+      case 4: value = *reinterpret_cast<const uint32_t*>( pValue ); break;
+      case 8: value = *reinterpret_cast<const uint64_t*>( pValue ); break;
+    }
+    switch ( field.kind ) {
+      case integer:
+        os << value;
+        break;
+      case ipv4:
+        os << ( ( value >> 24 ) & 0xff ) << '.' << ( ( value >> 16 ) & 0xff ) << '.' << ( ( value >> 8 ) & 0xff ) << '.' << ( value & 0xff );
+        break;
+      case mac:
+      case ipv6: {
+        const char separator = ( mac == field.kind ) ? ':' : ' ';
+        const std::ios_base::fmtflags flags( os.flags() );
+        os << std::hex << std::setfill( '0' );
+        for ( size_t ix = 0; ix < field.nWire; ix++ ) {
+          if ( 0 != ix ) os << separator;
+          os << std::setw( 2 ) << (uint16_t)pValue[ ix ];
+        }
+        os.flags( flags );
+        }
+        break;
+      case none:
+        break;
+    }
+  }
+
+} // namespace anon
+
+namespace codec {
+namespace ofp_match {
+
+result_t Decode( const ofp141::ofp_match& match, const uint8_t* pEnd, match_fields& fields ) {
+
+  const uint8_t* pBegin = reinterpret_cast<const uint8_t*>( &match );
+  if ( ( pBegin + nOxmHeader ) > pEnd ) return result_t::truncated; // type and length
+  if ( ofp141::ofp_match_type::OFPMT_OXM != match.type ) return result_t::type;
+
+  const uint16_t length = match.length;
+  if ( nOxmHeader > length ) return result_t::truncated;
+  const uint8_t* pLimit = ( ( pBegin + length ) < pEnd ) ? ( pBegin + length ) : pEnd;
+  const uint8_t* p = pBegin + offsetof( ofp141::ofp_match, oxm_fields );
+
+  while ( p < pLimit ) {
+    if ( ( p + nOxmHeader ) > pLimit ) return result_t::truncated;
+    const uint16_t oxm_class = ( p[ 0 ] << 8 ) | p[ 1 ];
+    const uint8_t oxm_field = p[ 2 ] >> 1;
+    const bool bHasMask = 0 != ( p[ 2 ] & 0x01 );
+    const uint8_t oxm_length = p[ 3 ];
+    const uint8_t* pValue = p + nOxmHeader;
+    if ( ( pValue + oxm_length ) > pLimit ) return result_t::truncated;
+
+    if ( ( ofp141::ofp_oxm_class::OFPXMC_OPENFLOW_BASIC == oxm_class ) && ( nFields > oxm_field ) ) {
+      const field_t& field( rField[ oxm_field ] );
+      if ( none != field.kind ) {
+        if ( oxm_length != ( bHasMask ? 2 * field.nWire : field.nWire ) ) return result_t::length;
+        const uint64_t bit = uint64_t( 1 ) << oxm_field;
+        if ( 0 != ( fields.present & bit ) ) return result_t::duplicate;
+        fields.present |= bit;
+        Store( field, pValue, fields.value );
+        if ( bHasMask ) {
+          fields.masked |= bit;
+          Store( field, pValue + field.nWire, fields.mask );
+        }
+      }
+    }
+    // other classes, and fields this version does not define, are stepped over
+
+    p = pValue + oxm_length;
+  }
+
+  if ( ( pBegin + length ) > pEnd ) return result_t::truncated; // fields were cut short of match.length
+  return result_t::ok;
+}
+
+uint32_t InPort( const ofp141::ofp_match& match, const uint8_t* pEnd ) {
+
+  const uint8_t* pBegin = reinterpret_cast<const uint8_t*>( &match );
+  if ( ( pBegin + nOxmHeader ) > pEnd ) return 0;
+  if ( ofp141::ofp_match_type::OFPMT_OXM != match.type ) return 0;
+
+  const uint16_t length = match.length;
+  const uint8_t* pLimit = ( ( pBegin + length ) < pEnd ) ? ( pBegin + length ) : pEnd;
+  const uint8_t* p = pBegin + offsetof( ofp141::ofp_match, oxm_fields );
+
+  while ( ( p + nOxmHeader ) <= pLimit ) {
+    const uint16_t oxm_class = ( p[ 0 ] << 8 ) | p[ 1 ];
+    const uint8_t oxm_field = p[ 2 ] >> 1;
+    const uint8_t oxm_length = p[ 3 ];
+    const uint8_t* pValue = p + nOxmHeader;
+    if ( ( pValue + oxm_length ) > pLimit ) return 0;
+    if ( ( ofp141::ofp_oxm_class::OFPXMC_OPENFLOW_BASIC == oxm_class )
+      && ( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_IN_PORT == oxm_field )
+      && ( 4 == oxm_length ) ) {
+      return ( uint32_t( pValue[ 0 ] ) << 24 ) | ( uint32_t( pValue[ 1 ] ) << 16 ) | ( uint32_t( pValue[ 2 ] ) << 8 ) | pValue[ 3 ];
+    }
+    p = pValue + oxm_length;
+  }
+
+  return 0;
+}
+
+const char* Name( result_t result ) {
+  switch ( result ) {
+    case result_t::ok:        return "ok";
+    case result_t::truncated: return "truncated";
+    case result_t::length:    return "bad field length";
+    case result_t::duplicate: return "duplicate field";
+    case result_t::type:      return "not an oxm match";
+  }
+  return "unknown";
+}
+
+} // namespace ofp_match
+} // namespace codec
+
+std::ostream& operator<<( std::ostream& os, const codec::ofp_match::match_fields& fields ) {
+  bool bFirst( true );
+  for ( const field_t& field: rField ) {
+    if ( ( none != field.kind ) && ( 0 != ( fields.present & ( uint64_t( 1 ) << field.idField ) ) ) ) {
+      if ( !bFirst ) os << ',';
+      bFirst = false;
+      os << field.szName << '=';
+      Emit( os, field, fields.value );
+      if ( 0 != ( fields.masked & ( uint64_t( 1 ) << field.idField ) ) ) {
+        os << '/';
+        Emit( os, field, fields.mask );
+      }
+    }
+  }
+  return os;
+}
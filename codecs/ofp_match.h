@@ -0,0 +1,115 @@
+/*
+ * File:   ofp_match.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 1:10 AM
+ */
+
+#ifndef OFP_MATCH_H
+#define OFP_MATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+// the oxm fields of an ofp_match, pg 63 v1.4.1 s7.2.2, decoded in one pass:
+//   each OFPXMC_OPENFLOW_BASIC field is looked up in a table, by field number, giving its
+//     length and where it lands in match_fields, so there is no per field code,
+//   integers are stored in host order, addresses as their octets,
+//   a bit per field says which are present, and which of those carried a mask,
+//   other classes are stepped over, anything running past the end of the match fails the decode.
+
+namespace codec {
+namespace ofp_match {
+
+  enum { nFields = ofp141::oxm_ofb_match_fields::OFPXMT_OFB_PBB_UCA + 1 };
+
+  typedef uint8_t mac_t[ 6 ];
+  typedef uint8_t ipv6_t[ 16 ];
+
+  struct values_t {
+    uint32_t in_port;
+    uint32_t in_phy_port;
+    uint64_t metadata;
+    mac_t    eth_dst;
+    mac_t    eth_src;
+    uint16_t eth_type;
+    uint16_t vlan_vid;     // with OFPVID_PRESENT
+    uint8_t  vlan_pcp;
+    uint8_t  ip_dscp;
+    uint8_t  ip_ecn;
+    uint8_t  ip_proto;
+    uint32_t ipv4_src;
+    uint32_t ipv4_dst;
+    uint16_t tcp_src;
+    uint16_t tcp_dst;
+    uint16_t udp_src;
+    uint16_t udp_dst;
+    uint16_t sctp_src;
+    uint16_t sctp_dst;
+    uint8_t  icmpv4_type;
+    uint8_t  icmpv4_code;
+    uint16_t arp_op;
+    uint32_t arp_spa;
+    uint32_t arp_tpa;
+    mac_t    arp_sha;
+    mac_t    arp_tha;
+    ipv6_t   ipv6_src;
+    ipv6_t   ipv6_dst;
+    uint32_t ipv6_flabel;
+    uint8_t  icmpv6_type;
+    uint8_t  icmpv6_code;
+    ipv6_t   ipv6_nd_target;
+    mac_t    ipv6_nd_sll;
+    mac_t    ipv6_nd_tll;
+    uint32_t mpls_label;
+    uint8_t  mpls_tc;
+    uint8_t  mpls_bos;
+    uint32_t pbb_isid;     // 24 bits on the wire
+    uint64_t tunnel_id;
+    uint16_t ipv6_exthdr;
+    uint8_t  pbb_uca;
+  };
+
+  // only fields with their bit set in present hold a value, nothing else is cleared
+  struct match_fields {
+    uint64_t present; // bit per oxm_ofb_match_fields
+    uint64_t masked;  // of those present, the ones with a mask
+    values_t value;
+    values_t mask;
+
+    match_fields(): present( 0 ), masked( 0 ) {}
+
+    static constexpr uint64_t Bit( ofp141::oxm_ofb_match_fields field ) { return uint64_t( 1 ) << field; }
+    bool Has( ofp141::oxm_ofb_match_fields field ) const { return 0 != ( present & Bit( field ) ); }
+    bool Masked( ofp141::oxm_ofb_match_fields field ) const { return 0 != ( masked & Bit( field ) ); }
+    bool HasAll( uint64_t bits ) const { return bits == ( present & bits ); }
+  };
+
+  enum class result_t {
+    ok,
+    truncated, // an oxm header or value runs past the end of the match
+    length,    // a basic field with the wrong length for its type
+    duplicate, // a basic field appears more than once
+    type       // not OFPMT_OXM
+  };
+
+  // [match, pEnd) is what was received, match.length is also honoured;
+  //   on failure fields holds what was decoded before the fault
+  result_t Decode( const ofp141::ofp_match&, const uint8_t* pEnd, match_fields& );
+
+  // only OFPXMT_OFB_IN_PORT, stepping over the other fields' headers, 0 when absent or malformed;
+  //   for keying a packet_in before it is decoded
+  uint32_t InPort( const ofp141::ofp_match&, const uint8_t* pEnd );
+
+  const char* Name( result_t );
+
+} // namespace ofp_match
+} // namespace codec
+
+std::ostream& operator<<( std::ostream&, const codec::ofp_match::match_fields& ); // the fields present
+
+#endif /* OFP_MATCH_H */
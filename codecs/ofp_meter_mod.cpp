@@ -0,0 +1,47 @@
+/*
+ * File:   ofp_meter_mod.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 6:10 AM
+ */
+
+#include "builder.h"
+#include "ofp_meter_mod.h"
+
+namespace codec {
+namespace ofp_meter_mod {
+
+vByte_t Create( vByte_t v, ofp141::ofp_meter_mod_command cmd, uint32_t meter_id, uint32_t pps, uint32_t burst ) {
+
+  v.clear();
+  ofp::Builder build( v, Size() );
+
+  auto* pMod = build.Append<ofp_meter_mod_>();
+  pMod->init( cmd, meter_id );
+
+  auto* pBand = build.Append<ofp_meter_band_drop_>();
+  pBand->init( pps, burst );
+
+  pMod->header.length = Size();
+  assert( build.Complete() );
+
+  return v;
+}
+
+vByte_t CreateDelete( vByte_t v, uint32_t meter_id ) {
+
+  v.clear();
+  ofp::Builder build( v, DeleteSize() );
+
+  auto* pMod = build.Append<ofp_meter_mod_>();
+  pMod->init( ofp141::ofp_meter_mod_command::OFPMC_DELETE, meter_id );
+  pMod->flags = 0;
+
+  assert( build.Complete() );
+
+  return v;
+}
+
+} // namespace ofp_meter_mod
+} // namespace codec
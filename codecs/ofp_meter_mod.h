@@ -0,0 +1,69 @@
+/*
+ * File:   ofp_meter_mod.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 6:10 AM
+ */
+
+#ifndef OFP_METER_MOD_H
+#define OFP_METER_MOD_H
+
+#include <cstring>
+#include <cassert>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+#include "../common.h"
+#include "ofp_header.h"
+
+// meters, v1.4.1 s7.3.4.5
+//   a meter here has a single drop band, rated in packets per second,
+//   so what exceeds the rate is shed in the switch before it becomes a packet_in
+
+namespace codec {
+namespace ofp_meter_mod {
+
+  struct ofp_meter_mod_: public ofp141::ofp_meter_mod {
+    void init( ofp141::ofp_meter_mod_command cmd, uint32_t meter_id_ ) {
+      auto pHeader = new( &header ) codec::ofp_header::ofp_header_;
+      pHeader->init();
+      header.type = ofp141::ofp_type::OFPT_METER_MOD;
+      header.length = sizeof( ofp_meter_mod_ ); // bands add to it
+      assert( sizeof( ofp_meter_mod_ ) == sizeof( ofp141::ofp_meter_mod ) );
+      codec::ofp_header::NewXid( *pHeader );
+      command = cmd;
+      flags =
+          ofp141::ofp_meter_flags::OFPMF_PKTPS
+        | ofp141::ofp_meter_flags::OFPMF_BURST
+        | ofp141::ofp_meter_flags::OFPMF_STATS;
+      meter_id = meter_id_;
+    }
+  };
+
+  // v1.4.1 s7.3.4.5
+  struct ofp_meter_band_drop_: public ofp141::ofp_meter_band_drop {
+    void init( uint32_t rate_, uint32_t burst_size_ ) {
+      assert( sizeof( ofp_meter_band_drop_ ) == sizeof( ofp141::ofp_meter_band_drop ) );
+      type = ofp141::ofp_meter_band_type::OFPMBT_DROP;
+      len = sizeof( ofp141::ofp_meter_band_drop );
+      rate = rate_;
+      burst_size = burst_size_;
+      std::memset( pad, 0, 4 );
+    }
+  };
+
+  // an OFPMC_ADD or OFPMC_MODIFY with one drop band
+  constexpr size_t Size() {
+    return sizeof( ofp141::ofp_meter_mod ) + sizeof( ofp141::ofp_meter_band_drop );
+  }
+  vByte_t Create( vByte_t, ofp141::ofp_meter_mod_command, uint32_t meter_id, uint32_t pps, uint32_t burst );
+
+  // an OFPMC_DELETE, OFPM_ALL removes every meter, and with them the flows using them
+  constexpr size_t DeleteSize() { return sizeof( ofp141::ofp_meter_mod ); }
+  vByte_t CreateDelete( vByte_t, uint32_t meter_id );
+
+} // namespace ofp_meter_mod
+} // namespace codec
+
+#endif /* OFP_METER_MOD_H */
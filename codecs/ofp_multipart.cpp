@@ -0,0 +1,192 @@
+/*
+ * File:   ofp_multipart.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 2:50 AM
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+
+#include "builder.h"
+#include "ofp_header.h"
+#include "ofp_multipart.h"
+
+namespace {
+
+  // an ofp_match with no fields: type, length and four octets of padding
+  const size_t nMatchEmpty = sizeof( ofp141::ofp_match );
+
+  size_t BodySize( ofp141::ofp_multipart_type type ) {
+    switch ( type ) {
+      case ofp141::ofp_multipart_type::OFPMP_FLOW:
+        return sizeof( ofp141::ofp_flow_stats_request ) - sizeof( ofp141::ofp_match ) + nMatchEmpty;
+      case ofp141::ofp_multipart_type::OFPMP_GROUP:
+        return sizeof( ofp141::ofp_group_stats_request );
+      case ofp141::ofp_multipart_type::OFPMP_PORT_STATS:
+        return sizeof( ofp141::ofp_port_stats_request );
+      case ofp141::ofp_multipart_type::OFPMP_TABLE:
+        return 0;
+      case ofp141::ofp_multipart_type::OFPMP_METER:
+        return sizeof( ofp141::ofp_meter_multipart_request );
+      default:
+        throw std::runtime_error( "ofp_multipart: no request codec for the type" );
+    }
+  }
+
+  template<typename T>
+  const T* Record( const uint8_t* p ) {
+    return reinterpret_cast<const T*>( p );
+  }
+
+} // namespace anon
+
+namespace codec {
+namespace ofp_multipart {
+
+size_t RequestSize( ofp141::ofp_multipart_type type ) {
+  return sizeof( ofp141::ofp_multipart_request ) + BodySize( type );
+}
+
+void Request( vByte_t& v, ofp141::ofp_multipart_type type ) {
+
+  const size_t nOctets( RequestSize( type ) );
+  v.clear();
+  ofp::Builder build( v, nOctets );
+
+  auto* pRequest = build.Append<ofp141::ofp_multipart_request>();
+  auto* pHeader = new( &pRequest->header ) codec::ofp_header::ofp_header_;
+  pHeader->init();
+  pHeader->type = ofp141::ofp_type::OFPT_MULTIPART_REQUEST;
+  pHeader->length = nOctets;
+  codec::ofp_header::NewXid( *pHeader );
+  pRequest->type = type;
+  pRequest->flags = 0;
+  std::memset( pRequest->pad, 0, sizeof( pRequest->pad ) );
+
+  switch ( type ) {
+    case ofp141::ofp_multipart_type::OFPMP_FLOW: {
+      auto* pFlow = build.Append<ofp141::ofp_flow_stats_request>(); // includes the empty match
+      pFlow->table_id = ofp141::ofp_table::OFPTT_ALL;
+      std::memset( pFlow->pad, 0, sizeof( pFlow->pad ) );
+      pFlow->out_port = ofp141::ofp_port_no::OFPP_ANY;
+      pFlow->out_group = ofp141::ofp_group::OFPG_ANY;
+      std::memset( pFlow->pad2, 0, sizeof( pFlow->pad2 ) );
+      pFlow->cookie = 0;
+      pFlow->cookie_mask = 0;
+      pFlow->match.type = ofp141::ofp_match_type::OFPMT_OXM;
+      pFlow->match.length = offsetof( ofp141::ofp_match, oxm_fields );
+      std::memset( pFlow->match.pad, 0, sizeof( pFlow->match.pad ) );
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_GROUP: {
+      auto* pGroup = build.Append<ofp141::ofp_group_stats_request>();
+      pGroup->group_id = ofp141::ofp_group::OFPG_ALL;
+      std::memset( pGroup->pad, 0, sizeof( pGroup->pad ) );
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_PORT_STATS: {
+      auto* pPort = build.Append<ofp141::ofp_port_stats_request>();
+      pPort->port_no = ofp141::ofp_port_no::OFPP_ANY;
+      std::memset( pPort->pad, 0, sizeof( pPort->pad ) );
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_METER: {
+      auto* pMeter = build.Append<ofp141::ofp_meter_multipart_request>();
+      pMeter->meter_id = ofp141::ofp_meter::OFPM_ALL;
+      std::memset( pMeter->pad, 0, sizeof( pMeter->pad ) );
+      }
+      break;
+    default:
+      break;
+  }
+
+  assert( build.Complete() );
+}
+
+bool Decode( const ofp141::ofp_multipart_reply& msg, const uint8_t* pEnd, const visitor_t& visitor, size_t& nRecords ) {
+
+  const uint8_t* p = reinterpret_cast<const uint8_t*>( &msg ) + sizeof( ofp141::ofp_multipart_reply );
+  const uint8_t* pLimit = reinterpret_cast<const uint8_t*>( &msg ) + msg.header.length;
+  if ( pLimit > pEnd ) return false;
+
+  switch ( msg.type ) {
+    case ofp141::ofp_multipart_type::OFPMP_FLOW:
+      while ( p < pLimit ) {
+        if ( ( p + sizeof( ofp141::ofp_flow_stats ) ) > pLimit ) return false;
+        const auto* pStats = Record<ofp141::ofp_flow_stats>( p );
+        const uint8_t* pRecordEnd = p + pStats->length;
+        const size_t nMatch = ( ( pStats->match.length + 7 ) / 8 ) * 8;
+        const uint8_t* pInstructions = reinterpret_cast<const uint8_t*>( &pStats->match ) + nMatch;
+        if ( ( pRecordEnd > pLimit ) || ( pInstructions > pRecordEnd ) ) return false;
+        if ( nullptr != visitor.fFlow ) {
+          ofp_match::match_fields fields;
+          ofp_match::Decode( pStats->match, pInstructions, fields );
+          visitor.fFlow( flow_t{ *pStats, fields, pInstructions, pRecordEnd } );
+        }
+        nRecords++;
+        p = pRecordEnd;
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_GROUP:
+      while ( p < pLimit ) {
+        if ( ( p + sizeof( ofp141::ofp_group_stats ) ) > pLimit ) return false;
+        const auto* pStats = Record<ofp141::ofp_group_stats>( p );
+        const uint8_t* pRecordEnd = p + pStats->length;
+        if ( ( pRecordEnd > pLimit ) || ( sizeof( ofp141::ofp_group_stats ) > pStats->length ) ) return false;
+        if ( nullptr != visitor.fGroup ) {
+          const size_t nBuckets = ( pStats->length - sizeof( ofp141::ofp_group_stats ) ) / sizeof( ofp141::ofp_bucket_counter );
+          visitor.fGroup( group_t{ *pStats, nBuckets } );
+        }
+        nRecords++;
+        p = pRecordEnd;
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_PORT_STATS:
+      while ( p < pLimit ) {
+        if ( ( p + sizeof( ofp141::ofp_port_stats ) ) > pLimit ) return false;
+        const auto* pStats = Record<ofp141::ofp_port_stats>( p );
+        const uint8_t* pRecordEnd = p + pStats->length;
+        if ( ( pRecordEnd > pLimit ) || ( sizeof( ofp141::ofp_port_stats ) > pStats->length ) ) return false;
+        if ( nullptr != visitor.fPort ) {
+          visitor.fPort( port_t{ *pStats, p + sizeof( ofp141::ofp_port_stats ), pRecordEnd } );
+        }
+        nRecords++;
+        p = pRecordEnd;
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_TABLE:
+      while ( p < pLimit ) {
+        if ( ( p + sizeof( ofp141::ofp_table_stats ) ) > pLimit ) return false;
+        if ( nullptr != visitor.fTable ) {
+          visitor.fTable( *Record<ofp141::ofp_table_stats>( p ) );
+        }
+        nRecords++;
+        p += sizeof( ofp141::ofp_table_stats );
+      }
+      break;
+    case ofp141::ofp_multipart_type::OFPMP_METER:
+      while ( p < pLimit ) {
+        if ( ( p + sizeof( ofp141::ofp_meter_stats ) ) > pLimit ) return false;
+        const auto* pStats = Record<ofp141::ofp_meter_stats>( p );
+        const uint8_t* pRecordEnd = p + pStats->len;
+        if ( ( pRecordEnd > pLimit ) || ( sizeof( ofp141::ofp_meter_stats ) > pStats->len ) ) return false;
+        if ( nullptr != visitor.fMeter ) {
+          const size_t nBands = ( pStats->len - sizeof( ofp141::ofp_meter_stats ) ) / sizeof( ofp141::ofp_meter_band_stats );
+          visitor.fMeter( meter_t{ *pStats, Record<ofp141::ofp_meter_band_stats>( p + sizeof( ofp141::ofp_meter_stats ) ), nBands } );
+        }
+        nRecords++;
+        p = pRecordEnd;
+      }
+      break;
+    default:
+      break; // not decoded, the part is accepted as is
+  }
+
+  return true;
+}
+
+} // namespace ofp_multipart
+} // namespace codec
@@ -0,0 +1,76 @@
+/*
+ * File:   ofp_multipart.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 2:50 AM
+ */
+
+#ifndef OFP_MULTIPART_H
+#define OFP_MULTIPART_H
+
+#include <cstdint>
+#include <functional>
+
+#include "../openflow/openflow-spec1.4.1.h"
+
+#include "../common.h"
+#include "ofp_match.h"
+
+// multipart requests and replies, pg 87 v1.4.1 s7.3.5
+//   requests select everything: flows in all tables, all groups, all ports, all tables, all meters,
+//   a reply part is decoded in place, each record handed to the visitor as it is reached,
+//   records are whole within a part, so nothing is kept from one part to the next.
+
+namespace codec {
+namespace ofp_multipart {
+
+  struct flow_t {
+    const ofp141::ofp_flow_stats& stats;
+    const ofp_match::match_fields& fields; // stats.match, decoded
+    const uint8_t* pInstructions;          // [pInstructions,pEnd)
+    const uint8_t* pEnd;
+  };
+
+  struct group_t {
+    const ofp141::ofp_group_stats& stats;
+    size_t nBuckets; // in stats.bucket_stats
+  };
+
+  struct port_t {
+    const ofp141::ofp_port_stats& stats;
+    const uint8_t* pProperties; // [pProperties,pEnd)
+    const uint8_t* pEnd;
+  };
+
+  struct meter_t {
+    const ofp141::ofp_meter_stats& stats;
+    const ofp141::ofp_meter_band_stats* pBands; // stats.band_stats, in the order of the meter's bands
+    size_t nBands;
+  };
+
+  // a function per record type, those not set are skipped
+  struct visitor_t {
+    std::function<void(const flow_t&)> fFlow;
+    std::function<void(const group_t&)> fGroup;
+    std::function<void(const port_t&)> fPort;
+    std::function<void(const ofp141::ofp_table_stats&)> fTable;
+    std::function<void(const meter_t&)> fMeter;
+  };
+
+  // OFPMP_FLOW, OFPMP_GROUP, OFPMP_PORT_STATS, OFPMP_TABLE, OFPMP_METER; throws std::runtime_error for others
+  size_t RequestSize( ofp141::ofp_multipart_type );
+  void Request( vByte_t&, ofp141::ofp_multipart_type ); // the whole message, replaces the buffer's content
+
+  // one reply part, records are counted into nRecords;
+  //   false when a record does not fit the part, records before it have been visited
+  bool Decode( const ofp141::ofp_multipart_reply&, const uint8_t* pEnd, const visitor_t&, size_t& nRecords );
+
+  inline bool More( const ofp141::ofp_multipart_reply& msg ) {
+    return 0 != ( msg.flags & ofp141::ofp_multipart_reply_flags::OFPMPF_REPLY_MORE );
+  }
+
+} // namespace ofp_multipart
+} // namespace codec
+
+#endif /* OFP_MULTIPART_H */
@@ -14,9 +14,12 @@ namespace codec {
 namespace ofp_packet_out {
 
 void build(
-  vByte_t& vDestination, uint32_t nPort, size_t nOctets, void* src, ofp141::ofp_port_no portOutput
+  vByte_t& vDestination, uint32_t nPort, size_t nOctets, void* src, ofp141::ofp_port_no portOutput,
+  uint32_t buffer_id
 ) {
 
+  if ( OFP_NO_BUFFER != buffer_id ) nOctets = 0; // packet is held by the switch
+
   size_t size // need to check for packing and padding issues
     = sizeof( ofp_packet_out_ )
     + sizeof( ofp_action_output_ )
@@ -25,7 +28,7 @@ void build(
   vDestination.resize( size );
 
   auto* pOfpPacketOut = new( vDestination.data() ) ofp_packet_out_;
-  pOfpPacketOut->init( size, nPort );
+  pOfpPacketOut->init( size, nPort, buffer_id );
 
   // will need to loop this structure for multiple actions
   auto* pActionOutput = new( pOfpPacketOut->actions ) ofp_action_output_;
@@ -37,7 +40,9 @@ void build(
 
   auto* pPacket = new( pOfpPacketOut->actions ) uint8_t;
   pPacket += sizeof( ofp_action_output_ );
-  /* dest = */ std::memcpy( pPacket, src, nOctets );
+  if ( 0 != nOctets ) {
+    /* dest = */ std::memcpy( pPacket, src, nOctets );
+  }
 
 }
 
@@ -63,8 +63,10 @@ namespace ofp_packet_out { // page 129 v1.4.1 s7.3.6
     }
   };
 
+  // with a buffer_id, the switch supplies the packet, nOctets/pSrc are not appended
   void build( vByte_t&, uint32_t nPort, size_t nOctets, void* pSrc,
-              ofp141::ofp_port_no portOutput = ofp141::ofp_port_no::OFPP_ALL );
+              ofp141::ofp_port_no portOutput = ofp141::ofp_port_no::OFPP_ALL,
+              uint32_t buffer_id = OFP_NO_BUFFER );
 
 } // namespace ofp_packet_out
 } // namespace codec
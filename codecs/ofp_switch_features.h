@@ -22,6 +22,9 @@ public:
   ofp_switch_features( const ofp141::ofp_switch_features& packet );
   virtual ~ofp_switch_features( );
   
+  uint32_t Buffers() const { return m_packet.n_buffers; } // 0 when the switch does not buffer packet_in
+  uint64_t DatapathId() const { return m_packet.datapath_id; }
+
   static vByte_t CreateRequest( vByte_t );
 private:
 
@@ -10,12 +10,35 @@
 #ifndef COMMON_H
 #define COMMON_H
 
-#include <cstdint>
+#include <memory>
 #include <vector>
+#include <cstdint>
+#include <utility>
+#include <type_traits>
 
 typedef uint32_t nPort_t;  // switch port number
 
-typedef std::vector<uint8_t> vByte_t;  // rename to octet?
+// resize leaves new elements uninitialized: messages are laid over their octets,
+//   each structure's init() writes its padding, so zero filling first is wasted
+template<typename T, typename A = std::allocator<T> >
+class default_init_allocator: public A {
+  typedef std::allocator_traits<A> traits_t;
+public:
+  template<typename U> struct rebind {
+    typedef default_init_allocator<U, typename traits_t::template rebind_alloc<U> > other;
+  };
+  using A::A;
+  template<typename U>
+  void construct( U* p ) noexcept( std::is_nothrow_default_constructible<U>::value ) {
+    ::new( static_cast<void*>( p ) ) U;
+  }
+  template<typename U, typename... Args>
+  void construct( U* p, Args&&... args ) {
+    traits_t::construct( static_cast<A&>( *this ), p, std::forward<Args>( args )... );
+  }
+};
+
+typedef std::vector<uint8_t, default_init_allocator<uint8_t> > vByte_t;  // rename to octet?
 
 #endif /* COMMON_H */
 
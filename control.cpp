@@ -21,6 +21,7 @@
  */
 
 #include <memory>
+#include <vector>
 #include <iostream>
 
 #include <boost/asio/post.hpp>
@@ -35,17 +36,21 @@
 #include "tcp_session.h"
 #include "protocol/ethernet/address.h"
 
-Control::Control( int port )
+Control::Control( const options_t& options )
 :
-  m_port( port ),
+  m_port( options.port ),
+  m_bUseSwitchBuffers( options.bUseSwitchBuffers ),
   m_signals( m_ioContext, SIGINT, SIGTERM ),
   m_strandZmqRequest( m_ioContext ),
   m_zmqSocketRequest( m_zmqContext, zmq::socket_type::req ),  // TODO construct this in which strand?
   //m_ovsdb( m_ioContext, m_f ),
   m_socket( m_ioContext ),
-  m_acceptor( m_ioContext, ip::tcp::endpoint( ip::tcp::v4(), port ) ),
+  m_acceptor( m_ioContext, ip::tcp::endpoint( ip::tcp::v4(), options.port ) ),
   m_ioWork( asio::make_work_guard( m_ioContext ) )
 {
+  if ( !options.sRecorder.empty() ) {
+    m_pRecorder = std::make_unique<Recorder>( options.sRecorder, options.nRecorderFiles, options.nRecorderSegmentOctets );
+  }
 }
 
 Control::~Control() {
@@ -104,7 +109,9 @@ void Control::Start() {
     f.fInterfaceUpdate = std::bind( &Control::HandleInterfaceUpdate, this, ph::_1, ph::_2 );
     f.fInterfaceDelete = std::bind( &Control::HandleInterfaceDelete, this, ph::_1 );
 
-    f.fStatisticsUpdate = std::bind( &Control::HandleStatisticsUpdate, this, ph::_1, ph::_2 );
+    // interface statistics arrive over the OpenFlow session instead, see HandlePortStats,
+    //   with fStatisticsUpdate left unset, ovsdb does not monitor them
+    //f.fStatisticsUpdate = std::bind( &Control::HandleStatisticsUpdate, this, ph::_1, ph::_2 );
 
     ovsdb::decode m_ovsdb( m_ioContext, f );
 
@@ -124,7 +131,12 @@ void Control::AcceptControlConnections() {
     m_socket,
     [this](boost::system::error_code ec) {
       if (!ec) {
-        std::make_shared<tcp_session>(m_bridge, std::move(m_socket))->start();
+        auto pSession = std::make_shared<tcp_session>(m_bridge, std::move(m_socket), m_pRecorder.get());
+        pSession->SetUseSwitchBuffers( m_bUseSwitchBuffers );
+        pSession->SetPortStats(
+          std::chrono::milliseconds( port_stats_interval_ms ),
+          [this]( const PortStats::vCounters_t& vChanged ){ HandlePortStats( vChanged ); } );
+        pSession->start();
       }
 
       // once one port started, start another acceptance
@@ -460,6 +472,7 @@ void Control::HandleInterfaceAdd_local( const ovsdb::structures::uuidPort_t& uui
     setInterface_t::iterator iterSetInterface = port.setInterface.find( uuidInterface );
     if ( port.setInterface.end() == iterSetInterface ) {
       port.setInterface.insert( setInterface_t::value_type( uuidInterface ) );
+      std::lock_guard<std::mutex> lock( m_mutexInterface );
       mapInterface_t::iterator iterInterface = m_mapInterface.insert( m_mapInterface.begin(), mapInterface_t::value_type( uuidInterface, interface_composite_t() ) );
       assert( m_mapInterface.end() != iterInterface );
       iterInterface->second.uuidOwnerPort = uuidPort;
@@ -494,7 +507,19 @@ void Control::HandleInterfaceUpdate_local( const ovsdb::structures::uuidInterfac
   }
   else {
     interface_composite_t& interface_( iterInterface->second );
-    interface_.interface = interface;
+    {
+      std::lock_guard<std::mutex> lock( m_mutexInterface );
+      if ( interface_.interface.ofport != interface.ofport ) {
+        mapOfport_t::iterator iterOfport = m_mapOfport.find( interface_.interface.ofport );
+        if ( ( m_mapOfport.end() != iterOfport ) && ( uuidInterface == iterOfport->second ) ) {
+          m_mapOfport.erase( iterOfport );
+        }
+        if ( 0 != interface.ofport ) {
+          m_mapOfport[ interface.ofport ] = uuidInterface;
+        }
+      }
+      interface_.interface = interface;
+    }
 
     mapPort_t::const_iterator iterPort = m_mapPort.find( interface_.uuidOwnerPort );
     const ovsdb::structures::port_t& port( iterPort->second.port );
@@ -611,6 +636,11 @@ void Control::HandleInterfaceDelete_local( const ovsdb::structures::uuidInterfac
     assert( iterPort->second.setInterface.end() != iterSetInterface );
     iterPort->second.setInterface.erase( iterSetInterface );
 
+    std::lock_guard<std::mutex> lock( m_mutexInterface );
+    mapOfport_t::iterator iterOfport = m_mapOfport.find( iterMapInterface->second.interface.ofport );
+    if ( ( m_mapOfport.end() != iterOfport ) && ( uuidInterface == iterOfport->second ) ) {
+      m_mapOfport.erase( iterOfport );
+    }
     m_mapInterface.erase( iterMapInterface );
     BOOST_LOG_TRIVIAL(info) << "Control::HandleInterfaceDelete interface" << uuidInterface << " deleted";
   }
@@ -621,12 +651,53 @@ void Control::HandleInterfaceDelete_msg( const ovsdb::structures::uuidInterface_
 
 // ==
 
+// only the ports whose counters moved since the previous poll, published as ovsdb's statistics were
+//   called on the session's thread, the interfaces are looked up under m_mutexInterface,
+//   which is released before the statistics are stored and published
+void Control::HandlePortStats( const PortStats::vCounters_t& vChanged ) {
+
+  typedef std::pair<uuidInterface_t,ovsdb::structures::statistics_t> update_t;
+  std::vector<update_t> vUpdate;
+  vUpdate.reserve( vChanged.size() );
+
+  {
+    std::lock_guard<std::mutex> lock( m_mutexInterface );
+    for ( const PortStats::counters_t& counters: vChanged ) {
+      mapOfport_t::const_iterator iterOfport = m_mapOfport.find( counters.ofport );
+      if ( m_mapOfport.end() == iterOfport ) {
+        BOOST_LOG_TRIVIAL(trace) << "Control::HandlePortStats ofport " << counters.ofport << " has no interface";
+      }
+      else {
+        vUpdate.emplace_back( iterOfport->second, ovsdb::structures::statistics_t() );
+        ovsdb::structures::statistics_t& stats( vUpdate.back().second );
+        stats.collisions = counters.collisions;
+        stats.rx_bytes = counters.rx_bytes;
+        stats.rx_crc_err = counters.rx_crc_err;
+        stats.rx_dropped = counters.rx_dropped;
+        stats.rx_errors = counters.rx_errors;
+        stats.rx_frame_err = counters.rx_frame_err;
+        stats.rx_over_err = counters.rx_over_err;
+        stats.rx_packets = counters.rx_packets;
+        stats.tx_bytes = counters.tx_bytes;
+        stats.tx_dropped = counters.tx_dropped;
+        stats.tx_errors = counters.tx_errors;
+        stats.tx_packets = counters.tx_packets;
+      }
+    }
+  }
+
+  for ( const update_t& update: vUpdate ) {
+    HandleStatisticsUpdate( update.first, update.second );
+  }
+}
+
 void Control::HandleStatisticsUpdate( const ovsdb::structures::uuidInterface_t& uuidInterface, const ovsdb::structures::statistics_t& stats ) {
   HandleStatisticsUpdate_local( uuidInterface, stats );
   HandleStatisticsUpdate_msg( uuidInterface, stats );
 }
 
 void Control::HandleStatisticsUpdate_local( const ovsdb::structures::uuidInterface_t& uuidInterface, const ovsdb::structures::statistics_t& stats ) {
+  std::lock_guard<std::mutex> lock( m_mutexInterface );
   mapInterface_t::iterator iterInterface = m_mapInterface.find( uuidInterface );
   if ( m_mapInterface.end() == iterInterface ) {
     BOOST_LOG_TRIVIAL(warning) << "Control::HandleStatisticsUpdate interface " << uuidInterface << " does not exist";
@@ -9,6 +9,12 @@
 #ifndef CONTROL_H
 #define CONTROL_H
 
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+#include <string>
+
 #include <boost/asio/io_context.hpp>
 #include <boost/asio/ip/tcp.hpp>
 #include <boost/asio/strand.hpp>
@@ -20,6 +26,8 @@
 #include <zmq_addon.hpp>
 
 #include "bridge.h"
+#include "recorder.h"
+#include "port_stats.h"
 #include "ovsdb_structures.h"
 
 namespace asio = boost::asio;
@@ -27,7 +35,18 @@ namespace ip = asio::ip;
 
 class Control {
 public:
-  Control( int port );
+
+  struct options_t {
+    int port;
+    std::string sRecorder;         // flight recorder base path, <base>.<n>.ofrec, nothing is recorded when empty
+    size_t nRecorderFiles;         // segments rotated through
+    size_t nRecorderSegmentOctets; // per segment file
+    bool bUseSwitchBuffers;        // table misses leave the frame in the switch, only its head comes across
+    options_t()
+    : port( 6633 ), nRecorderFiles( 4 ), nRecorderSegmentOctets( 64 * 1024 * 1024 ), bUseSwitchBuffers( false ) {}
+  };
+
+  Control( const options_t& ); // throws std::runtime_error when a recorder is asked for and can not be created
   virtual ~Control();
   void Start();
 protected:
@@ -37,6 +56,9 @@ private:
   typedef std::unique_ptr<zmq::multipart_t> pMultipart_t;
 
   int m_port;
+  bool m_bUseSwitchBuffers;
+
+  std::unique_ptr<Recorder> m_pRecorder; // ahead of the io_context, sessions record until they are destroyed
 
   asio::io_context m_ioContext;
   asio::io_context::strand m_strandZmqRequest;  // strand for cppof->local messages
@@ -95,8 +117,14 @@ private:
   mapSwitch_t m_mapSwitch;
   mapBridge_t m_mapBridge;
   mapPort_t m_mapPort;
+  // m_mapInterface and m_mapOfport are shared with HandlePortStats, called on a session's thread,
+  //   the ovsdb handlers take m_mutexInterface while they change them
+  std::mutex m_mutexInterface;
   mapInterface_t m_mapInterface;
 
+  typedef std::map<size_t,uuidInterface_t> mapOfport_t; // ofport -> interface, as ovsdb assigned it
+  mapOfport_t m_mapOfport;
+
   void AcceptControlConnections();
 
   void PostToZmqRequest( pMultipart_t& );
@@ -149,6 +177,9 @@ private:
   void HandleInterfaceDelete_local( const ovsdb::structures::uuidInterface_t& );
   void HandleInterfaceDelete_msg( const ovsdb::structures::uuidInterface_t& );
 
+  enum { port_stats_interval_ms = 5000 }; // as ovs refreshes its statistics column
+  void HandlePortStats( const PortStats::vCounters_t& );
+
   void HandleStatisticsUpdate( const ovsdb::structures::uuidInterface_t&, const ovsdb::structures::statistics_t& );
   void HandleStatisticsUpdate_local( const ovsdb::structures::uuidInterface_t&, const ovsdb::structures::statistics_t& );
   void HandleStatisticsUpdate_msg( const ovsdb::structures::uuidInterface_t&, const ovsdb::structures::statistics_t& );
@@ -0,0 +1,121 @@
+/*
+ * File:   dispatcher.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 4:40 PM
+ */
+
+#include <cassert>
+#include <cstddef>
+#include <iostream>
+#include <stdexcept>
+
+#include "protocol/ethernet/vlan.h"
+
+#include "dispatcher.h"
+
+namespace {
+  // the frame follows the match, padded to 8 octets, and two octets of padding
+  size_t PayloadOffset( const ofp141::ofp_packet_in& msg ) {
+    return offsetof( ofp141::ofp_packet_in, match ) + ( ( msg.match.length + 7 ) / 8 ) * 8 + 2;
+  }
+  const size_t nEthernetHeader = 14;
+  const size_t nVlanTag = 4; // tci and the inner ethertype, following an ethertype of 0x8100
+}
+
+Dispatcher::packet_in_t::packet_in_t( ofp141::ofp_packet_in& msg_, const uint8_t* pEnd )
+: msg( msg_ ),
+  match( *new( &msg_.match ) codec::ofp_flow_mod::ofp_match_ ),
+  resultMatch( codec::ofp_match::Decode( msg_.match, pEnd, fields ) ),
+  pPayload( reinterpret_cast<uint8_t*>( &msg_ ) + PayloadOffset( msg_ ) ),
+  nCaptured( pEnd - pPayload ),
+  idBuffer( msg_.buffer_id ),
+  ethernet( *pPayload ),
+  idVlan( 0 ), idEtherType( 0 ), pMessage( nullptr )
+{
+  if ( protocol::ethernet::Ethertype::ieee8021q == ethernet.GetEthertype() ) {
+    ::ethernet::vlan vlan( ethernet.GetMessage() );
+    idVlan = vlan.GetVID();
+    pMessage = &vlan.GetMessage();
+    idEtherType = vlan.GetEthertype();
+  }
+  else {
+    pMessage = &ethernet.GetMessage();
+    idEtherType = ethernet.GetEthertype();
+  }
+}
+
+bool Dispatcher::packet_in_t::Valid( const ofp141::ofp_packet_in& msg, const uint8_t* pEnd ) {
+  const uint8_t* pBegin = reinterpret_cast<const uint8_t*>( &msg );
+  if ( 4 > msg.match.length ) return false; // the match header itself
+  const uint8_t* pPayload = pBegin + PayloadOffset( msg );
+  if ( ( pPayload + nEthernetHeader ) > pEnd ) return false; // ethernet header present
+  const uint16_t ethertype( ( pPayload[ 12 ] << 8 ) | pPayload[ 13 ] );
+  if ( protocol::ethernet::Ethertype::ieee8021q == ethertype ) {
+    return ( ( pPayload + nEthernetHeader + nVlanTag ) <= pEnd ); // the tag is read in the constructor
+  }
+  return true;
+}
+
+Dispatcher::Dispatcher() {}
+
+Dispatcher::~Dispatcher() {}
+
+void Dispatcher::Register( ofp141::ofp_type type, size_t nMinimum, fMessage_t fMessage ) {
+  if ( (size_t)nTypes <= (size_t)type ) {
+    throw std::runtime_error( "Dispatcher::Register type out of range" );
+  }
+  assert( sizeof( ofp141::ofp_header ) <= nMinimum );
+  type_t& entry( m_rType[ type ] );
+  entry.nMinimum = nMinimum;
+  entry.fMessage = std::move( fMessage );
+}
+
+void Dispatcher::RegisterCookie( uint64_t cookie, fPacketIn_t fPacketIn ) {
+  cookie_t& entry( m_rCookie[ cookie % nCookies ] );
+  if ( ( nullptr != entry.fPacketIn ) && ( cookie != entry.cookie ) ) {
+    throw std::runtime_error( "Dispatcher::RegisterCookie cookie collides in the table" );
+  }
+  entry.cookie = cookie;
+  entry.fPacketIn = std::move( fPacketIn );
+}
+
+void Dispatcher::RegisterCookieDefault( fPacketIn_t fPacketIn ) {
+  m_fCookieDefault = std::move( fPacketIn );
+}
+
+void Dispatcher::Dispatch( uint8_t* pBegin, const uint8_t* pEnd ) {
+  const auto pHeader = new( pBegin ) ofp141::ofp_header;
+  if ( OFP_VERSION != pHeader->version ) {
+    //std::cout << "Dispatcher no match on version: " << (uint16_t)pHeader->version << std::endl;
+    return;
+  }
+  const uint8_t type = pHeader->type;
+  if ( nTypes > type ) {
+    const type_t& entry( m_rType[ type ] );
+    if ( nullptr != entry.fMessage ) {
+      if ( (size_t)( pEnd - pBegin ) >= entry.nMinimum ) {
+        entry.fMessage( pBegin, pEnd );
+      }
+      else {
+        std::cout << "Dispatcher short message, type " << (uint16_t)type << ", length " << ( pEnd - pBegin ) << std::endl;
+      }
+      return;
+    }
+  }
+  std::cout << "Dispatcher unprocessed packet type: " << (uint16_t)type << std::endl;
+}
+
+void Dispatcher::Dispatch( packet_in_t& packet ) {
+  const uint64_t cookie = packet.msg.cookie;
+  const cookie_t& entry( m_rCookie[ cookie % nCookies ] );
+  if ( ( nullptr != entry.fPacketIn ) && ( cookie == entry.cookie ) ) {
+    entry.fPacketIn( packet );
+  }
+  else {
+    if ( nullptr != m_fCookieDefault ) {
+      m_fCookieDefault( packet );
+    }
+  }
+}
@@ -0,0 +1,105 @@
+/*
+ * File:   dispatcher.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 4:40 PM
+ */
+
+#ifndef DISPATCHER_H
+#define DISPATCHER_H
+
+#include <array>
+#include <memory>
+#include <cstdint>
+#include <functional>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "common.h"
+#include "codecs/ofp_match.h"
+#include "codecs/ofp_flow_mod.h"
+#include "protocol/ethernet.h"
+
+// Routes framed OpenFlow messages to handlers registered at session start:
+//   a dense table indexed by ofp_type, where version and minimum length are checked once
+//     before the single indirect call into the handler,
+//   and a second table, for OFPT_PACKET_IN, indexed by the cookie of the flow
+//     which sent the packet to the controller.
+
+class Dispatcher {
+public:
+
+  // packet_in with its frame located and the layer 2 headers peeled off
+  struct packet_in_t {
+    ofp141::ofp_packet_in& msg;
+    codec::ofp_flow_mod::ofp_match_& match;
+    codec::ofp_match::match_fields fields; // the match, decoded once on construction
+    codec::ofp_match::result_t resultMatch;
+    uint8_t* pPayload;    // ethernet frame
+    size_t nCaptured;     // octets present, less than msg.total_len when truncated by max_len
+    uint32_t idBuffer;    // OFP_NO_BUFFER when the switch has not kept the frame
+    protocol::ethernet::header ethernet;
+    uint16_t idVlan;      // 0 if no 802.1q header found (will need to deal with QinQ at some point)
+    uint16_t idEtherType; // of the encapsulated message
+    uint8_t* pMessage;    // after the ethernet and 802.1q headers
+    std::shared_ptr<const vByte_t> pHolder; // set when the message is held beyond the read, as by a pipeline job
+
+    packet_in_t( ofp141::ofp_packet_in&, const uint8_t* pEnd ); // requires Valid()
+    static bool Valid( const ofp141::ofp_packet_in&, const uint8_t* pEnd );
+    bool Complete() const { return nCaptured == msg.total_len; }
+    uint32_t InPort() const { // 0 when the match has no OFPXMT_OFB_IN_PORT
+      return fields.Has( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_IN_PORT ) ? fields.value.in_port : 0;
+    }
+  };
+
+  typedef std::function<void(uint8_t* pBegin, const uint8_t* pEnd)> fMessage_t;
+  typedef std::function<void(packet_in_t&)> fPacketIn_t;
+
+  Dispatcher();
+  virtual ~Dispatcher();
+
+  // T is the fixed portion of the message, anything shorter is rejected before f is called
+  template<typename T>
+  void Register( ofp141::ofp_type type, std::function<void(T&, const uint8_t* pEnd)> f ) {
+    Register( type, sizeof( T ),
+      [f]( uint8_t* pBegin, const uint8_t* pEnd ){
+        f( *new( pBegin ) T, pEnd );
+      } );
+  }
+  void Register( ofp141::ofp_type, size_t nMinimum, fMessage_t );
+
+  void RegisterCookie( uint64_t cookie, fPacketIn_t ); // cookie of a flow with an output to the controller
+  void RegisterCookieDefault( fPacketIn_t ); // for cookies without a handler
+
+  void Dispatch( uint8_t* pBegin, const uint8_t* pEnd ); // one framed message
+  void Dispatch( packet_in_t& ); // by cookie
+
+protected:
+private:
+
+  enum { nTypes = ofp141::ofp_type::OFPT_BUNDLE_ADD_MESSAGE + 1 };
+  enum { nCookies = 256 }; // indexed by the low octet, the full cookie is confirmed
+
+  struct type_t {
+    size_t nMinimum;
+    fMessage_t fMessage;
+    type_t(): nMinimum( 0 ) {}
+  };
+
+  struct cookie_t {
+    uint64_t cookie;
+    fPacketIn_t fPacketIn;
+    cookie_t(): cookie( 0 ) {}
+  };
+
+  std::array<type_t,nTypes> m_rType;
+  std::array<cookie_t,nCookies> m_rCookie;
+  fPacketIn_t m_fCookieDefault;
+
+  Dispatcher( const Dispatcher& ) = delete;
+
+};
+
+#endif /* DISPATCHER_H */
+
@@ -0,0 +1,157 @@
+/*
+ * File:   flow_index.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:35 AM
+ */
+
+#include <cassert>
+#include <cstring>
+#include <ostream>
+
+#include "flow_index.h"
+
+namespace {
+
+  uint64_t Mac48( const FlowIndex::mac_t& mac ) {
+    uint64_t value( 0 );
+    for ( size_t ix = 0; ix < sizeof( FlowIndex::mac_t ); ix++ ) value = ( value << 8 ) | mac[ ix ];
+    return value;
+  }
+
+  uint64_t Mix( uint64_t value ) { // splitmix64 finalizer
+    value ^= value >> 30; value *= 0xbf58476d1ce4e5b9ULL;
+    value ^= value >> 27; value *= 0x94d049bb133111ebULL;
+    value ^= value >> 31;
+    return value;
+  }
+
+} // namespace anon
+
+FlowIndex::key_t::key_t( uint64_t cookie_, uint32_t in_port_, uint16_t vlan_vid_, const mac_t& eth_src_, const mac_t& eth_dst_ )
+: cookie( cookie_ ), in_port( in_port_ ), vlan_vid( vlan_vid_ )
+{
+  std::memcpy( eth_src, eth_src_, sizeof( mac_t ) );
+  std::memcpy( eth_dst, eth_dst_, sizeof( mac_t ) );
+}
+
+bool FlowIndex::key_t::operator==( const key_t& rhs ) const {
+  return ( cookie == rhs.cookie ) && ( in_port == rhs.in_port ) && ( vlan_vid == rhs.vlan_vid )
+    && ( 0 == std::memcmp( eth_src, rhs.eth_src, sizeof( mac_t ) ) )
+    && ( 0 == std::memcmp( eth_dst, rhs.eth_dst, sizeof( mac_t ) ) );
+}
+
+FlowIndex::FlowIndex( size_t nCapacity )
+: m_vEntry( nCapacity ), m_mask( nCapacity - 1 ), m_nLive( 0 )
+{
+  assert( 0 == ( nCapacity & m_mask ) ); // power of two
+}
+
+FlowIndex::~FlowIndex() {}
+
+size_t FlowIndex::Hash( const key_t& key ) {
+  return Mix(
+      Mix( key.cookie ^ ( (uint64_t)key.in_port << 32 ) ^ key.vlan_vid )
+    ^ Mix( Mac48( key.eth_src ) ) ^ ( Mac48( key.eth_dst ) << 13 ) );
+}
+
+size_t FlowIndex::Locate( const key_t& key ) const {
+  size_t ix = Hash( key ) & m_mask;
+  while ( 0 != m_vEntry[ ix ].key.cookie ) {
+    if ( key == m_vEntry[ ix ].key ) return ix;
+    ix = ( ix + 1 ) & m_mask;
+  }
+  return m_vEntry.size();
+}
+
+// backward shift, so probes need no tombstones
+void FlowIndex::Remove( size_t ix ) {
+  size_t ixNext = ( ix + 1 ) & m_mask;
+  while ( 0 != m_vEntry[ ixNext ].key.cookie ) {
+    const size_t ixHome = Hash( m_vEntry[ ixNext ].key ) & m_mask;
+    // move the entry back if its home is not within (ix,ixNext]
+    if ( ( ( ixNext - ixHome ) & m_mask ) >= ( ( ixNext - ix ) & m_mask ) ) {
+      m_vEntry[ ix ] = m_vEntry[ ixNext ];
+      ix = ixNext;
+    }
+    ixNext = ( ixNext + 1 ) & m_mask;
+  }
+  m_vEntry[ ix ].key.cookie = 0;
+  m_nLive--;
+}
+
+void FlowIndex::Grow() {
+  std::vector<entry_t> vEntry( 2 * m_vEntry.size() );
+  vEntry.swap( m_vEntry );
+  m_mask = m_vEntry.size() - 1;
+  for ( const entry_t& entry: vEntry ) {
+    if ( 0 != entry.key.cookie ) {
+      size_t ix = Hash( entry.key ) & m_mask;
+      while ( 0 != m_vEntry[ ix ].key.cookie ) ix = ( ix + 1 ) & m_mask;
+      m_vEntry[ ix ] = entry;
+    }
+  }
+}
+
+bool FlowIndex::Insert( const key_t& key, clock_t::time_point tpInstalled ) {
+  assert( 0 != key.cookie );
+  size_t ix = Hash( key ) & m_mask;
+  while ( 0 != m_vEntry[ ix ].key.cookie ) {
+    if ( key == m_vEntry[ ix ].key ) {
+      m_vEntry[ ix ].tpInstalled = tpInstalled; // re-installed, the idle timer started over
+      return false;
+    }
+    ix = ( ix + 1 ) & m_mask;
+  }
+  m_vEntry[ ix ].key = key;
+  m_vEntry[ ix ].tpInstalled = tpInstalled;
+  m_nLive++;
+  m_stats.nInserted++;
+  if ( ( 2 * m_nLive ) > m_vEntry.size() ) Grow();
+  return true;
+}
+
+const FlowIndex::clock_t::time_point* FlowIndex::Find( const key_t& key ) const {
+  const size_t ix = Locate( key );
+  return ( m_vEntry.size() == ix ) ? nullptr : &m_vEntry[ ix ].tpInstalled;
+}
+
+bool FlowIndex::Removed( const key_t& key, uint64_t nPackets, uint64_t nBytes ) {
+  const size_t ix = Locate( key );
+  if ( m_vEntry.size() == ix ) {
+    m_stats.nUnknown++;
+    return false;
+  }
+  Remove( ix );
+  m_stats.nRemoved++;
+  m_stats.nPackets += nPackets;
+  m_stats.nBytes += nBytes;
+  return true;
+}
+
+bool FlowIndex::Drop( const key_t& key ) {
+  const size_t ix = Locate( key );
+  if ( m_vEntry.size() == ix ) return false;
+  Remove( ix );
+  m_stats.nDropped++;
+  return true;
+}
+
+void FlowIndex::Clear() {
+  for ( entry_t& entry: m_vEntry ) entry.key.cookie = 0;
+  m_stats.nDropped += m_nLive;
+  m_nLive = 0;
+}
+
+std::ostream& operator<<( std::ostream& os, const FlowIndex::stats_t& stats ) {
+  os
+    << "inserted=" << stats.nInserted
+    << ",removed=" << stats.nRemoved
+    << ",unknown=" << stats.nUnknown
+    << ",dropped=" << stats.nDropped
+    << ",packets=" << stats.nPackets
+    << ",bytes=" << stats.nBytes
+    ;
+  return os;
+}
@@ -0,0 +1,86 @@
+/*
+ * File:   flow_index.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 4:35 AM
+ */
+
+#ifndef FLOW_INDEX_H
+#define FLOW_INDEX_H
+
+#include <iosfwd>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
+// The flows the switch holds for us, as far as flow_removed messages tell:
+//   keyed by cookie and the match as installed, in_port, vlan_vid, eth_src and eth_dst,
+//   in an open addressed table (linear probing, backward shift on removal), doubled past half full,
+//   an entry is the key and when it was installed, 40 octets.
+// Packet and byte totals are taken from each flow_removed as its flow leaves.
+// Not locked, the owner serializes.
+
+class FlowIndex {
+public:
+
+  typedef std::chrono::steady_clock clock_t;
+  typedef uint8_t mac_t[ 6 ];
+
+  struct key_t {
+    uint64_t cookie;   // not 0, which marks a vacancy
+    uint32_t in_port;
+    uint16_t vlan_vid; // as matched: OFPVID_NONE when untagged, otherwise with OFPVID_PRESENT
+    mac_t eth_src;
+    mac_t eth_dst;
+    key_t( uint64_t cookie_, uint32_t in_port_, uint16_t vlan_vid_, const mac_t& eth_src_, const mac_t& eth_dst_ );
+    key_t(): cookie( 0 ), in_port( 0 ), vlan_vid( 0 ), eth_src{}, eth_dst{} {}
+    bool operator==( const key_t& ) const;
+  };
+
+  struct stats_t {
+    uint64_t nInserted;
+    uint64_t nRemoved;  // by flow_removed
+    uint64_t nUnknown;  // flow_removed for a flow not in the index
+    uint64_t nDropped;  // taken out without a flow_removed
+    uint64_t nPackets;  // over the removed flows
+    uint64_t nBytes;
+    stats_t(): nInserted( 0 ), nRemoved( 0 ), nUnknown( 0 ), nDropped( 0 ), nPackets( 0 ), nBytes( 0 ) {}
+  };
+
+  FlowIndex( size_t nCapacity = 1024 ); // power of two
+  virtual ~FlowIndex();
+
+  bool Insert( const key_t&, clock_t::time_point tpInstalled ); // false, with tpInstalled refreshed, when already live
+  const clock_t::time_point* Find( const key_t& ) const; // when installed, nullptr when not live
+  bool Removed( const key_t&, uint64_t nPackets, uint64_t nBytes ); // from a flow_removed, false when not live
+  bool Drop( const key_t& ); // no longer believed live, as when a packet_in says otherwise
+  void Clear(); // the switch's tables are started over
+
+  size_t Size() const { return m_nLive; }
+  const stats_t& Stats() const { return m_stats; }
+
+protected:
+private:
+
+  struct entry_t {
+    key_t key;
+    clock_t::time_point tpInstalled;
+  };
+
+  std::vector<entry_t> m_vEntry;
+  size_t m_mask;
+  size_t m_nLive;
+
+  stats_t m_stats;
+
+  static size_t Hash( const key_t& );
+  size_t Locate( const key_t& ) const; // index, or m_vEntry.size() when absent
+  void Remove( size_t ix );
+  void Grow();
+
+};
+
+std::ostream& operator<<( std::ostream&, const FlowIndex::stats_t& );
+
+#endif /* FLOW_INDEX_H */
@@ -0,0 +1,206 @@
+/*
+ * File:   flow_templates.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 2:05 AM
+ */
+
+#include <cassert>
+#include <cstring>
+
+#include <boost/endian/conversion.hpp>
+
+#include "codecs/builder.h"
+#include "codecs/ofp_header.h"
+#include "codecs/ofp_flow_mod.h"
+#include "codecs/ofp_group_mod.h"
+#include "codecs/ofp_packet_out.h"
+
+#include "flow_templates.h"
+
+namespace {
+
+  namespace fm = codec::ofp_flow_mod;
+
+  typedef ofp::Match<fm::ofpxmt_ofb_in_port_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_eth_mac_, fm::ofpxmt_ofb_vlan_vid_> matchUnicast_t;
+
+  typedef ofp::Actions<fm::ofp_action_output_> actionsOutput_t;
+  typedef ofp::Actions<fm::ofp_action_pop_vlan_, fm::ofp_action_output_> actionsPopOutput_t;
+  typedef ofp::Actions<fm::ofp_action_push_vlan_, fm::ofp_action_set_field_vlan_id_, fm::ofp_action_output_> actionsPushOutput_t;
+
+  const size_t rEgressOctets[ FlowTemplates::nEgress ] = { actionsOutput_t::size, actionsPushOutput_t::size, actionsPopOutput_t::size };
+
+  uint16_t Offset( const vByte_t& v, const void* p ) {
+    return reinterpret_cast<const uint8_t*>( p ) - v.data();
+  }
+
+} // namespace anon
+
+FlowTemplates::FlowTemplates( const flow_t& flow )
+: m_cookie( flow.cookie )
+{
+
+  for ( size_t ix = 0; ix < nShapes; ix++ ) {
+    const Shape shape( (Shape)ix );
+    const Egress egress( ToEgress( shape ) );
+    const bool bSrcAccess( ( access_access == shape ) || ( access_trunk == shape ) );
+    template_t& t( m_rFlowMod[ shape ] );
+
+    const size_t nOctets( ofp::FlowModSize<matchUnicast_t>( rEgressOctets[ egress ] ) );
+    ofp::Builder build( t.v, nOctets );
+
+    auto* pFlowMod = build.Append<fm::ofp_flow_mod_>();
+    pFlowMod->init();
+    pFlowMod->idle_timeout = flow.idle_timeout;
+    pFlowMod->cookie = flow.cookie;
+    pFlowMod->priority = flow.priority;
+    pFlowMod->flags = flow.flags;
+    pFlowMod->header.length = nOctets;
+    t.ixXid = Offset( t.v, &pFlowMod->header.xid );
+
+    build.Seek( pFlowMod->match.oxm_fields ); // the fields take the place of ofp_match.pad
+
+    auto* pMatchInPort = build.Append<fm::ofpxmt_ofb_in_port_>();
+    pMatchInPort->init( 0 );
+    t.ixInPort = Offset( t.v, &pMatchInPort->port );
+
+    const fm::mac_t macNone = { 0, 0, 0, 0, 0, 0 };
+
+    auto* pMatchDstMac = build.Append<fm::ofpxmt_ofb_eth_mac_>();
+    pMatchDstMac->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_DST, macNone );
+    t.ixEthDst = Offset( t.v, &pMatchDstMac->mac );
+
+    auto* pMatchSrcMac = build.Append<fm::ofpxmt_ofb_eth_mac_>();
+    pMatchSrcMac->init( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_ETH_SRC, macNone );
+    t.ixEthSrc = Offset( t.v, &pMatchSrcMac->mac );
+
+    auto* pMatchVlan = build.Append<fm::ofpxmt_ofb_vlan_vid_>();
+    if ( bSrcAccess ) {
+      pMatchVlan->init(); // untagged
+    }
+    else {
+      pMatchVlan->init( 0 );
+      t.ixVlanMatch = Offset( t.v, &pMatchVlan->vlan );
+    }
+
+    pFlowMod->match.length = matchUnicast_t::length;
+    build.Pad( matchUnicast_t::size - matchUnicast_t::length );
+
+    auto* pActions = build.Append<fm::ofp_instruction_actions_>();
+    pActions->init();
+    pActions->len = sizeof( ofp141::ofp_instruction_actions ) + rEgressOctets[ egress ];
+
+    EncodeEgress( build, egress, t );
+    assert( build.Complete() );
+  }
+
+  for ( size_t ix = 0; ix < nEgress; ix++ ) {
+    const Egress egress( (Egress)ix );
+
+    {
+      template_t& t( m_rPacketOut[ egress ] );
+      const size_t nOctets( ofp::PacketOutSize( rEgressOctets[ egress ] ) );
+      ofp::Builder build( t.v, nOctets );
+
+      auto* pOut = build.Append<codec::ofp_packet_out::ofp_packet_out_>();
+      pOut->initv2( 0 );
+      pOut->actions_len = rEgressOctets[ egress ];
+      t.ixXid = Offset( t.v, &pOut->header.xid );
+      t.ixInPort = Offset( t.v, &pOut->in_port );
+
+      EncodeEgress( build, egress, t );
+      assert( build.Complete() );
+    }
+
+    {
+      template_t& t( m_rBucket[ egress ] );
+      const size_t nOctets( ofp::BucketSize( rEgressOctets[ egress ] ) );
+      ofp::Builder build( t.v, nOctets );
+
+      auto* pBucket = build.Append<codec::ofp_group_mod::ofp_bucket_>();
+      pBucket->init();
+      pBucket->len = nOctets;
+
+      EncodeEgress( build, egress, t );
+      assert( build.Complete() );
+    }
+  }
+}
+
+FlowTemplates::~FlowTemplates() {}
+
+// vlan tag handling between the ingress and the egress port, then the output,
+//   the same for the flow_mod's instruction, a packet_out's action list and a group's bucket
+void FlowTemplates::EncodeEgress( ofp::Builder& build, Egress egress, template_t& t ) {
+
+  switch ( egress ) {
+    case pass:
+      break;
+    case push: { // attach the 802.1q header
+      auto* pActionPushVlan = build.Append<fm::ofp_action_push_vlan_>();
+      pActionPushVlan->init( 0x8100 );
+
+      auto* pActionSetVlan  = build.Append<fm::ofp_action_set_field_vlan_id_>();
+      pActionSetVlan->init( 0 );
+      auto* pVid = reinterpret_cast<fm::ofpxmt_ofb_vlan_vid_*>( pActionSetVlan->field );
+      t.ixVlanSet = Offset( t.v, &pVid->vlan );
+      }
+      break;
+    case pop: {
+      auto* pAction = build.Append<fm::ofp_action_pop_vlan_>();
+      pAction->init();
+      }
+      break;
+    case nEgress:
+      assert( false );
+      break;
+  }
+
+  auto* pOutput = build.Append<fm::ofp_action_output_>();
+  pOutput->init( 0 );
+  t.ixOutput = Offset( t.v, &pOutput->port );
+}
+
+// fields common to all templates
+uint8_t* FlowTemplates::Copy( ofp::Builder& build, const template_t& t, ofport_t ofportOut ) {
+  uint8_t* p = build.Copy( t.v );
+  if ( 0 != t.ixXid ) {
+    codec::ofp_header::NewXid( *reinterpret_cast<codec::ofp_header::ofp_header_*>( p ) );
+  }
+  boost::endian::store_big_u32( p + t.ixOutput, ofportOut );
+  return p;
+}
+
+void FlowTemplates::FlowMod(
+  ofp::Builder& build, Shape shape, ofport_t ofportIn, idVlan_t idVlan, const mac_t& macSrc, const mac_t& macDst, ofport_t ofportOut
+) const {
+  const template_t& t( m_rFlowMod[ shape ] );
+  uint8_t* p = Copy( build, t, ofportOut );
+  boost::endian::store_big_u32( p + t.ixInPort, ofportIn );
+  std::memcpy( p + t.ixEthDst, macDst, sizeof( mac_t ) );
+  std::memcpy( p + t.ixEthSrc, macSrc, sizeof( mac_t ) );
+  if ( 0 != t.ixVlanMatch ) {
+    boost::endian::store_big_u16( p + t.ixVlanMatch, idVlan | ofp141::ofp_vlan_id::OFPVID_PRESENT );
+  }
+  if ( 0 != t.ixVlanSet ) {
+    boost::endian::store_big_u16( p + t.ixVlanSet, idVlan | ofp141::ofp_vlan_id::OFPVID_PRESENT );
+  }
+}
+
+void FlowTemplates::PacketOut( ofp::Builder& build, Egress egress, ofport_t ofportIn, idVlan_t idVlan, ofport_t ofportOut ) const {
+  const template_t& t( m_rPacketOut[ egress ] );
+  uint8_t* p = Copy( build, t, ofportOut );
+  boost::endian::store_big_u32( p + t.ixInPort, ofportIn );
+  if ( 0 != t.ixVlanSet ) {
+    boost::endian::store_big_u16( p + t.ixVlanSet, idVlan | ofp141::ofp_vlan_id::OFPVID_PRESENT );
+  }
+}
+
+void FlowTemplates::Bucket( ofp::Builder& build, Egress egress, idVlan_t idVlan, ofport_t ofportOut ) const {
+  const template_t& t( m_rBucket[ egress ] );
+  uint8_t* p = Copy( build, t, ofportOut );
+  if ( 0 != t.ixVlanSet ) {
+    boost::endian::store_big_u16( p + t.ixVlanSet, idVlan | ofp141::ofp_vlan_id::OFPVID_PRESENT );
+  }
+}
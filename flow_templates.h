@@ -0,0 +1,102 @@
+/*
+ * File:   flow_templates.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 2:05 AM
+ */
+
+#ifndef FLOW_TEMPLATES_H
+#define FLOW_TEMPLATES_H
+
+#include <array>
+#include <cstdint>
+
+#include "common.h"
+#include "protocol/ethernet/address.h"
+
+namespace ofp {
+  class Builder;
+}
+
+// The bridge's learned pair flow_mods, their direct packet_outs and its flood group buckets,
+//   encoded once per shape when constructed:
+//   a new message is a copy of its template's octets, then a big endian store for each field
+//   that varies ( xid, in_port, the macs, the vlan, the output port ).
+// Shapes follow the vlan handling from ingress to egress,
+//   access to access and trunk to trunk pass the frame, access to trunk pushes a tag, trunk to access pops it.
+
+class FlowTemplates {
+public:
+
+  typedef uint32_t ofport_t;
+  typedef uint16_t idVlan_t;
+  typedef protocol::ethernet::address_t mac_t;
+
+  enum Shape { access_access, access_trunk, trunk_access, trunk_trunk, nShapes };
+  enum Egress { pass, push, pop, nEgress };
+
+  // bDstUntagged: the egress port carries the vlan untagged, as an access or native port
+  static Shape ToShape( bool bSrcAccess, bool bDstUntagged ) {
+    return bSrcAccess
+      ? ( bDstUntagged ? access_access : access_trunk )
+      : ( bDstUntagged ? trunk_access : trunk_trunk );
+  }
+  static Egress ToEgress( Shape shape ) {
+    static const Egress rEgress[ nShapes ] = { pass, push, pop, pass };
+    return rEgress[ shape ];
+  }
+
+  struct flow_t { // the learned pair flow's settings
+    uint64_t cookie;
+    uint16_t priority;
+    uint16_t idle_timeout;
+    uint16_t flags; // ofp141::ofp_flow_mod_flags
+  };
+
+  FlowTemplates( const flow_t& );
+  virtual ~FlowTemplates();
+
+  uint64_t Cookie() const { return m_cookie; }
+
+  size_t FlowModSize( Shape shape ) const { return m_rFlowMod[ shape ].v.size(); }
+  void FlowMod(
+    ofp::Builder&, Shape, ofport_t ofportIn, idVlan_t, const mac_t& macSrc, const mac_t& macDst, ofport_t ofportOut ) const;
+
+  // buffer_id and the length are left to the sender, who knows about the payload
+  size_t PacketOutSize( Egress egress ) const { return m_rPacketOut[ egress ].v.size(); }
+  void PacketOut( ofp::Builder&, Egress, ofport_t ofportIn, idVlan_t, ofport_t ofportOut ) const;
+
+  size_t BucketSize( Egress egress ) const { return m_rBucket[ egress ].v.size(); }
+  void Bucket( ofp::Builder&, Egress, idVlan_t, ofport_t ofportOut ) const;
+
+protected:
+private:
+
+  const uint64_t m_cookie;
+
+  struct template_t {
+    vByte_t v;
+    // offsets into v, 0 when the template has no such field ( 0 is ofp_header.version )
+    uint16_t ixXid;
+    uint16_t ixInPort;
+    uint16_t ixEthDst;
+    uint16_t ixEthSrc;
+    uint16_t ixVlanMatch; // trunk ingress only, access ingress matches OFPVID_NONE
+    uint16_t ixVlanSet;   // push only
+    uint16_t ixOutput;
+    template_t(): ixXid( 0 ), ixInPort( 0 ), ixEthDst( 0 ), ixEthSrc( 0 ), ixVlanMatch( 0 ), ixVlanSet( 0 ), ixOutput( 0 ) {}
+  };
+
+  std::array<template_t,nShapes> m_rFlowMod;
+  std::array<template_t,nEgress> m_rPacketOut;
+  std::array<template_t,nEgress> m_rBucket;
+
+  static void EncodeEgress( ofp::Builder&, Egress, template_t& );
+  static uint8_t* Copy( ofp::Builder&, const template_t&, ofport_t ofportOut );
+
+  FlowTemplates( const FlowTemplates& ) = delete;
+
+};
+
+#endif /* FLOW_TEMPLATES_H */
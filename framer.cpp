@@ -0,0 +1,143 @@
+/*
+ * File:   framer.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 10:30 AM
+ */
+
+#include <atomic>
+#include <cassert>
+#include <cstring>
+#include <ostream>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "framer.h"
+
+Framer::Framer( size_t nCapacity, size_t nSlabsMaximum )
+: m_nCapacity( nCapacity ), m_nSlabsMaximum( nSlabsMaximum ),
+  m_ixBegin( 0 ), m_ixEnd( 0 )
+{
+  // a maximum sized message has to fit, with room left over for the following read
+  assert( ( 0xffff + nMinimumTail ) <= nCapacity );
+  assert( 1 <= nSlabsMaximum );
+  m_pSlab = std::make_shared<vByte_t>( m_nCapacity );
+  m_vSlab.push_back( m_pSlab );
+}
+
+Framer::~Framer() {}
+
+bool Framer::Commit( size_t nOctets, fMessage_t f ) {
+
+  assert( nOctets <= TailSize() );
+
+  m_ixEnd += nOctets;
+  m_stats.nReads++;
+  m_stats.nOctetsRead += nOctets;
+
+  size_t nOctetsRequired( sizeof( ofp141::ofp_header ) ); // to complete the message at m_ixBegin
+
+  bool bLooping( true );
+  while ( bLooping ) {
+    const size_t nOctetsAvailable = m_ixEnd - m_ixBegin;
+    if ( sizeof( ofp141::ofp_header ) > nOctetsAvailable ) {
+      nOctetsRequired = sizeof( ofp141::ofp_header );
+      bLooping = false;
+    }
+    else {
+      uint8_t* pBegin = m_pSlab->data() + m_ixBegin;
+      const auto pHeader = new( pBegin ) ofp141::ofp_header;
+      const size_t length = pHeader->length;
+      if ( sizeof( ofp141::ofp_header ) > length ) {
+        return false;
+      }
+      if ( length > nOctetsAvailable ) {
+        nOctetsRequired = length;
+        bLooping = false;
+      }
+      else {
+        f( pBegin, pBegin + length );
+        m_ixBegin += length;
+        m_stats.nMessages++;
+      }
+    }
+  }
+
+  if ( nullptr != m_pSlabNext ) { // the slab has been lent, move on
+    Swap();
+  }
+  else {
+    if ( m_ixBegin == m_ixEnd ) { // everything consumed, rewind without copying
+      m_ixBegin = m_ixEnd = 0;
+    }
+    else {
+      Compact( nOctetsRequired );
+    }
+  }
+
+  return true;
+}
+
+Framer::pSlab_t Framer::Lend() {
+  if ( nullptr == m_pSlabNext ) {
+    // a spare is referenced only by m_vSlab
+    for ( const pSlabWritable_t& pSlab: m_vSlab ) {
+      if ( ( pSlab != m_pSlab ) && ( 1 == pSlab.use_count() ) ) {
+        std::atomic_thread_fence( std::memory_order_acquire ); // holders are done reading
+        m_pSlabNext = pSlab;
+        break;
+      }
+    }
+    if ( nullptr == m_pSlabNext ) {
+      if ( m_nSlabsMaximum > m_vSlab.size() ) {
+        m_pSlabNext = std::make_shared<vByte_t>( m_nCapacity );
+        m_vSlab.push_back( m_pSlabNext );
+      }
+      else {
+        return nullptr;
+      }
+    }
+  }
+  m_stats.nLent++;
+  return m_pSlab;
+}
+
+void Framer::Swap() {
+  const size_t nOctets = m_ixEnd - m_ixBegin;
+  if ( 0 != nOctets ) {
+    std::memcpy( m_pSlabNext->data(), m_pSlab->data() + m_ixBegin, nOctets );
+    m_stats.nOctetsCopied += nOctets;
+  }
+  m_pSlab = std::move( m_pSlabNext );
+  m_pSlabNext.reset();
+  m_ixBegin = 0;
+  m_ixEnd = nOctets;
+  m_stats.nSwaps++;
+}
+
+void Framer::Compact( size_t nOctetsRequired ) {
+  const size_t nRoom = m_pSlab->size() - m_ixBegin; // room for the partial message to complete in place
+  if ( ( 0 != m_ixBegin ) && ( ( nRoom < nOctetsRequired ) || ( TailSize() < nMinimumTail ) ) ) {
+    const size_t nOctets = m_ixEnd - m_ixBegin;
+    std::memmove( m_pSlab->data(), m_pSlab->data() + m_ixBegin, nOctets );
+    m_ixBegin = 0;
+    m_ixEnd = nOctets;
+    m_stats.nCompactions++;
+    m_stats.nOctetsCopied += nOctets;
+  }
+}
+
+std::ostream& operator<<( std::ostream& os, const Framer::stats_t& stats ) {
+  os
+    << "reads=" << stats.nReads
+    << ",octets=" << stats.nOctetsRead
+    << ",messages=" << stats.nMessages
+    << ",compactions=" << stats.nCompactions
+    << ",copied=" << stats.nOctetsCopied
+    << ",lent=" << stats.nLent
+    << ",swaps=" << stats.nSwaps
+    << ",copied/message=" << stats.CopiedPerMessage()
+    ;
+  return os;
+}
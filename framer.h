@@ -0,0 +1,98 @@
+/*
+ * File:   framer.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 10:30 AM
+ */
+
+#ifndef FRAMER_H
+#define FRAMER_H
+
+#include <iosfwd>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "common.h"
+
+// Frames inbound OpenFlow messages from a byte stream.
+//   socket reads land directly in the free tail of a single contiguous slab,
+//   complete messages are handed out in place as [begin,end) spans,
+//   a trailing partial message stays where it is and is only moved (compacted)
+//   to the front of the slab when there is not enough room behind it to complete.
+// A message handler may Lend() the current slab, so a payload can be transmitted
+//   straight out of the receive buffer.  At the end of that pass, the framer moves
+//   on to a spare slab (carrying over any partial tail) and the lent slab is only
+//   re-used once every holder has let go of it.
+
+class Framer {
+public:
+
+  typedef std::function<void(uint8_t* pBegin, const uint8_t* pEnd)> fMessage_t;
+
+  struct stats_t {
+    uint64_t nReads;        // socket reads committed
+    uint64_t nOctetsRead;   // octets committed
+    uint64_t nMessages;     // complete messages handed out
+    uint64_t nCompactions;  // partial tails moved to the front of the slab
+    uint64_t nOctetsCopied; // octets moved by compactions and slab swaps
+    uint64_t nLent;         // messages whose slab was lent out
+    uint64_t nSwaps;        // moves to a spare slab after lending
+    stats_t()
+    : nReads( 0 ), nOctetsRead( 0 ), nMessages( 0 ), nCompactions( 0 ), nOctetsCopied( 0 ),
+      nLent( 0 ), nSwaps( 0 )
+    {}
+    double CopiedPerMessage() const { return ( 0 == nMessages ) ? 0.0 : (double)nOctetsCopied / nMessages; }
+  };
+
+  typedef std::shared_ptr<const vByte_t> pSlab_t;
+
+  Framer( size_t nCapacity, size_t nSlabsMaximum = 8 );
+  virtual ~Framer();
+
+  uint8_t* Tail() { return m_pSlab->data() + m_ixEnd; } // where the next read should land
+  size_t TailSize() const { return m_pSlab->size() - m_ixEnd; }
+
+  // account for nOctets read into Tail(), then call f for each complete message;
+  //   false when a length field is shorter than the header, the stream can not be framed past it
+  bool Commit( size_t nOctets, fMessage_t f );
+
+  // only from within f: shares ownership of the slab holding the current message,
+  //   nullptr when all slabs are still held elsewhere, in which case the caller copies
+  pSlab_t Lend();
+
+  const stats_t& Stats() const { return m_stats; }
+
+protected:
+private:
+
+  static const size_t nMinimumTail = 4096; // compact sooner rather than issue tiny reads
+
+  typedef std::shared_ptr<vByte_t> pSlabWritable_t;
+  typedef std::vector<pSlabWritable_t> vSlab_t;
+
+  const size_t m_nCapacity;
+  const size_t m_nSlabsMaximum;
+
+  vSlab_t m_vSlab;          // every slab owned, current, spare, or lent
+  pSlabWritable_t m_pSlab;  // receiving
+  pSlabWritable_t m_pSlabNext; // spare picked by Lend(), switched to at the end of the pass
+
+  size_t m_ixBegin; // first octet of the unprocessed region
+  size_t m_ixEnd;   // one past the last octet read
+
+  stats_t m_stats;
+
+  void Compact( size_t nOctetsRequired );
+  void Swap();
+
+  Framer( const Framer& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const Framer::stats_t& );
+
+#endif /* FRAMER_H */
+
@@ -0,0 +1,426 @@
+/*
+ * File:   logging.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 8:20 PM
+ */
+
+#include <ctime>
+#include <cassert>
+#include <mutex>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <iomanip>
+#include <ostream>
+#include <iostream>
+#include <algorithm>
+#include <condition_variable>
+
+#include "logging.h"
+
+namespace logging {
+
+std::atomic<uint8_t> levelEnabled( trace );
+
+namespace {
+
+  const char* rszLevel[] = { "trace", "debug", "info", "warning", "error" };
+
+  // record layout, native byte order, only ever read back in this process
+  struct record_header_t {
+    uint32_t nOctets; // whole record, this header included
+    uint64_t ns;      // system clock, since the epoch
+    uint8_t level;
+    uint8_t nArgs;
+    uint8_t bTruncated;
+    const char* format;
+  };
+  const size_t nRecordHeader
+    = sizeof( uint32_t ) + sizeof( uint64_t ) + 3 * sizeof( uint8_t ) + sizeof( const char* );
+
+  // single producer (the logging thread), single consumer (the background thread),
+  //   records are copied in and out whole, wrapping around the end as needed
+  class ring_t {
+  public:
+
+    enum { nCapacity = 256 * 1024 }; // power of two
+
+    ring_t( uint32_t idThread_ )
+    : idThread( idThread_ ), nDropped( 0 ), bRetired( false ),
+      m_pOctets( new uint8_t[ nCapacity ] ),
+      m_ixHead( 0 ), m_ixTail( 0 ), m_ixHeadCached( 0 )
+    {}
+
+    const uint32_t idThread;
+    std::atomic<uint64_t> nDropped;
+    std::atomic<bool> bRetired; // its thread has exited, the background thread frees it once drained
+
+    bool Push( const uint8_t* p, size_t n ) {
+      const size_t ixTail = m_ixTail.load( std::memory_order_relaxed );
+      if ( ( nCapacity - ( ixTail - m_ixHeadCached ) ) < n ) {
+        m_ixHeadCached = m_ixHead.load( std::memory_order_acquire );
+        if ( ( nCapacity - ( ixTail - m_ixHeadCached ) ) < n ) return false;
+      }
+      Copy( ixTail, p, n );
+      m_ixTail.store( ixTail + n, std::memory_order_release );
+      return true;
+    }
+
+    // appends the next record to v, returns false when there is none
+    bool Pop( std::vector<uint8_t>& v ) {
+      const size_t ixHead = m_ixHead.load( std::memory_order_relaxed );
+      if ( ixHead == m_ixTail.load( std::memory_order_acquire ) ) return false;
+      uint32_t nOctets;
+      Copy( reinterpret_cast<uint8_t*>( &nOctets ), ixHead, sizeof( nOctets ) );
+      const size_t ix = v.size();
+      v.resize( ix + nOctets );
+      Copy( v.data() + ix, ixHead, nOctets );
+      m_ixHead.store( ixHead + nOctets, std::memory_order_release );
+      return true;
+    }
+
+  private:
+
+    typedef char pad_t[ 64 ];
+
+    const std::unique_ptr<uint8_t[]> m_pOctets;
+    pad_t m_pad0;
+    std::atomic<size_t> m_ixHead;
+    pad_t m_pad1;
+    std::atomic<size_t> m_ixTail;
+    size_t m_ixHeadCached;
+    pad_t m_pad2;
+
+    void Copy( size_t ixTo, const uint8_t* p, size_t n ) {
+      const size_t ix = ixTo & ( nCapacity - 1 );
+      const size_t n1 = std::min( n, nCapacity - ix );
+      std::memcpy( m_pOctets.get() + ix, p, n1 );
+      std::memcpy( m_pOctets.get(), p + n1, n - n1 );
+    }
+
+    void Copy( uint8_t* pTo, size_t ixFrom, size_t n ) const {
+      const size_t ix = ixFrom & ( nCapacity - 1 );
+      const size_t n1 = std::min( n, nCapacity - ix );
+      std::memcpy( pTo, m_pOctets.get() + ix, n1 );
+      std::memcpy( pTo + n1, m_pOctets.get(), n - n1 );
+    }
+
+  };
+
+  typedef std::shared_ptr<ring_t> pRing_t;
+
+  class sink_t {
+  public:
+
+    sink_t()
+    : m_pOut( &std::cout ), m_nRegistered( 0 ), m_nDroppedRetired( 0 ),
+      m_bStop( false ), m_nGeneration( 0 ), m_nWritten( 0 ), m_nDropped( 0 )
+    {
+      m_thread = std::thread( [this](){ Run(); } );
+    }
+
+    ~sink_t() {
+      m_bStop = true;
+      Wake();
+      m_thread.join(); // the final pass drains what is left
+    }
+
+    pRing_t Register() {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      pRing_t pRing = std::make_shared<ring_t>( m_nRegistered++ );
+      m_vRing.push_back( pRing );
+      m_nGeneration++;
+      return pRing;
+    }
+
+    // from a thread on its way out, its ring is drained then freed
+    void Retire( const pRing_t& pRing ) {
+      pRing->bRetired.store( true, std::memory_order_release );
+      Wake();
+    }
+
+    void SetOutput( std::ostream& os ) {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      m_pOut = &os;
+    }
+
+    stats_t Stats() {
+      std::lock_guard<std::mutex> lock( m_mutex );
+      stats_t stats;
+      stats.nWritten = m_nWritten.load( std::memory_order_relaxed );
+      stats.nDropped = m_nDroppedRetired;
+      for ( const pRing_t& pRing: m_vRing ) stats.nDropped += pRing->nDropped.load( std::memory_order_relaxed );
+      stats.nThreads = m_vRing.size();
+      return stats;
+    }
+
+  private:
+
+    struct entry_t {
+      uint64_t ns;
+      size_t ix; // into the pass's octets
+      uint32_t idThread;
+    };
+
+    enum { idle_wait_max_ms = 64 }; // with every ring empty, the wait doubles from 1ms to this
+
+    std::mutex m_mutex; // ring registration and output selection
+    std::ostream* m_pOut;
+    std::vector<pRing_t> m_vRing;
+    uint32_t m_nRegistered;     // rings ever registered, for thread ids
+    uint64_t m_nDroppedRetired; // drops counted by rings since freed
+    std::mutex m_mutexWake;
+    std::condition_variable m_cvWake; // producers do not signal, only stop and retirement
+    std::atomic<bool> m_bStop;
+    std::atomic<uint32_t> m_nGeneration;
+    std::atomic<uint64_t> m_nWritten;
+    uint64_t m_nDropped; // as last reported
+    std::thread m_thread;
+
+    void Wake() {
+      std::lock_guard<std::mutex> lock( m_mutexWake );
+      m_cvWake.notify_one();
+    }
+
+    void Run() {
+      std::vector<pRing_t> vRing;
+      uint32_t nGeneration( 0 );
+      std::vector<uint8_t> vOctets;
+      std::vector<entry_t> vEntry;
+      std::vector<pRing_t> vDrained; // retired rings emptied this pass
+      std::chrono::milliseconds msIdle( 1 );
+      bool bFinal( false );
+      while ( !bFinal ) {
+        bFinal = m_bStop.load();
+        if ( nGeneration != m_nGeneration.load() ) {
+          std::lock_guard<std::mutex> lock( m_mutex );
+          vRing = m_vRing;
+          nGeneration = m_nGeneration.load();
+        }
+        vOctets.clear();
+        vEntry.clear();
+        vDrained.clear();
+        uint64_t nDropped( m_nDroppedRetired ); // only this thread changes it
+        for ( const pRing_t& pRing: vRing ) {
+          const bool bRetired = pRing->bRetired.load( std::memory_order_acquire ); // before the drain, its last records are in
+          size_t ix = vOctets.size();
+          bool bEmpty( false );
+          while ( ( 1024 * 1024 ) > vOctets.size() ) {
+            if ( !pRing->Pop( vOctets ) ) {
+              bEmpty = true;
+              break;
+            }
+            record_header_t header;
+            std::memcpy( &header.ns, vOctets.data() + ix + sizeof( uint32_t ), sizeof( header.ns ) );
+            vEntry.push_back( entry_t{ header.ns, ix, pRing->idThread } );
+            ix = vOctets.size();
+          }
+          nDropped += pRing->nDropped.load( std::memory_order_relaxed );
+          if ( bRetired && bEmpty ) vDrained.push_back( pRing );
+        }
+        if ( !vDrained.empty() ) {
+          std::lock_guard<std::mutex> lock( m_mutex );
+          for ( const pRing_t& pRing: vDrained ) {
+            m_nDroppedRetired += pRing->nDropped.load( std::memory_order_relaxed );
+            m_vRing.erase( std::find( m_vRing.begin(), m_vRing.end(), pRing ) );
+          }
+          m_nGeneration++; // picked up, and the rings released, at the top of the next pass
+        }
+        if ( vEntry.empty() && ( nDropped == m_nDropped ) ) {
+          if ( !bFinal && vDrained.empty() ) {
+            std::unique_lock<std::mutex> lock( m_mutexWake );
+            m_cvWake.wait_for( lock, msIdle );
+            msIdle = std::min( 2 * msIdle, std::chrono::milliseconds( idle_wait_max_ms ) );
+          }
+        }
+        else {
+          msIdle = std::chrono::milliseconds( 1 );
+          std::stable_sort(
+            vEntry.begin(), vEntry.end(),
+            []( const entry_t& lhs, const entry_t& rhs ){ return lhs.ns < rhs.ns; } );
+          std::lock_guard<std::mutex> lock( m_mutex );
+          std::ostream& os( *m_pOut );
+          for ( const entry_t& entry: vEntry ) {
+            Format( os, vOctets.data() + entry.ix, entry.idThread );
+          }
+          if ( nDropped != m_nDropped ) {
+            os << "logging: " << ( nDropped - m_nDropped ) << " records dropped, rings full\n";
+            m_nDropped = nDropped;
+          }
+          os.flush();
+          m_nWritten.fetch_add( vEntry.size(), std::memory_order_relaxed );
+        }
+      }
+    }
+
+    static void Format( std::ostream& os, const uint8_t* p, uint32_t idThread ) {
+
+      record_header_t header;
+      const uint8_t* pEnd = p;
+      std::memcpy( &header.nOctets, p, sizeof( header.nOctets ) ); p += sizeof( header.nOctets );
+      pEnd += header.nOctets;
+      std::memcpy( &header.ns, p, sizeof( header.ns ) ); p += sizeof( header.ns );
+      header.level = *p++;
+      header.nArgs = *p++;
+      header.bTruncated = *p++;
+      std::memcpy( &header.format, p, sizeof( header.format ) ); p += sizeof( header.format );
+
+      const std::time_t t = header.ns / 1000000000;
+      std::tm tm;
+      localtime_r( &t, &tm );
+      const char fill = os.fill( '0' );
+      os
+        << std::put_time( &tm, "%H:%M:%S" ) << '.' << std::setw( 6 ) << ( header.ns % 1000000000 ) / 1000
+        << " [" << rszLevel[ std::min<uint8_t>( header.level, error ) ] << "] t" << idThread << ' ';
+      os.fill( fill );
+
+      const char* sz = header.format;
+      for ( uint8_t ixArg = 0; ixArg < header.nArgs; ixArg++ ) {
+        const char* szPlaceholder = std::strstr( sz, "{}" );
+        if ( nullptr == szPlaceholder ) {
+          os << sz << ' ';
+          sz += std::strlen( sz );
+        }
+        else {
+          os.write( sz, szPlaceholder - sz );
+          sz = szPlaceholder + 2;
+        }
+        p = Argument( os, p, pEnd );
+      }
+      os << sz;
+      if ( header.bTruncated ) os << " ...";
+      os << '\n';
+    }
+
+    static const uint8_t* Argument( std::ostream& os, const uint8_t* p, const uint8_t* pEnd ) {
+      const detail::tag_t tag = (detail::tag_t)*p++;
+      switch ( tag ) {
+        case detail::tagSigned: {
+          int64_t n;
+          std::memcpy( &n, p, sizeof( n ) ); p += sizeof( n );
+          os << n;
+          }
+          break;
+        case detail::tagUnsigned: {
+          uint64_t n;
+          std::memcpy( &n, p, sizeof( n ) ); p += sizeof( n );
+          os << n;
+          }
+          break;
+        case detail::tagDouble: {
+          double d;
+          std::memcpy( &d, p, sizeof( d ) ); p += sizeof( d );
+          os << d;
+          }
+          break;
+        case detail::tagString: {
+          uint16_t n;
+          std::memcpy( &n, p, sizeof( n ) ); p += sizeof( n );
+          os.write( reinterpret_cast<const char*>( p ), n );
+          p += n;
+          }
+          break;
+        case detail::tagHex: {
+          const char sep = *p++;
+          uint16_t n;
+          std::memcpy( &n, p, sizeof( n ) ); p += sizeof( n );
+          static const char rHex[] = "0123456789abcdef";
+          for ( uint16_t ix = 0; ix < n; ix++ ) {
+            if ( ( 0 != ix ) && ( 0 != sep ) ) os << sep;
+            os << rHex[ p[ ix ] >> 4 ] << rHex[ p[ ix ] & 0x0f ];
+          }
+          p += n;
+          }
+          break;
+        case detail::tagDeferred: {
+          fFormat_t fFormat;
+          std::memcpy( &fFormat, p, sizeof( fFormat ) ); p += sizeof( fFormat );
+          uint16_t n;
+          std::memcpy( &n, p, sizeof( n ) ); p += sizeof( n );
+          std::vector<uint8_t> v( p, p + n ); // decoders take a mutable reference, and expect alignment
+          fFormat( os, v.data(), n );
+          p += n;
+          }
+          break;
+      }
+      assert( p <= pEnd );
+      return p;
+    }
+
+  };
+
+  sink_t& Sink() {
+    static sink_t sink;
+    return sink;
+  }
+
+  struct thread_ring_t {
+    pRing_t pRing;
+    thread_ring_t(): pRing( Sink().Register() ) {}
+    ~thread_ring_t() { Sink().Retire( pRing ); } // the background thread drains, then frees it
+  };
+
+  thread_local thread_ring_t ring;
+
+} // namespace anon
+
+void SetLevel( level lvl ) {
+  levelEnabled.store( lvl, std::memory_order_relaxed );
+}
+
+void SetOutput( std::ostream& os ) {
+  Sink().SetOutput( os );
+}
+
+stats_t Stats() {
+  return Sink().Stats();
+}
+
+namespace detail {
+
+encoder_t::encoder_t( level lvl, const char* format )
+: n( nRecordHeader ), nArgs( 0 ), bTruncated( false )
+{
+  const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch() ).count();
+  uint8_t* p = r + sizeof( uint32_t ); // length is filled in by Commit
+  std::memcpy( p, &ns, sizeof( ns ) ); p += sizeof( ns );
+  *p++ = lvl;
+  p++; // nArgs, filled in by Commit
+  p++; // bTruncated, filled in by Commit
+  std::memcpy( p, &format, sizeof( format ) );
+}
+
+void encoder_t::Octets( tag_t tag, const void* p, size_t nOctets, const void* pExtra, size_t nExtra ) {
+  const size_t nPrefix = 1 + nExtra + sizeof( uint16_t );
+  if ( !Room( nPrefix ) ) return;
+  size_t nFit = std::min( nOctets, nRecordMaximum - n - nPrefix );
+  if ( nFit < nOctets ) {
+    bTruncated = true;
+    if ( tagDeferred == tag ) return; // a decoder needs all of it
+  }
+  Put( (uint8_t)tag );
+  Put( pExtra, nExtra );
+  Put( (uint16_t)nFit );
+  Put( p, nFit );
+  nArgs++;
+}
+
+void Commit( encoder_t& e ) {
+  const uint32_t nOctets = e.n;
+  std::memcpy( e.r, &nOctets, sizeof( nOctets ) );
+  const size_t ixArgs = sizeof( uint32_t ) + sizeof( uint64_t ) + 1;
+  e.r[ ixArgs ] = e.nArgs;
+  e.r[ ixArgs + 1 ] = e.bTruncated ? 1 : 0;
+  ring_t& r( *ring.pRing );
+  if ( !r.Push( e.r, e.n ) ) {
+    r.nDropped.fetch_add( 1, std::memory_order_relaxed );
+  }
+}
+
+} // namespace detail
+
+} // namespace logging
@@ -0,0 +1,160 @@
+/*
+ * File:   logging.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 8:20 PM
+ */
+
+#ifndef LOGGING_H
+#define LOGGING_H
+
+#include <string>
+#include <atomic>
+#include <iosfwd>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#include <boost/endian/arithmetic.hpp>
+
+// Asynchronous binary logging, for the OpenFlow hot path.
+//   a log statement copies a pointer to its format string, a timestamp and the raw
+//     argument values into a record in the calling thread's own lock-free ring,
+//   a background thread formats the records ( "{}" is replaced by the next argument ),
+//     writes them in timestamp order and flushes once per pass,
+//   a full ring never blocks the caller, the record is dropped and counted.
+//   a thread's ring is retired as the thread exits, drained, then freed;
+//   with every ring empty, the background thread waits longer each pass, up to idle_wait_max_ms.
+// Statements below LOGGING_LEVEL_MINIMUM compile to nothing, arguments are not evaluated,
+//   statements filtered out at run time cost a relaxed load.
+// Format strings are not copied, use literals.
+//
+//   LOG_TRACE( "in_port={} mac {}", nPort, logging::hex( pMac, 6, ':' ) );
+
+#ifndef LOGGING_LEVEL_MINIMUM
+#define LOGGING_LEVEL_MINIMUM 0 // 0 trace, 1 debug, 2 info, 3 warning, 4 error
+#endif
+
+#define LOGGING_WRITE( LEVEL, ... ) \
+  do { \
+    if ( ( LOGGING_LEVEL_MINIMUM <= LEVEL ) && logging::Enabled( (logging::level)LEVEL ) ) { \
+      logging::Write( (logging::level)LEVEL, __VA_ARGS__ ); \
+    } \
+  } while ( false )
+
+#define LOG_TRACE( ... )   LOGGING_WRITE( 0, __VA_ARGS__ )
+#define LOG_DEBUG( ... )   LOGGING_WRITE( 1, __VA_ARGS__ )
+#define LOG_INFO( ... )    LOGGING_WRITE( 2, __VA_ARGS__ )
+#define LOG_WARNING( ... ) LOGGING_WRITE( 3, __VA_ARGS__ )
+#define LOG_ERROR( ... )   LOGGING_WRITE( 4, __VA_ARGS__ )
+
+namespace logging {
+
+enum level: uint8_t { trace = 0, debug, info, warning, error };
+
+// octets, copied into the record, formatted as two digit hex, sep of 0 for none
+struct hex {
+  const void* p;
+  size_t n;
+  char sep;
+  hex( const void* p_, size_t n_, char sep_ = ' ' ): p( p_ ), n( n_ ), sep( sep_ ) {}
+};
+
+// octets, copied into the record, formatted later on the background thread
+typedef void (*fFormat_t)( std::ostream&, uint8_t* p, size_t n );
+struct deferred {
+  fFormat_t fFormat;
+  const void* p;
+  size_t n;
+  deferred( fFormat_t fFormat_, const void* p_, size_t n_ ): fFormat( fFormat_ ), p( p_ ), n( n_ ) {}
+};
+
+// for decoders constructed on a uint8_t& and having an operator<<
+template<typename T>
+deferred Deferred( const void* p, size_t n ) {
+  return deferred(
+    []( std::ostream& os, uint8_t* p, size_t ){ T t( *p ); os << t; },
+    p, n );
+}
+
+struct stats_t {
+  uint64_t nWritten; // records formatted
+  uint64_t nDropped; // records lost to a full ring
+  uint64_t nThreads; // rings held, of running threads and exited ones not yet drained
+};
+
+extern std::atomic<uint8_t> levelEnabled;
+
+inline bool Enabled( level lvl ) { return levelEnabled.load( std::memory_order_relaxed ) <= lvl; }
+void SetLevel( level );
+void SetOutput( std::ostream& ); // std::cout to start
+stats_t Stats();
+
+namespace detail {
+
+  enum tag_t: uint8_t { tagSigned, tagUnsigned, tagDouble, tagString, tagHex, tagDeferred };
+
+  enum { nRecordMaximum = 2048 }; // larger arguments are truncated
+
+  struct encoder_t {
+    uint8_t r[ nRecordMaximum ];
+    size_t n;
+    uint8_t nArgs;
+    bool bTruncated;
+
+    encoder_t( level, const char* format );
+
+    bool Room( size_t nOctets ) {
+      if ( nRecordMaximum >= ( n + nOctets ) ) return true;
+      bTruncated = true;
+      return false;
+    }
+    template<typename T>
+    void Put( const T& t ) { std::memcpy( r + n, &t, sizeof( T ) ); n += sizeof( T ); }
+    void Put( const void* p, size_t nOctets ) { std::memcpy( r + n, p, nOctets ); n += nOctets; }
+    void Octets( tag_t, const void* p, size_t nOctets, const void* pExtra, size_t nExtra );
+  };
+
+  void Commit( encoder_t& );
+
+  template<typename T>
+  typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+  Encode( encoder_t& e, T t ) {
+    if ( e.Room( 1 + sizeof( int64_t ) ) ) { e.Put( (uint8_t)tagSigned ); e.Put( (int64_t)t ); e.nArgs++; }
+  }
+
+  template<typename T>
+  typename std::enable_if<( std::is_integral<T>::value && !std::is_signed<T>::value ) || std::is_enum<T>::value>::type
+  Encode( encoder_t& e, T t ) {
+    if ( e.Room( 1 + sizeof( uint64_t ) ) ) { e.Put( (uint8_t)tagUnsigned ); e.Put( (uint64_t)t ); e.nArgs++; }
+  }
+
+  inline void Encode( encoder_t& e, double d ) {
+    if ( e.Room( 1 + sizeof( double ) ) ) { e.Put( (uint8_t)tagDouble ); e.Put( d ); e.nArgs++; }
+  }
+
+  template<boost::endian::order Order, class T, std::size_t n_bits, boost::endian::align Align>
+  void Encode( encoder_t& e, const boost::endian::endian_arithmetic<Order, T, n_bits, Align>& t ) {
+    Encode( e, t.value() );
+  }
+
+  inline void Encode( encoder_t& e, const char* sz ) { e.Octets( tagString, sz, std::strlen( sz ), nullptr, 0 ); }
+  inline void Encode( encoder_t& e, const std::string& s ) { e.Octets( tagString, s.data(), s.size(), nullptr, 0 ); }
+  inline void Encode( encoder_t& e, const hex& h ) { e.Octets( tagHex, h.p, h.n, &h.sep, sizeof( h.sep ) ); }
+  inline void Encode( encoder_t& e, const deferred& d ) { e.Octets( tagDeferred, d.p, d.n, &d.fFormat, sizeof( d.fFormat ) ); }
+
+} // namespace detail
+
+template<typename... Args>
+void Write( level lvl, const char* format, const Args&... args ) {
+  detail::encoder_t encoder( lvl, format );
+  int rDummy[] = { 0, ( detail::Encode( encoder, args ), 0 )... };
+  (void)rDummy;
+  detail::Commit( encoder );
+}
+
+} // namespace logging
+
+#endif /* LOGGING_H */
+
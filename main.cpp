@@ -8,22 +8,39 @@
 
 // To debug ASIO, use DEFINE: BOOST_ASIO_ENABLE_HANDLER_TRACKING
 
+#include <string>
+#include <cstdlib>
 #include <iostream>
 
 #include "control.h"
 
 int main( int argc, char** argv ) {
 
-  int port( 6633 );
+  Control::options_t options;
 
-  if (argc != 2) {
-    std::cout << "Usage: async_tcp_echo_server <port> (using " << port << ")\n";
+  // cppofc [port] [--record <base> [files] [MB per file]] [--switch-buffers]
+  bool bUsage( false );
+  int ix( 1 );
+  if ( ( ix < argc ) && ( '-' != argv[ ix ][ 0 ] ) ) {
+    options.port = std::atoi( argv[ ix++ ] );
   }
-  else {
-    port = std::atoi( argv[1] );
+  while ( ix < argc ) {
+    const std::string sOption( argv[ ix++ ] );
+    if ( ( "--record" == sOption ) && ( ix < argc ) ) {
+      options.sRecorder = argv[ ix++ ];
+      if ( ( ix < argc ) && ( '-' != argv[ ix ][ 0 ] ) ) options.nRecorderFiles = std::atoi( argv[ ix++ ] );
+      if ( ( ix < argc ) && ( '-' != argv[ ix ][ 0 ] ) ) options.nRecorderSegmentOctets = size_t( std::atoi( argv[ ix++ ] ) ) * 1024 * 1024;
+    }
+    else {
+      if ( "--switch-buffers" == sOption ) options.bUseSwitchBuffers = true;
+      else bUsage = true;
+    }
+  }
+  if ( bUsage ) {
+    std::cout << "Usage: cppofc [port] [--record <base> [files] [MB per file]] [--switch-buffers] (using " << options.port << ")\n";
   }
 
-  Control control( port );
+  Control control( options );
   control.Start();
 
   return 0;
@@ -0,0 +1,83 @@
+/*
+ * File:   multipart.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 3:05 AM
+ */
+
+#include <ostream>
+
+#include "logging.h"
+#include "multipart.h"
+
+Multipart::Multipart( ofp141::ofp_multipart_type type, const codec::ofp_multipart::visitor_t& visitor, fDone_t fDone )
+: m_type( type ), m_visitor( visitor ), m_fDone( std::move( fDone ) ),
+  m_status( status_t::active )
+{}
+
+Multipart::~Multipart() {}
+
+void Multipart::Part( const ofp141::ofp_header& header, const uint8_t* pEnd ) {
+
+  if ( status_t::active != m_status ) return; // malformed earlier, the remaining parts are let go
+
+  const auto& msg( reinterpret_cast<const ofp141::ofp_multipart_reply&>( header ) );
+  const size_t nOctets = pEnd - reinterpret_cast<const uint8_t*>( &header );
+  m_stats.nParts++;
+  m_stats.nOctets += nOctets;
+  if ( m_stats.nPartMax < nOctets ) m_stats.nPartMax = nOctets;
+
+  const bool bLast = !codec::ofp_multipart::More( msg );
+  if ( ( sizeof( ofp141::ofp_multipart_reply ) > nOctets ) || ( m_type != msg.type ) ) {
+    LOG_WARNING( "multipart: reply part of type {} to a request of type {}", (uint16_t)msg.type, (uint16_t)m_type );
+    Done( status_t::malformed );
+  }
+  else {
+    if ( !codec::ofp_multipart::Decode( msg, pEnd, m_visitor, m_stats.nRecords ) ) {
+      LOG_WARNING( "multipart: malformed record in part {} of type {}", m_stats.nParts, (uint16_t)m_type );
+      Done( status_t::malformed );
+    }
+    else {
+      if ( bLast ) Done( status_t::complete );
+    }
+  }
+}
+
+void Multipart::Error( const ofp141::ofp_error_msg* pError ) {
+  if ( nullptr == pError ) {
+    Done( status_t::timeout );
+  }
+  else {
+    LOG_WARNING( "multipart: type {} error type {} code {}", (uint16_t)m_type, pError->type, pError->code );
+    Done( status_t::error );
+  }
+}
+
+void Multipart::Done( status_t status ) {
+  if ( status_t::active == m_status ) {
+    m_status = status;
+    if ( nullptr != m_fDone ) m_fDone( m_status, m_stats );
+  }
+}
+
+std::ostream& operator<<( std::ostream& os, Multipart::status_t status ) {
+  switch ( status ) {
+    case Multipart::status_t::active:    os << "active"; break;
+    case Multipart::status_t::complete:  os << "complete"; break;
+    case Multipart::status_t::malformed: os << "malformed"; break;
+    case Multipart::status_t::error:     os << "error"; break;
+    case Multipart::status_t::timeout:   os << "timeout"; break;
+  }
+  return os;
+}
+
+std::ostream& operator<<( std::ostream& os, const Multipart::stats_t& stats ) {
+  os
+    << "parts=" << stats.nParts
+    << ",records=" << stats.nRecords
+    << ",octets=" << stats.nOctets
+    << ",largest part=" << stats.nPartMax
+    ;
+  return os;
+}
@@ -0,0 +1,70 @@
+/*
+ * File:   multipart.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 3:05 AM
+ */
+
+#ifndef MULTIPART_H
+#define MULTIPART_H
+
+#include <iosfwd>
+#include <cstdint>
+#include <functional>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_multipart.h"
+
+// One multipart request's replies, as the continuations of its transaction:
+//   Transactions::Complete hands over each part while OFPMPF_REPLY_MORE is set, then the last,
+//   each part is decoded where it was framed and its records visited before the next is read,
+//   so a dump of any size is held one part at a time.
+// fDone is called once: after the last part, on an error reply, or when a part is overdue.
+
+class Multipart {
+public:
+
+  enum class status_t { active, complete, malformed, error, timeout };
+
+  struct stats_t {
+    uint64_t nParts;
+    uint64_t nRecords;
+    uint64_t nOctets;    // of the reply messages
+    uint64_t nPartMax;   // octets of the largest part, what a dump holds at any one time
+    stats_t(): nParts( 0 ), nRecords( 0 ), nOctets( 0 ), nPartMax( 0 ) {}
+  };
+
+  typedef std::function<void(status_t, const stats_t&)> fDone_t;
+
+  Multipart( ofp141::ofp_multipart_type, const codec::ofp_multipart::visitor_t&, fDone_t );
+  virtual ~Multipart();
+
+  // as Transactions::fComplete_t and fError_t
+  void Part( const ofp141::ofp_header&, const uint8_t* pEnd );
+  void Error( const ofp141::ofp_error_msg* );
+
+  status_t Status() const { return m_status; }
+  const stats_t& Stats() const { return m_stats; }
+
+protected:
+private:
+
+  const ofp141::ofp_multipart_type m_type;
+  const codec::ofp_multipart::visitor_t m_visitor;
+  fDone_t m_fDone;
+
+  status_t m_status;
+  stats_t m_stats;
+
+  void Done( status_t );
+
+  Multipart( const Multipart& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, Multipart::status_t );
+std::ostream& operator<<( std::ostream&, const Multipart::stats_t& );
+
+#endif /* MULTIPART_H */
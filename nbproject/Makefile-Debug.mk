@@ -38,19 +38,33 @@ OBJECTFILES= \
 	${OBJECTDIR}/Buffer.o \
 	${OBJECTDIR}/bridge.o \
 	${OBJECTDIR}/codecs/datapathid.o \
+	${OBJECTDIR}/codecs/nx_learn.o \
 	${OBJECTDIR}/codecs/ofp_async_config.o \
 	${OBJECTDIR}/codecs/ofp_barrier.o \
+	${OBJECTDIR}/codecs/ofp_bundle.o \
 	${OBJECTDIR}/codecs/ofp_flow_mod.o \
+	${OBJECTDIR}/codecs/ofp_flow_removed.o \
 	${OBJECTDIR}/codecs/ofp_group_mod.o \
 	${OBJECTDIR}/codecs/ofp_header.o \
 	${OBJECTDIR}/codecs/ofp_hello.o \
+	${OBJECTDIR}/codecs/ofp_match.o \
+	${OBJECTDIR}/codecs/ofp_meter_mod.o \
+	${OBJECTDIR}/codecs/ofp_multipart.o \
 	${OBJECTDIR}/codecs/ofp_packet_out.o \
 	${OBJECTDIR}/codecs/ofp_port_status.o \
 	${OBJECTDIR}/codecs/ofp_switch_features.o \
 	${OBJECTDIR}/control.o \
+	${OBJECTDIR}/dispatcher.o \
+	${OBJECTDIR}/flow_index.o \
+	${OBJECTDIR}/flow_templates.o \
+	${OBJECTDIR}/framer.o \
+	${OBJECTDIR}/logging.o \
 	${OBJECTDIR}/main.o \
+	${OBJECTDIR}/multipart.o \
 	${OBJECTDIR}/ovsdb.o \
 	${OBJECTDIR}/ovsdb_impl.o \
+	${OBJECTDIR}/pipeline.o \
+	${OBJECTDIR}/port_stats.o \
 	${OBJECTDIR}/protocol/dns.o \
 	${OBJECTDIR}/protocol/ethernet.o \
 	${OBJECTDIR}/protocol/ethernet/address.o \
@@ -62,7 +76,26 @@ OBJECTFILES= \
 	${OBJECTDIR}/protocol/ipv4/tcp.o \
 	${OBJECTDIR}/protocol/ipv4/udp.o \
 	${OBJECTDIR}/protocol/ipv6.o \
-	${OBJECTDIR}/tcp_session.o
+	${OBJECTDIR}/recorder.o \
+	${OBJECTDIR}/tcp_session.o \
+	${OBJECTDIR}/transactions.o
+
+# Object Files shared by the bench_* programs, linked with the above, all but main.o
+BENCHOBJECTFILES= \
+	${OBJECTDIR}/allocations.o \
+	${OBJECTDIR}/bench.o \
+	${OBJECTDIR}/replay.o
+
+# The bench_* programs, each from its own bench_*.o, see bench.h
+BENCHES= \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_async \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_buffers \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_builder \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_learning \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_match \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_multipart \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_replay \
+	${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_transmit
 
 
 # C Compiler Flags
@@ -89,11 +122,69 @@ ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/cppofc: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
 	${LINK.cc} -o ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/cppofc ${OBJECTFILES} ${LDLIBSOPTIONS}
 
+# Bench Targets
+.bench-conf: ${BUILD_SUBPROJECTS}
+	"${MAKE}"  -f nbproject/Makefile-${CND_CONF}.mk ${BENCHES}
+
+${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}/bench_%: ${OBJECTDIR}/bench_%.o ${OBJECTFILES} ${BENCHOBJECTFILES}
+	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}/${CND_PLATFORM}
+	${LINK.cc} -o $@ ${OBJECTDIR}/bench_$*.o $(filter-out ${OBJECTDIR}/main.o,${OBJECTFILES}) ${BENCHOBJECTFILES} ${LDLIBSOPTIONS}
+
+${OBJECTDIR}/allocations.o: allocations.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/allocations.o allocations.cpp
+
 ${OBJECTDIR}/Buffer.o: Buffer.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/Buffer.o Buffer.cpp
 
+${OBJECTDIR}/bench.o: bench.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench.o bench.cpp
+
+${OBJECTDIR}/bench_async.o: bench_async.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_async.o bench_async.cpp
+
+${OBJECTDIR}/bench_buffers.o: bench_buffers.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_buffers.o bench_buffers.cpp
+
+${OBJECTDIR}/bench_builder.o: bench_builder.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_builder.o bench_builder.cpp
+
+${OBJECTDIR}/bench_learning.o: bench_learning.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_learning.o bench_learning.cpp
+
+${OBJECTDIR}/bench_match.o: bench_match.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_match.o bench_match.cpp
+
+${OBJECTDIR}/bench_multipart.o: bench_multipart.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_multipart.o bench_multipart.cpp
+
+${OBJECTDIR}/bench_replay.o: bench_replay.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_replay.o bench_replay.cpp
+
+${OBJECTDIR}/bench_transmit.o: bench_transmit.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/bench_transmit.o bench_transmit.cpp
+
 ${OBJECTDIR}/bridge.o: bridge.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -104,6 +195,11 @@ ${OBJECTDIR}/codecs/datapathid.o: codecs/datapathid.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/datapathid.o codecs/datapathid.cpp
 
+${OBJECTDIR}/codecs/nx_learn.o: codecs/nx_learn.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/nx_learn.o codecs/nx_learn.cpp
+
 ${OBJECTDIR}/codecs/ofp_async_config.o: codecs/ofp_async_config.cpp
 	${MKDIR} -p ${OBJECTDIR}/codecs
 	${RM} "$@.d"
@@ -114,11 +210,21 @@ ${OBJECTDIR}/codecs/ofp_barrier.o: codecs/ofp_barrier.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_barrier.o codecs/ofp_barrier.cpp
 
+${OBJECTDIR}/codecs/ofp_bundle.o: codecs/ofp_bundle.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_bundle.o codecs/ofp_bundle.cpp
+
 ${OBJECTDIR}/codecs/ofp_flow_mod.o: codecs/ofp_flow_mod.cpp
 	${MKDIR} -p ${OBJECTDIR}/codecs
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_flow_mod.o codecs/ofp_flow_mod.cpp
 
+${OBJECTDIR}/codecs/ofp_flow_removed.o: codecs/ofp_flow_removed.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_flow_removed.o codecs/ofp_flow_removed.cpp
+
 ${OBJECTDIR}/codecs/ofp_group_mod.o: codecs/ofp_group_mod.cpp
 	${MKDIR} -p ${OBJECTDIR}/codecs
 	${RM} "$@.d"
@@ -134,6 +240,21 @@ ${OBJECTDIR}/codecs/ofp_hello.o: codecs/ofp_hello.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_hello.o codecs/ofp_hello.cpp
 
+${OBJECTDIR}/codecs/ofp_match.o: codecs/ofp_match.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_match.o codecs/ofp_match.cpp
+
+${OBJECTDIR}/codecs/ofp_meter_mod.o: codecs/ofp_meter_mod.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_meter_mod.o codecs/ofp_meter_mod.cpp
+
+${OBJECTDIR}/codecs/ofp_multipart.o: codecs/ofp_multipart.cpp
+	${MKDIR} -p ${OBJECTDIR}/codecs
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/codecs/ofp_multipart.o codecs/ofp_multipart.cpp
+
 ${OBJECTDIR}/codecs/ofp_packet_out.o: codecs/ofp_packet_out.cpp
 	${MKDIR} -p ${OBJECTDIR}/codecs
 	${RM} "$@.d"
@@ -154,11 +275,41 @@ ${OBJECTDIR}/control.o: control.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/control.o control.cpp
 
+${OBJECTDIR}/dispatcher.o: dispatcher.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/dispatcher.o dispatcher.cpp
+
+${OBJECTDIR}/flow_index.o: flow_index.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/flow_index.o flow_index.cpp
+
+${OBJECTDIR}/flow_templates.o: flow_templates.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/flow_templates.o flow_templates.cpp
+
+${OBJECTDIR}/framer.o: framer.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/framer.o framer.cpp
+
+${OBJECTDIR}/logging.o: logging.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/logging.o logging.cpp
+
 ${OBJECTDIR}/main.o: main.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/main.o main.cpp
 
+${OBJECTDIR}/multipart.o: multipart.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/multipart.o multipart.cpp
+
 ${OBJECTDIR}/ovsdb.o: ovsdb.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
@@ -169,6 +320,16 @@ ${OBJECTDIR}/ovsdb_impl.o: ovsdb_impl.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/ovsdb_impl.o ovsdb_impl.cpp
 
+${OBJECTDIR}/pipeline.o: pipeline.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/pipeline.o pipeline.cpp
+
+${OBJECTDIR}/port_stats.o: port_stats.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/port_stats.o port_stats.cpp
+
 ${OBJECTDIR}/protocol/dns.o: protocol/dns.cpp
 	${MKDIR} -p ${OBJECTDIR}/protocol
 	${RM} "$@.d"
@@ -224,11 +385,26 @@ ${OBJECTDIR}/protocol/ipv6.o: protocol/ipv6.cpp
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/protocol/ipv6.o protocol/ipv6.cpp
 
+${OBJECTDIR}/recorder.o: recorder.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/recorder.o recorder.cpp
+
+${OBJECTDIR}/replay.o: replay.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/replay.o replay.cpp
+
 ${OBJECTDIR}/tcp_session.o: tcp_session.cpp
 	${MKDIR} -p ${OBJECTDIR}
 	${RM} "$@.d"
 	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/tcp_session.o tcp_session.cpp
 
+${OBJECTDIR}/transactions.o: transactions.cpp
+	${MKDIR} -p ${OBJECTDIR}
+	${RM} "$@.d"
+	$(COMPILE.cc) -g -DBOOST_LOG_DYN_LINK -D_DEBUG -I/usr/local/include -std=c++14 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/transactions.o transactions.cpp
+
 # Subprojects
 .build-subprojects:
 
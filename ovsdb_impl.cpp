@@ -593,8 +593,13 @@ void decode_impl::parse( vByte_t::const_iterator begin, size_t lenRead ) {
           auto& result = j["result"];
           parse_interface( result );
 
-          m_state = startStatisticsMonitor;
-          send_monitor_statistics();
+          if ( nullptr == m_ovsdb.m_f.fStatisticsUpdate ) {
+            m_state = listen; // statistics are gathered some other way
+          }
+          else {
+            m_state = startStatisticsMonitor;
+            send_monitor_statistics();
+          }
 
         }
         break;
@@ -0,0 +1,154 @@
+/*
+ * File:   pipeline.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 6:05 PM
+ */
+
+#include <cassert>
+#include <ostream>
+#include <iostream>
+#include <exception>
+
+#include "pipeline.h"
+
+namespace {
+  uint64_t Nanoseconds( Pipeline::clock_t::duration duration ) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count();
+  }
+}
+
+Pipeline::Pipeline( size_t nWorkers, size_t nRing, fProcess_t fProcess )
+: m_fProcess( std::move( fProcess ) ), m_bStop( false )
+{
+  assert( 0 < nWorkers );
+  assert( nullptr != m_fProcess );
+  for ( size_t ix = 0; ix < nWorkers; ix++ ) {
+    m_vWorker.emplace_back( std::make_unique<worker_t>( nRing ) );
+  }
+  for ( pWorker_t& pWorker: m_vWorker ) {
+    worker_t& worker( *pWorker );
+    worker.thread = std::thread( [this, &worker](){ Run( worker ); } );
+  }
+}
+
+Pipeline::~Pipeline() {
+  Stop();
+}
+
+void Pipeline::Post( size_t key, job_t& job ) {
+
+  worker_t& worker( *m_vWorker[ key % m_vWorker.size() ] );
+
+  job.tpQueued = clock_t::now();
+  worker.nsClassify += Nanoseconds( job.tpQueued - job.tpReceived );
+
+  if ( !worker.ring.Push( job ) ) {
+    worker.nFull++;
+    do {
+      std::this_thread::yield(); // worker is behind, back pressure onto the socket
+    } while ( !worker.ring.Push( job ) );
+  }
+  worker.nQueued++;
+
+  const size_t nDepth = worker.ring.Size();
+  if ( worker.nDepthMax < nDepth ) worker.nDepthMax = nDepth;
+
+  std::atomic_thread_fence( std::memory_order_seq_cst ); // pairs with the fence in Run
+  if ( worker.bSleeping.load( std::memory_order_relaxed ) ) {
+    std::lock_guard<std::mutex> lock( worker.mutex );
+    worker.cv.notify_one();
+  }
+}
+
+void Pipeline::Run( worker_t& worker ) {
+  job_t job;
+  size_t nIdle( 0 );
+  while ( !m_bStop.load( std::memory_order_relaxed ) ) {
+    if ( worker.ring.Pop( job ) ) {
+      nIdle = 0;
+      const clock_t::time_point tpStart = clock_t::now();
+      worker.nsWait.fetch_add( Nanoseconds( tpStart - job.tpQueued ), std::memory_order_relaxed );
+      try {
+        m_fProcess( job );
+      }
+      catch ( const std::exception& e ) {
+        worker.nFailed.fetch_add( 1, std::memory_order_relaxed );
+        std::cout << "Pipeline job failed: " << e.what() << std::endl;
+      }
+      job = job_t(); // release the octets
+      const uint64_t ns = Nanoseconds( clock_t::now() - tpStart );
+      worker.nsProcess.fetch_add( ns, std::memory_order_relaxed );
+      if ( worker.nsProcessMax.load( std::memory_order_relaxed ) < ns ) {
+        worker.nsProcessMax.store( ns, std::memory_order_relaxed );
+      }
+      worker.nProcessed.fetch_add( 1, std::memory_order_relaxed );
+    }
+    else {
+      if ( nSpin > nIdle ) {
+        nIdle++;
+        std::this_thread::yield();
+      }
+      else {
+        std::unique_lock<std::mutex> lock( worker.mutex );
+        worker.bSleeping.store( true, std::memory_order_relaxed );
+        std::atomic_thread_fence( std::memory_order_seq_cst ); // pairs with the fence in Post
+        if ( worker.ring.Empty() && !m_bStop.load( std::memory_order_relaxed ) ) {
+          worker.cv.wait( lock );
+          worker.nWakes.fetch_add( 1, std::memory_order_relaxed );
+        }
+        worker.bSleeping.store( false, std::memory_order_relaxed );
+        nIdle = 0;
+      }
+    }
+  }
+}
+
+void Pipeline::Stop() {
+  if ( !m_bStop.exchange( true ) ) {
+    for ( pWorker_t& pWorker: m_vWorker ) {
+      std::lock_guard<std::mutex> lock( pWorker->mutex );
+      pWorker->cv.notify_one();
+    }
+    for ( pWorker_t& pWorker: m_vWorker ) {
+      if ( pWorker->thread.joinable() ) pWorker->thread.join();
+    }
+  }
+}
+
+Pipeline::stats_t Pipeline::Stats( size_t ixWorker ) const {
+  const worker_t& worker( *m_vWorker[ ixWorker ] );
+  stats_t stats;
+  stats.nQueued = worker.nQueued;
+  stats.nFull = worker.nFull;
+  stats.nDepthMax = worker.nDepthMax;
+  stats.nsClassify = worker.nsClassify;
+  stats.nDepth = worker.ring.Size();
+  stats.nProcessed = worker.nProcessed.load( std::memory_order_relaxed );
+  stats.nFailed = worker.nFailed.load( std::memory_order_relaxed );
+  stats.nWakes = worker.nWakes.load( std::memory_order_relaxed );
+  stats.nsWait = worker.nsWait.load( std::memory_order_relaxed );
+  stats.nsProcess = worker.nsProcess.load( std::memory_order_relaxed );
+  stats.nsProcessMax = worker.nsProcessMax.load( std::memory_order_relaxed );
+  return stats;
+}
+
+std::ostream& operator<<( std::ostream& os, const Pipeline::stats_t& stats ) {
+  const uint64_t nQueued = ( 0 == stats.nQueued ) ? 1 : stats.nQueued;
+  const uint64_t nProcessed = ( 0 == stats.nProcessed ) ? 1 : stats.nProcessed;
+  os
+    << "queued=" << stats.nQueued
+    << ",full=" << stats.nFull
+    << ",processed=" << stats.nProcessed
+    << ",failed=" << stats.nFailed
+    << ",wakes=" << stats.nWakes
+    << ",depth=" << stats.nDepth
+    << ",max depth=" << stats.nDepthMax
+    << ",classify ns/msg=" << stats.nsClassify / nQueued
+    << ",wait ns/msg=" << stats.nsWait / nProcessed
+    << ",process ns/msg=" << stats.nsProcess / nProcessed
+    << ",max process ns=" << stats.nsProcessMax
+    ;
+  return os;
+}
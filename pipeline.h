@@ -0,0 +1,129 @@
+/*
+ * File:   pipeline.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 6:05 PM
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+#include "common.h"
+#include "spsc_ring.h"
+
+// Moves slow message processing off the socket thread.
+//   the socket thread frames and classifies, then posts each message to one
+//   worker, chosen by a key (in_port), so messages with the same key stay in order.
+//   each worker has its own single producer, single consumer ring;
+//   an idle worker spins briefly, then sleeps until the producer wakes it.
+// Stages timed per message:
+//   classify: from framing to being posted,
+//   wait:     from being posted to a worker picking it up,
+//   process:  the worker's handling, including any transmit queueing.
+
+class Pipeline {
+public:
+
+  typedef std::chrono::steady_clock clock_t;
+
+  struct job_t {
+    std::shared_ptr<const vByte_t> pHolder; // keeps the message's octets alive, a lent receive slab or a copy
+    uint8_t* pBegin;
+    const uint8_t* pEnd;
+    clock_t::time_point tpReceived;
+    clock_t::time_point tpQueued;
+    job_t(): pBegin( nullptr ), pEnd( nullptr ) {}
+  };
+
+  typedef std::function<void(job_t&)> fProcess_t; // called on a worker thread
+
+  struct stats_t {
+    uint64_t nQueued;     // posted by the producer
+    uint64_t nFull;       // posts which had to wait for room
+    uint64_t nProcessed;  // completed by the worker
+    uint64_t nFailed;     // completed by throwing
+    uint64_t nWakes;      // times the worker was woken from sleep
+    size_t nDepth;        // in the ring now
+    size_t nDepthMax;     // deepest seen at post time
+    uint64_t nsClassify;  // totals, in nanoseconds
+    uint64_t nsWait;
+    uint64_t nsProcess;
+    uint64_t nsProcessMax;
+    stats_t()
+    : nQueued( 0 ), nFull( 0 ), nProcessed( 0 ), nFailed( 0 ), nWakes( 0 ),
+      nDepth( 0 ), nDepthMax( 0 ),
+      nsClassify( 0 ), nsWait( 0 ), nsProcess( 0 ), nsProcessMax( 0 )
+    {}
+  };
+
+  Pipeline( size_t nWorkers, size_t nRing, fProcess_t ); // nRing needs to be a power of two
+  virtual ~Pipeline();
+
+  // single producer: moves job into the ring of the worker owning key,
+  //   yields while that ring is full
+  void Post( size_t key, job_t& job );
+
+  void Stop(); // queued jobs are dropped
+
+  size_t Workers() const { return m_vWorker.size(); }
+  stats_t Stats( size_t ixWorker ) const;
+
+protected:
+private:
+
+  struct worker_t {
+    SpscRing<job_t> ring;
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::atomic<bool> bSleeping;
+    // written by the producer
+    uint64_t nQueued;
+    uint64_t nFull;
+    size_t nDepthMax;
+    uint64_t nsClassify;
+    // written by the worker, read by Stats() from elsewhere
+    std::atomic<uint64_t> nProcessed;
+    std::atomic<uint64_t> nFailed;
+    std::atomic<uint64_t> nWakes;
+    std::atomic<uint64_t> nsWait;
+    std::atomic<uint64_t> nsProcess;
+    std::atomic<uint64_t> nsProcessMax;
+    worker_t( size_t nRing )
+    : ring( nRing ), bSleeping( false ),
+      nQueued( 0 ), nFull( 0 ), nDepthMax( 0 ), nsClassify( 0 ),
+      nProcessed( 0 ), nFailed( 0 ), nWakes( 0 ),
+      nsWait( 0 ), nsProcess( 0 ), nsProcessMax( 0 )
+    {}
+  };
+
+  typedef std::unique_ptr<worker_t> pWorker_t;
+  typedef std::vector<pWorker_t> vWorker_t;
+
+  static const size_t nSpin = 64; // polls before an idle worker goes to sleep
+
+  fProcess_t m_fProcess;
+  std::atomic<bool> m_bStop;
+  vWorker_t m_vWorker;
+
+  void Run( worker_t& );
+
+  Pipeline( const Pipeline& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const Pipeline::stats_t& );
+
+#endif /* PIPELINE_H */
+
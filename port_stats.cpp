@@ -0,0 +1,148 @@
+/*
+ * File:   port_stats.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 3:40 AM
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <algorithm>
+
+#include "port_stats.h"
+
+namespace {
+
+  // the counters compared between polls, rx_packets through collisions
+  const size_t ixCounters = offsetof( PortStats::counters_t, rx_packets );
+  const size_t nCounters = sizeof( PortStats::counters_t ) - ixCounters;
+
+  bool Moved( const PortStats::counters_t& a, const PortStats::counters_t& b ) {
+    return 0 != std::memcmp(
+      reinterpret_cast<const uint8_t*>( &a ) + ixCounters,
+      reinterpret_cast<const uint8_t*>( &b ) + ixCounters,
+      nCounters );
+  }
+
+} // namespace anon
+
+PortStats::PortStats( fPublish_t fPublish )
+: m_fPublish( std::move( fPublish ) ),
+  m_nPoll( 0 ), m_ixNext( 0 )
+{}
+
+PortStats::~PortStats() {}
+
+void PortStats::Begin() {
+  m_nPoll++;
+  m_ixNext = 0;
+  m_vChanged.clear();
+}
+
+// index of the port's slot, inserted with zero counters when new
+size_t PortStats::Slot( uint32_t ofport ) {
+  if ( ( m_ixNext < m_vCounters.size() ) && ( ofport == m_vCounters[ m_ixNext ].ofport ) ) {
+    return m_ixNext;
+  }
+  m_stats.nSearches++;
+  vCounters_t::iterator iter = std::lower_bound(
+    m_vCounters.begin(), m_vCounters.end(), ofport,
+    []( const counters_t& counters, uint32_t ofport ){ return counters.ofport < ofport; } );
+  const size_t ix = iter - m_vCounters.begin();
+  if ( ( m_vCounters.end() == iter ) || ( ofport != iter->ofport ) ) {
+    counters_t counters;
+    std::memset( &counters, 0, sizeof( counters_t ) );
+    counters.ofport = ofport;
+    m_vCounters.insert( iter, counters );
+    m_vPoll.insert( m_vPoll.begin() + ix, 0 );
+  }
+  return ix;
+}
+
+void PortStats::Visit( const codec::ofp_multipart::port_t& port ) {
+
+  const ofp141::ofp_port_stats& stats( port.stats );
+
+  counters_t counters;
+  counters.ofport = stats.port_no;
+  counters.duration_sec = stats.duration_sec;
+  counters.rx_packets = stats.rx_packets;
+  counters.tx_packets = stats.tx_packets;
+  counters.rx_bytes = stats.rx_bytes;
+  counters.tx_bytes = stats.tx_bytes;
+  counters.rx_dropped = stats.rx_dropped;
+  counters.tx_dropped = stats.tx_dropped;
+  counters.rx_errors = stats.rx_errors;
+  counters.tx_errors = stats.tx_errors;
+  counters.rx_frame_err = 0;
+  counters.rx_over_err = 0;
+  counters.rx_crc_err = 0;
+  counters.collisions = 0;
+
+  const uint8_t* p = port.pProperties;
+  while ( ( p + sizeof( ofp141::ofp_port_stats_prop_header ) ) <= port.pEnd ) {
+    const auto* pProperty = reinterpret_cast<const ofp141::ofp_port_stats_prop_header*>( p );
+    if ( ( sizeof( ofp141::ofp_port_stats_prop_header ) > pProperty->length ) || ( ( p + pProperty->length ) > port.pEnd ) ) break;
+    if ( ( ofp141::ofp_port_stats_prop_type::OFPPSPT_ETHERNET == pProperty->type )
+      && ( sizeof( ofp141::ofp_port_stats_prop_ethernet ) <= pProperty->length ) ) {
+      const auto* pEthernet = reinterpret_cast<const ofp141::ofp_port_stats_prop_ethernet*>( p );
+      counters.rx_frame_err = pEthernet->rx_frame_err;
+      counters.rx_over_err = pEthernet->rx_over_err;
+      counters.rx_crc_err = pEthernet->rx_crc_err;
+      counters.collisions = pEthernet->collisions;
+    }
+    p += ( ( pProperty->length + 7 ) / 8 ) * 8;
+  }
+
+  const size_t ix = Slot( counters.ofport );
+  counters_t& slot( m_vCounters[ ix ] );
+  const bool bNew( 0 == m_vPoll[ ix ] );
+  if ( bNew || Moved( slot, counters ) ) {
+    m_vChanged.push_back( counters );
+  }
+  slot = counters;
+  m_vPoll[ ix ] = m_nPoll;
+  m_ixNext = ix + 1;
+  m_stats.nPolledPorts++;
+}
+
+void PortStats::End( bool bComplete ) {
+
+  m_stats.nPolls++;
+  if ( bComplete ) {
+    // ports gone from the switch
+    size_t ixTo( 0 );
+    for ( size_t ix = 0; ix < m_vCounters.size(); ix++ ) {
+      if ( m_nPoll == m_vPoll[ ix ] ) {
+        if ( ixTo != ix ) {
+          m_vCounters[ ixTo ] = m_vCounters[ ix ];
+          m_vPoll[ ixTo ] = m_vPoll[ ix ];
+        }
+        ixTo++;
+      }
+    }
+    m_vCounters.resize( ixTo );
+    m_vPoll.resize( ixTo );
+  }
+  else {
+    m_stats.nIncomplete++;
+  }
+
+  if ( !m_vChanged.empty() ) {
+    m_stats.nChanged += m_vChanged.size();
+    if ( nullptr != m_fPublish ) m_fPublish( m_vChanged );
+  }
+}
+
+std::ostream& operator<<( std::ostream& os, const PortStats::stats_t& stats ) {
+  os
+    << "polls=" << stats.nPolls
+    << ",ports polled=" << stats.nPolledPorts
+    << ",changed=" << stats.nChanged
+    << ",searches=" << stats.nSearches
+    << ",incomplete=" << stats.nIncomplete
+    ;
+  return os;
+}
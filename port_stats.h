@@ -0,0 +1,93 @@
+/*
+ * File:   port_stats.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 18, 2026, 3:40 AM
+ */
+
+#ifndef PORT_STATS_H
+#define PORT_STATS_H
+
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "codecs/ofp_multipart.h"
+
+// Interface counters from OFPMP_PORT_STATS replies, one poll at a time:
+//   Begin(), Visit() for each record of the reply, End() once the dump is done.
+//   counters are kept in a packed array ordered by ofport; the switch answers in the same
+//     order poll after poll, so each record is expected at the slot after the previous one,
+//     a search is only needed when ports come or go.
+//   End() publishes only the ports whose counters moved since the previous poll,
+//     ports missing from a complete dump are dropped from the array.
+
+class PortStats {
+public:
+
+  struct counters_t {
+    uint32_t ofport;
+    uint32_t duration_sec; // not a counter, a change to it alone is not published
+    uint64_t rx_packets;
+    uint64_t tx_packets;
+    uint64_t rx_bytes;
+    uint64_t tx_bytes;
+    uint64_t rx_dropped;
+    uint64_t tx_dropped;
+    uint64_t rx_errors;
+    uint64_t tx_errors;
+    uint64_t rx_frame_err; // these four from the OFPPSPT_ETHERNET property, when supplied
+    uint64_t rx_over_err;
+    uint64_t rx_crc_err;
+    uint64_t collisions;
+  };
+
+  typedef std::vector<counters_t> vCounters_t;
+
+  // the ports which changed during the poll, by ofport, on the thread ending the poll
+  typedef std::function<void(const vCounters_t&)> fPublish_t;
+
+  struct stats_t {
+    uint64_t nPolls;
+    uint64_t nPolledPorts;  // records, over all polls
+    uint64_t nChanged;      // published, over all polls
+    uint64_t nSearches;     // records not at their expected slot
+    uint64_t nIncomplete;   // polls ending without the last part
+    stats_t(): nPolls( 0 ), nPolledPorts( 0 ), nChanged( 0 ), nSearches( 0 ), nIncomplete( 0 ) {}
+  };
+
+  PortStats( fPublish_t );
+  virtual ~PortStats();
+
+  void Begin();
+  void Visit( const codec::ofp_multipart::port_t& );
+  void End( bool bComplete ); // false when the dump failed or timed out, nothing is dropped
+
+  const vCounters_t& Counters() const { return m_vCounters; }
+  const stats_t& Stats() const { return m_stats; }
+
+protected:
+private:
+
+  fPublish_t m_fPublish;
+
+  vCounters_t m_vCounters; // by ofport
+  std::vector<uint64_t> m_vPoll; // per slot, the poll which last saw the port
+  vCounters_t m_vChanged; // re-used each poll
+
+  uint64_t m_nPoll;
+  size_t m_ixNext; // where the next record is expected
+
+  stats_t m_stats;
+
+  size_t Slot( uint32_t ofport );
+
+  PortStats( const PortStats& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const PortStats::stats_t& );
+
+#endif /* PORT_STATS_H */
@@ -122,6 +122,7 @@ void Cache::Update( const protocol::ipv4::address& ipv4, const protocol::etherne
 }
 
 void Cache::Update( const ethernet& arp ) {
+  std::lock_guard<std::mutex> lock( m_mutex );
   {
     const protocol::ipv4::address     ipv4( arp.IPv4Sender() );
     const protocol::ethernet::address mac(  arp.MacSender() );
@@ -16,6 +16,7 @@
 
 //#include <string>
 #include <ostream>
+#include <mutex>
 #include<unordered_map>
 
 #include <boost/endian/arithmetic.hpp>
@@ -157,6 +158,7 @@ protected:
 private:
   typedef std::unordered_map<protocol::ipv4::address,protocol::ethernet::address> mapIpv4ToMac_t;
 
+  std::mutex m_mutex; // updated from packet_in pipeline workers
   mapIpv4ToMac_t m_mapIpv4ToMac;
 
   void Update( const protocol::ipv4::address&, const protocol::ethernet::address& );
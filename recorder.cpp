@@ -0,0 +1,264 @@
+/*
+ * File:   recorder.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 10:15 PM
+ */
+
+#include <new>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <ostream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "common.h"
+#include "recorder.h"
+
+namespace {
+
+  const char szMagic[] = "OFREC001";
+
+  const size_t nAlign = 8;
+
+  uint64_t Now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch() ).count();
+  }
+
+} // namespace anon
+
+Recorder::Recorder( const std::string& sBase, size_t nFiles, size_t nSegmentOctets )
+: m_sBase( sBase ), m_nFiles( nFiles ),
+  m_nSegment( nSegmentOctets & ~( nAlign - 1 ) ),
+  m_nData( m_nSegment - sizeof( segment_header_ ) ),
+  m_pos( 0 ), m_idSession( 0 ),
+  m_nRecords( 0 ), m_nOctets( 0 ), m_nDropped( 0 ), m_nSegments( 0 ),
+  m_bStop( false )
+{
+  static_assert( 0 == ( sizeof( segment_header_ ) % nAlign ), "segment header alignment" );
+  static_assert( 0 == ( sizeof( record_header_ ) % nAlign ), "record header alignment" );
+  if ( ( 2 > m_nFiles ) || ( 4096 > m_nSegment ) ) {
+    throw std::runtime_error( "Recorder: needs two or more files of 4096 or more octets" );
+  }
+  if ( !Map( m_rSlot[ 0 ], 0 ) ) {
+    throw std::runtime_error( "Recorder: can not map " + m_sBase );
+  }
+  m_thread = std::thread( [this](){ Run(); } );
+}
+
+Recorder::~Recorder() {
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    m_bStop = true;
+  }
+  m_cv.notify_one();
+  m_thread.join();
+  for ( slot_t& slot: m_rSlot ) {
+    Unmap( slot, true );
+  }
+}
+
+void Recorder::Record(
+  direction_t direction, uint32_t idSession, uint64_t idDatapath,
+  const uint8_t* p1, size_t n1, const uint8_t* p2, size_t n2
+) {
+
+  const size_t nRecord = ( sizeof( record_header_ ) + n1 + n2 + nAlign - 1 ) & ~( nAlign - 1 );
+  if ( m_nData < nRecord ) {
+    m_nDropped.fetch_add( 1, std::memory_order_relaxed );
+    return;
+  }
+
+  // reserve: a record does not cross segments, the remainder of a segment too small for it becomes padding
+  uint64_t pos = m_pos.load( std::memory_order_relaxed );
+  uint64_t posStart;
+  size_t nPadding;
+  do {
+    const size_t ix = pos % m_nData;
+    if ( m_nData < ( ix + nRecord ) ) {
+      posStart = pos + ( m_nData - ix );
+      nPadding = m_nData - ix;
+    }
+    else {
+      posStart = pos;
+      nPadding = 0;
+    }
+    const uint64_t sequence = posStart / m_nData;
+    if ( sequence != m_rSlot[ sequence % 2 ].sequence.load( std::memory_order_acquire ) ) {
+      m_nDropped.fetch_add( 1, std::memory_order_relaxed ); // the background thread is behind
+      return;
+    }
+  } while ( !m_pos.compare_exchange_weak( pos, posStart + nRecord, std::memory_order_relaxed ) );
+
+  if ( 0 != nPadding ) { // close out the previous segment
+    slot_t& slot( m_rSlot[ ( pos / m_nData ) % 2 ] );
+    if ( sizeof( record_header_ ) <= nPadding ) { // anything shorter is read as the end of the segment
+      auto* pPadding = new( slot.p + sizeof( segment_header_ ) + ( pos % m_nData ) ) record_header_;
+      pPadding->length = nPadding;
+      pPadding->direction = padding;
+    }
+    Commit( slot, nPadding );
+    m_cv.notify_one();
+  }
+
+  slot_t& slot( m_rSlot[ ( posStart / m_nData ) % 2 ] );
+  uint8_t* p = slot.p + sizeof( segment_header_ ) + ( posStart % m_nData );
+  auto* pHeader = new( p ) record_header_;
+  pHeader->length = nRecord;
+  pHeader->idSession = idSession;
+  pHeader->idDatapath = idDatapath;
+  pHeader->ns = Now();
+  pHeader->direction = direction;
+  p += sizeof( record_header_ );
+  std::memcpy( p, p1, n1 );
+  if ( 0 != n2 ) std::memcpy( p + n1, p2, n2 );
+  Commit( slot, nRecord );
+
+  m_nRecords.fetch_add( 1, std::memory_order_relaxed );
+  m_nOctets.fetch_add( n1 + n2, std::memory_order_relaxed );
+}
+
+void Recorder::Commit( slot_t& slot, size_t nOctets ) {
+  slot.nCommitted.fetch_add( nOctets, std::memory_order_release );
+}
+
+bool Recorder::Map( slot_t& slot, uint64_t sequence ) {
+
+  const std::string sFileName( m_sBase + "." + std::to_string( sequence % m_nFiles ) + ".ofrec" );
+  slot.fd = ::open( sFileName.c_str(), O_RDWR | O_CREAT, 0644 );
+  if ( 0 > slot.fd ) {
+    std::cout << "Recorder: can not open " << sFileName << std::endl;
+    return false;
+  }
+  // truncate first, so the previous lap's records read back as zeroes
+  if ( ( 0 != ::ftruncate( slot.fd, 0 ) ) || ( 0 != ::ftruncate( slot.fd, m_nSegment ) ) ) {
+    std::cout << "Recorder: can not size " << sFileName << std::endl;
+    ::close( slot.fd );
+    slot.fd = -1;
+    return false;
+  }
+  void* p = ::mmap( nullptr, m_nSegment, PROT_READ | PROT_WRITE, MAP_SHARED, slot.fd, 0 );
+  if ( MAP_FAILED == p ) {
+    std::cout << "Recorder: can not map " << sFileName << std::endl;
+    ::close( slot.fd );
+    slot.fd = -1;
+    return false;
+  }
+  slot.p = reinterpret_cast<uint8_t*>( p );
+
+  auto* pHeader = new( slot.p ) segment_header_;
+  std::memcpy( pHeader->magic, szMagic, sizeof( pHeader->magic ) );
+  pHeader->sequence = sequence;
+  pHeader->ns = Now();
+  pHeader->octets = m_nSegment;
+  pHeader->reserved = 0;
+
+  slot.nCommitted.store( 0, std::memory_order_relaxed );
+  slot.nSynced = 0;
+  slot.sequence.store( sequence, std::memory_order_release ); // writers may now reserve in it
+  m_nSegments.fetch_add( 1, std::memory_order_relaxed );
+  return true;
+}
+
+void Recorder::Unmap( slot_t& slot, bool bSync ) {
+  if ( nullptr != slot.p ) {
+    if ( bSync ) ::msync( slot.p, m_nSegment, MS_SYNC );
+    ::munmap( slot.p, m_nSegment );
+    slot.p = nullptr;
+  }
+  if ( 0 <= slot.fd ) {
+    ::close( slot.fd );
+    slot.fd = -1;
+  }
+  slot.sequence.store( nNone, std::memory_order_relaxed );
+}
+
+// maps the next segment, retires the previous one once its writers are done, msyncs the current
+void Recorder::Run() {
+  std::unique_lock<std::mutex> lock( m_mutex );
+  while ( !m_bStop ) {
+    lock.unlock();
+
+    const uint64_t pos = m_pos.load( std::memory_order_relaxed );
+    const uint64_t sequence = ( 0 == pos ) ? 0 : ( pos - 1 ) / m_nData; // holding the last octet reserved
+    slot_t& slotNext( m_rSlot[ ( sequence + 1 ) % 2 ] );
+    const uint64_t sequenceNext = slotNext.sequence.load( std::memory_order_relaxed );
+    if ( ( sequence + 1 ) != sequenceNext ) {
+      // holds the previous segment, reservations in it have all been made, wait for them to complete
+      if ( ( nNone == sequenceNext ) || ( m_nData == slotNext.nCommitted.load( std::memory_order_acquire ) ) ) {
+        Unmap( slotNext, false ); // the kernel writes back the dirty pages
+        Map( slotNext, sequence + 1 );
+      }
+    }
+
+    slot_t& slot( m_rSlot[ sequence % 2 ] );
+    if ( sequence == slot.sequence.load( std::memory_order_relaxed ) ) {
+      const size_t nCommitted = slot.nCommitted.load( std::memory_order_acquire );
+      if ( slot.nSynced < nCommitted ) {
+        // page aligned from the start of the mapping
+        const size_t ixBegin = ( sizeof( segment_header_ ) + slot.nSynced ) & ~size_t( 4095 );
+        ::msync( slot.p + ixBegin, sizeof( segment_header_ ) + nCommitted - ixBegin, MS_ASYNC );
+        slot.nSynced = nCommitted;
+      }
+    }
+
+    lock.lock();
+    m_cv.wait_for( lock, std::chrono::milliseconds( 10 ) );
+  }
+}
+
+Recorder::stats_t Recorder::Stats() const {
+  stats_t stats;
+  stats.nRecords = m_nRecords.load( std::memory_order_relaxed );
+  stats.nOctets = m_nOctets.load( std::memory_order_relaxed );
+  stats.nDropped = m_nDropped.load( std::memory_order_relaxed );
+  stats.nSegments = m_nSegments.load( std::memory_order_relaxed );
+  return stats;
+}
+
+bool Recorder::IsSegment( const uint8_t* p, size_t n ) {
+  return ( sizeof( segment_header_ ) <= n ) && ( 0 == std::memcmp( p, szMagic, sizeof( segment_header_::magic ) ) );
+}
+
+bool Recorder::Read( const std::string& sFileName, fRecord_t f ) {
+
+  std::ifstream file( sFileName, std::ios::binary );
+  const vByte_t v( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+  if ( !IsSegment( v.data(), v.size() ) ) return false;
+
+  size_t ix = sizeof( segment_header_ );
+  while ( ( ix + sizeof( record_header_ ) ) <= v.size() ) {
+    record_header_ header;
+    std::memcpy( &header, v.data() + ix, sizeof( header ) );
+    const size_t nRecord = header.length;
+    if ( ( sizeof( record_header_ ) > nRecord ) || ( v.size() < ( ix + nRecord ) ) ) break; // end, or written part way
+    if ( padding != header.direction ) {
+      // the message's own length, the record is padded
+      const uint8_t* pMessage = v.data() + ix + sizeof( record_header_ );
+      const size_t nMessage = std::min<size_t>(
+        ( pMessage[ 2 ] << 8 ) | pMessage[ 3 ], nRecord - sizeof( record_header_ ) ); // ofp_header.length
+      f( header, pMessage, nMessage );
+    }
+    ix += nRecord;
+  }
+  return true;
+}
+
+std::ostream& operator<<( std::ostream& os, const Recorder::stats_t& stats ) {
+  os
+    << "records=" << stats.nRecords
+    << ",octets=" << stats.nOctets
+    << ",dropped=" << stats.nDropped
+    << ",segments=" << stats.nSegments
+    ;
+  return os;
+}
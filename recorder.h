@@ -0,0 +1,128 @@
+/*
+ * File:   recorder.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 10:15 PM
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <iosfwd>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <functional>
+#include <condition_variable>
+
+#include <boost/endian/arithmetic.hpp>
+
+// Flight recorder: every OpenFlow message received and transmitted, when Control is given a path.
+//   the recording rotates through a fixed number of memory mapped segment files,
+//     <base>.<n>.ofrec, overwriting the oldest, so the recent past is on disk after a crash.
+//   a record is a memcpy into the mapping: the writer reserves its space with an atomic
+//     add, so sessions' socket and writer threads record concurrently without a lock.
+//   a background thread maps the next segment ahead of time, msyncs what has been written,
+//     and retires a segment once its last writer is done.
+//   nothing blocks: a record which arrives before the next segment is ready is dropped and counted.
+// Segments are self contained, Read() walks one, Replay accepts one.
+
+class Recorder {
+public:
+
+  enum direction_t: uint8_t { padding = 0, rx = 1, tx = 2 };
+
+  // all fields little endian
+  struct segment_header_ {
+    char magic[ 8 ];                          // "OFREC001"
+    boost::endian::little_uint64_t sequence;  // segments written since the recorder started
+    boost::endian::little_uint64_t ns;        // system clock when the segment was started
+    boost::endian::little_uint32_t octets;    // segment size, this header included
+    boost::endian::little_uint32_t reserved;
+  };
+
+  struct record_header_ {
+    boost::endian::little_uint32_t length;    // this header, the message and padding to 8 octets, 0 after the last record
+    boost::endian::little_uint32_t idSession;
+    boost::endian::little_uint64_t idDatapath; // 0 until the switch's features reply
+    boost::endian::little_uint64_t ns;         // system clock
+    direction_t direction;
+    uint8_t pad[ 7 ];
+  };
+
+  struct stats_t {
+    uint64_t nRecords;
+    uint64_t nOctets;   // message octets recorded
+    uint64_t nDropped;  // next segment not ready, or larger than a segment
+    uint64_t nSegments; // segments started
+    stats_t(): nRecords( 0 ), nOctets( 0 ), nDropped( 0 ), nSegments( 0 ) {}
+  };
+
+  // throws std::runtime_error if the first segment can not be created
+  Recorder( const std::string& sBase, size_t nFiles = 4, size_t nSegmentOctets = 64 * 1024 * 1024 );
+  virtual ~Recorder();
+
+  uint32_t NewSession() { return ++m_idSession; }
+
+  // a message in up to two pieces, as when a payload follows a transmit buffer
+  void Record(
+    direction_t, uint32_t idSession, uint64_t idDatapath,
+    const uint8_t* p1, size_t n1, const uint8_t* p2 = nullptr, size_t n2 = 0 );
+
+  stats_t Stats() const;
+
+  // calls f for each record in a segment file, in the order recorded, returns false if not a segment
+  typedef std::function<void(const record_header_&, const uint8_t* pMessage, size_t nMessage)> fRecord_t;
+  static bool Read( const std::string& sFileName, fRecord_t f );
+  static bool IsSegment( const uint8_t* p, size_t n );
+
+protected:
+private:
+
+  struct slot_t {
+    std::atomic<uint64_t> sequence; // segment mapped here, nNone if none
+    uint8_t* p;                     // mapping, starting with the segment header
+    int fd;
+    std::atomic<uint64_t> nCommitted; // data octets written, the segment is finished at m_nData
+    size_t nSynced;
+    slot_t(): sequence( nNone ), p( nullptr ), fd( -1 ), nCommitted( 0 ), nSynced( 0 ) {}
+  };
+
+  static const uint64_t nNone = ~uint64_t( 0 );
+
+  const std::string m_sBase;
+  const size_t m_nFiles;
+  const size_t m_nSegment;  // file size
+  const size_t m_nData;     // less the segment header
+
+  std::array<slot_t,2> m_rSlot; // the current segment and the next, by sequence % 2
+
+  std::atomic<uint64_t> m_pos; // data octets reserved, across segments
+  std::atomic<uint32_t> m_idSession;
+
+  std::atomic<uint64_t> m_nRecords;
+  std::atomic<uint64_t> m_nOctets;
+  std::atomic<uint64_t> m_nDropped;
+  std::atomic<uint64_t> m_nSegments;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  bool m_bStop;
+  std::thread m_thread;
+
+  void Run();
+  bool Map( slot_t&, uint64_t sequence );
+  void Unmap( slot_t&, bool bSync );
+  void Commit( slot_t&, size_t nOctets );
+
+  Recorder( const Recorder& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const Recorder::stats_t& );
+
+#endif /* RECORDER_H */
@@ -0,0 +1,477 @@
+/*
+ * File:   replay.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 9:10 PM
+ */
+
+#include <set>
+#include <new>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <memory>
+#include <cstring>
+#include <ostream>
+#include <fstream>
+#include <iterator>
+#include <iostream>
+#include <algorithm>
+#include <stdexcept>
+
+#include <sys/socket.h>
+
+#include <boost/endian/conversion.hpp>
+#include <boost/endian/arithmetic.hpp>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+#include "codecs/ofp_hello.h"
+#include "codecs/ofp_header.h"
+
+#include "bridge.h"
+#include "recorder.h"
+#include "dispatcher.h"
+#include "tcp_session.h"
+#include "allocations.h"
+#include "bench.h"
+#include "replay.h"
+
+namespace {
+
+  // pcap file format, fields are in the byte order of the capturing host
+  struct pcap_header_ {
+    uint32_t magic;
+    uint16_t version_major;
+    uint16_t version_minor;
+    int32_t thiszone;
+    uint32_t sigfigs;
+    uint32_t snaplen;
+    uint32_t network; // link type
+  };
+
+  struct pcap_record_ {
+    uint32_t ts_sec;
+    uint32_t ts_fraction;
+    uint32_t incl_len;
+    uint32_t orig_len;
+  };
+
+  const uint32_t pcap_magic_usec = 0xa1b2c3d4;
+  const uint32_t pcap_magic_nsec = 0xa1b23c4d;
+
+  enum link_type { link_null = 0, link_ethernet = 1, link_linux_sll = 113 };
+
+  const uint16_t nPortOpenFlow = 6633;
+  const uint16_t nPortOpenFlowIana = 6653;
+
+  uint16_t Big16( const uint8_t* p ) { return ( p[ 0 ] << 8 ) | p[ 1 ]; }
+  uint32_t Big32( const uint8_t* p ) { return ( Big16( p ) << 16 ) | Big16( p + 2 ); }
+
+  // follows the switch to controller direction of one tcp connection
+  struct tcp_stream_t {
+    bool bLocked;
+    vByte_t source; // address and port, identifies the connection
+    uint32_t seqNext;
+    vByte_t stream;
+    tcp_stream_t(): bLocked( false ), seqNext( 0 ) {}
+
+    // p at the tcp header, n octets to the end of the ip payload
+    void Segment( const uint8_t* pAddress, size_t nAddress, const uint8_t* p, size_t n ) {
+      if ( 20 > n ) return;
+      const uint16_t portDst = Big16( p + 2 );
+      if ( ( nPortOpenFlow != portDst ) && ( nPortOpenFlowIana != portDst ) ) return;
+      const size_t nHeader = ( p[ 12 ] >> 4 ) * 4;
+      if ( ( 20 > nHeader ) || ( n < nHeader ) ) return;
+      const uint8_t* pData = p + nHeader;
+      size_t nData = n - nHeader;
+      if ( 0 == nData ) return;
+      vByte_t sourceSegment( pAddress, pAddress + nAddress );
+      sourceSegment.insert( sourceSegment.end(), p, p + 2 );
+      uint32_t seq = Big32( p + 4 );
+      if ( !bLocked ) {
+        bLocked = true;
+        source = sourceSegment;
+        seqNext = seq;
+      }
+      else {
+        if ( source != sourceSegment ) return; // another connection
+      }
+      const int32_t diff = seq - seqNext;
+      if ( 0 > diff ) { // retransmission, possibly overlapping new octets
+        if ( nData <= (size_t)-diff ) return;
+        pData += -diff;
+        nData -= -diff;
+      }
+      else {
+        if ( 0 < diff ) {
+          throw std::runtime_error( "Replay: pcap is missing octets of the switch to controller stream" );
+        }
+      }
+      stream.insert( stream.end(), pData, pData + nData );
+      seqNext += nData;
+    }
+  };
+
+} // namespace anon
+
+Replay::Replay( const std::string& sFileName ) {
+
+  std::ifstream file( sFileName, std::ios::binary );
+  if ( !file ) {
+    throw std::runtime_error( "Replay: can not open " + sFileName );
+  }
+  const vByte_t v( ( std::istreambuf_iterator<char>( file ) ), std::istreambuf_iterator<char>() );
+
+  uint32_t magic( 0 );
+  if ( sizeof( magic ) <= v.size() ) std::memcpy( &magic, v.data(), sizeof( magic ) );
+  const uint32_t magicSwapped = boost::endian::endian_reverse( magic );
+  if ( ( pcap_magic_usec == magic ) || ( pcap_magic_nsec == magic )
+    || ( pcap_magic_usec == magicSwapped ) || ( pcap_magic_nsec == magicSwapped ) ) {
+    LoadPcap( v );
+  }
+  else if ( Recorder::IsSegment( v.data(), v.size() ) ) {
+    LoadRecorder( sFileName );
+  }
+  else {
+    LoadRecords( v );
+  }
+
+  if ( m_vMessage.empty() ) {
+    throw std::runtime_error( "Replay: no OpenFlow messages in " + sFileName );
+  }
+
+  auto* pHeader = new( m_vMessage.front().data() ) ofp141::ofp_header;
+  if ( ofp141::ofp_type::OFPT_HELLO != pHeader->type ) {
+    m_vMessage.insert( m_vMessage.begin(), codec::ofp_hello::Create( vByte_t() ) );
+  }
+}
+
+Replay::~Replay() {
+}
+
+void Replay::LoadPcap( const vByte_t& v ) {
+
+  if ( sizeof( pcap_header_ ) > v.size() ) {
+    throw std::runtime_error( "Replay: pcap header is truncated" );
+  }
+
+  pcap_header_ header;
+  std::memcpy( &header, v.data(), sizeof( header ) );
+  const bool bSwap = ( pcap_magic_usec != header.magic ) && ( pcap_magic_nsec != header.magic );
+  auto Native = [bSwap]( uint32_t n )->uint32_t { return bSwap ? boost::endian::endian_reverse( n ) : n; };
+  const uint32_t network = Native( header.network );
+  if ( ( link_null != network ) && ( link_ethernet != network ) && ( link_linux_sll != network ) ) {
+    throw std::runtime_error( "Replay: pcap link type not handled" );
+  }
+
+  tcp_stream_t stream;
+
+  size_t ix = sizeof( pcap_header_ );
+  while ( ( ix + sizeof( pcap_record_ ) ) <= v.size() ) {
+
+    pcap_record_ record;
+    std::memcpy( &record, v.data() + ix, sizeof( record ) );
+    ix += sizeof( record );
+    const size_t nCaptured = Native( record.incl_len );
+    if ( ( ix + nCaptured ) > v.size() ) break; // capture was cut short
+    const uint8_t* p = v.data() + ix;
+    const uint8_t* pEnd = p + nCaptured;
+    ix += nCaptured;
+
+    // link layer, to the ethertype
+    uint16_t idEtherType( 0 );
+    switch ( network ) {
+      case link_null:
+        if ( 4 > ( pEnd - p ) ) continue;
+        idEtherType = ( 2 == ( p[ 0 ] | p[ 3 ] ) ) ? 0x0800 : 0x86dd; // AF_INET, else assume AF_INET6
+        p += 4;
+        break;
+      case link_ethernet:
+        if ( 14 > ( pEnd - p ) ) continue;
+        idEtherType = Big16( p + 12 );
+        p += 14;
+        while ( ( 0x8100 == idEtherType ) && ( 4 <= ( pEnd - p ) ) ) {
+          idEtherType = Big16( p + 2 );
+          p += 4;
+        }
+        break;
+      case link_linux_sll:
+        if ( 16 > ( pEnd - p ) ) continue;
+        idEtherType = Big16( p + 14 );
+        p += 16;
+        break;
+    }
+
+    // network layer, to the tcp header
+    switch ( idEtherType ) {
+      case 0x0800: {
+        if ( 20 > ( pEnd - p ) ) continue;
+        const size_t nHeader = ( p[ 0 ] & 0x0f ) * 4;
+        const size_t nTotal = Big16( p + 2 );
+        if ( ( 6 != p[ 9 ] ) || ( nHeader > nTotal ) || ( (size_t)( pEnd - p ) < nTotal ) ) continue;
+        stream.Segment( p + 12, 4, p + nHeader, nTotal - nHeader );
+        }
+        break;
+      case 0x86dd: {
+        if ( 40 > ( pEnd - p ) ) continue;
+        const size_t nPayload = Big16( p + 4 );
+        if ( ( 6 != p[ 6 ] ) || ( (size_t)( pEnd - p ) < ( 40 + nPayload ) ) ) continue; // no extension headers
+        stream.Segment( p + 8, 16, p + 40, nPayload );
+        }
+        break;
+    }
+  }
+
+  Frame( stream.stream );
+}
+
+// messages received on the first session found in the segment
+void Replay::LoadRecorder( const std::string& sFileName ) {
+  bool bSession( false );
+  uint32_t idSession( 0 );
+  Recorder::Read(
+    sFileName,
+    [this,&bSession,&idSession]( const Recorder::record_header_& header, const uint8_t* pMessage, size_t nMessage ){
+      if ( Recorder::rx == header.direction ) {
+        if ( !bSession ) {
+          bSession = true;
+          idSession = header.idSession;
+        }
+        if ( idSession == header.idSession ) {
+          m_vMessage.emplace_back( pMessage, pMessage + nMessage );
+        }
+      }
+    } );
+}
+
+void Replay::LoadRecords( const vByte_t& v ) {
+  vByte_t stream;
+  size_t ix( 0 );
+  while ( ix < v.size() ) {
+    if ( ( ix + sizeof( uint32_t ) ) > v.size() ) {
+      throw std::runtime_error( "Replay: record length is truncated" );
+    }
+    const size_t nRecord = Big32( v.data() + ix );
+    ix += sizeof( uint32_t );
+    if ( ( ix + nRecord ) > v.size() ) {
+      throw std::runtime_error( "Replay: record is truncated" );
+    }
+    stream.insert( stream.end(), v.begin() + ix, v.begin() + ix + nRecord );
+    ix += nRecord;
+  }
+  Frame( stream );
+}
+
+void Replay::Frame( const vByte_t& stream ) {
+  size_t ix( 0 );
+  while ( ( ix + sizeof( ofp141::ofp_header ) ) <= stream.size() ) {
+    const size_t nMessage = Big16( stream.data() + ix + 2 ); // ofp_header.length
+    if ( sizeof( ofp141::ofp_header ) > nMessage ) {
+      throw std::runtime_error( "Replay: OpenFlow message with a bad length" );
+    }
+    if ( ( ix + nMessage ) > stream.size() ) break; // recording ends part way through a message
+    m_vMessage.emplace_back( stream.begin() + ix, stream.begin() + ix + nMessage );
+    ix += nMessage;
+  }
+  if ( ix != stream.size() ) {
+    std::cout << "Replay: ignoring " << stream.size() - ix << " octets of a partial message at the end" << std::endl;
+  }
+}
+
+Replay::stats_t Replay::Run( size_t nPasses, Bridge::FirstPacket eFirstPacket ) {
+
+  typedef Pipeline::clock_t clock_t;
+
+  stats_t stats;
+
+  // the writes, packed with whole messages
+  std::vector<vByte_t> vWrite;
+  for ( size_t ixPass = 0; ixPass < nPasses; ixPass++ ) {
+    for ( const vByte_t& message: m_vMessage ) {
+      const uint8_t type = message[ 1 ]; // ofp_header.type
+      if ( ( 0 < ixPass )
+        && ( ( ofp141::ofp_type::OFPT_HELLO == type ) || ( ofp141::ofp_type::OFPT_FEATURES_REPLY == type ) ) ) continue;
+      if ( vWrite.empty() || ( max_write < ( vWrite.back().size() + message.size() ) ) ) {
+        vWrite.emplace_back();
+        vWrite.back().reserve( std::max<size_t>( max_write, message.size() ) );
+      }
+      vWrite.back().insert( vWrite.back().end(), message.begin(), message.end() );
+      stats.nMessages++;
+      stats.nOctetsIn += message.size();
+    }
+  }
+
+  // filled in by the session's threads
+  std::vector<uint64_t> vLatency( stats.nMessages );
+  std::atomic<uint64_t> nHandled( 0 );
+  std::atomic<clock_t::rep> tickLast( 0 );
+
+  Bridge bridge;
+  bridge.SetFirstPacket( eFirstPacket );
+
+  std::set<nPort_t> setInPort;
+  for ( vByte_t& message: m_vMessage ) {
+    auto* pMsg = new( message.data() ) ofp141::ofp_packet_in;
+    const uint8_t* pEnd = message.data() + message.size();
+    if ( ( ofp141::ofp_type::OFPT_PACKET_IN == pMsg->header.type )
+      && ( sizeof( ofp141::ofp_packet_in ) <= message.size() )
+      && Dispatcher::packet_in_t::Valid( *pMsg, pEnd ) ) {
+      const nPort_t nPort = Dispatcher::packet_in_t( *pMsg, pEnd ).InPort();
+      if ( 0 != nPort ) setInPort.insert( nPort );
+    }
+  }
+  for ( nPort_t nPort: setInPort ) {
+    Bridge::interface_t interface;
+    interface.tag = 1;
+    interface.eVlanMode = Bridge::VlanMode::access;
+    interface.admin_state = interface.link_state = Bridge::OpState::up;
+    interface.ofport = nPort;
+    bridge.UpdateInterface( interface );
+  }
+
+  bench::Loopback loopback;
+
+  {
+    auto pSession = std::make_shared<tcp_session>( bridge, std::move( loopback.Session() ) );
+    pSession->SetPipeline( true ); // packet_in on the workers, the socket thread only frames
+    pSession->SetHandled(
+      [&vLatency,&nHandled,&tickLast]( clock_t::duration duration ){
+        const uint64_t ix = nHandled.fetch_add( 1, std::memory_order_relaxed );
+        if ( ix < vLatency.size() ) {
+          vLatency[ ix ] = std::chrono::duration_cast<std::chrono::nanoseconds>( duration ).count();
+        }
+        tickLast.store( clock_t::now().time_since_epoch().count(), std::memory_order_relaxed );
+      } );
+    pSession->start();
+  } // the pending read holds the session
+
+  loopback.Run(); // a socket thread held up by a full pipeline leaves others to complete writes
+
+  // the switch side reads whatever the session transmits, answering barriers as a switch would
+  const int fdSwitch = loopback.Switch();
+  std::atomic<uint64_t> nOctetsOut( 0 );
+  std::mutex mutexReply;
+  vByte_t vReply; // barrier replies, sent by the writing thread between whole messages
+  std::thread threadDrain(
+    [fdSwitch,&nOctetsOut,&mutexReply,&vReply](){
+      std::vector<uint8_t> v( max_write );
+      vByte_t vStream; // a message split across reads
+      ssize_t n;
+      while ( 0 < ( n = ::recv( fdSwitch, v.data(), v.size(), 0 ) ) ) {
+        nOctetsOut.fetch_add( n, std::memory_order_relaxed );
+        vStream.insert( vStream.end(), v.begin(), v.begin() + n );
+        size_t ix( 0 );
+        while ( ( ix + sizeof( ofp141::ofp_header ) ) <= vStream.size() ) {
+          auto* pHeader = reinterpret_cast<ofp141::ofp_header*>( vStream.data() + ix );
+          const size_t nMessage = pHeader->length;
+          if ( ( sizeof( ofp141::ofp_header ) > nMessage ) || ( vStream.size() < ( ix + nMessage ) ) ) break;
+          if ( ofp141::ofp_type::OFPT_BARRIER_REQUEST == pHeader->type ) {
+            ofp141::ofp_header reply( *pHeader );
+            reply.type = ofp141::ofp_type::OFPT_BARRIER_REPLY;
+            const uint8_t* pReply = reinterpret_cast<const uint8_t*>( &reply );
+            std::lock_guard<std::mutex> lock( mutexReply );
+            vReply.insert( vReply.end(), pReply, pReply + sizeof( reply ) );
+          }
+          ix += nMessage;
+        }
+        vStream.erase( vStream.begin(), vStream.begin() + ix );
+      }
+    } );
+
+  allocations::Start();
+
+  const clock_t::time_point tpStart = clock_t::now();
+  auto fSend = [fdSwitch]( const vByte_t& v ){
+    size_t ix( 0 );
+    while ( ix < v.size() ) {
+      const ssize_t n = ::send( fdSwitch, v.data() + ix, v.size() - ix, MSG_NOSIGNAL );
+      if ( 0 > n ) throw std::runtime_error( "Replay: write to the session failed" );
+      ix += n;
+    }
+  };
+  vByte_t vReplyToSend;
+  uint64_t nReplies( 0 ); // handled by the session along with the recording's messages
+  auto fSendReplies = [&](){
+    {
+      std::lock_guard<std::mutex> lock( mutexReply );
+      vReplyToSend.swap( vReply );
+    }
+    fSend( vReplyToSend );
+    nReplies += vReplyToSend.size() / sizeof( ofp141::ofp_header );
+    vReplyToSend.clear();
+  };
+
+  for ( const vByte_t& v: vWrite ) {
+    fSend( v );
+    fSendReplies();
+  }
+
+  // wait for the last message, giving up after a quiet spell
+  uint64_t nSeen( 0 );
+  clock_t::time_point tpProgress = clock_t::now();
+  while ( nHandled.load() < ( stats.nMessages + nReplies ) ) {
+    std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+    fSendReplies();
+    const uint64_t n = nHandled.load();
+    if ( n != nSeen ) {
+      nSeen = n;
+      tpProgress = clock_t::now();
+    }
+    else {
+      if ( std::chrono::seconds( 5 ) < ( clock_t::now() - tpProgress ) ) {
+        std::cout << "Replay: gave up waiting, " << n << " of " << ( stats.nMessages + nReplies ) << " messages handled" << std::endl;
+        break;
+      }
+    }
+  }
+
+  stats.nAllocations = allocations::Stop();
+  stats.nHandled = nHandled.load();
+  if ( 0 < stats.nHandled ) {
+    const clock_t::time_point tpLast( clock_t::duration( tickLast.load() ) );
+    stats.dSeconds = std::chrono::duration<double>( tpLast - tpStart ).count();
+  }
+
+  // let the session finish transmitting what the last messages generated
+  uint64_t nOctetsOutSeen( 0 );
+  do {
+    nOctetsOutSeen = nOctetsOut.load();
+    std::this_thread::sleep_for( std::chrono::milliseconds( 20 ) );
+    fSendReplies();
+  } while ( nOctetsOutSeen != nOctetsOut.load() );
+
+  loopback.Stop();
+  threadDrain.join();
+  stats.nOctetsOut = nOctetsOut.load();
+  stats.forward = bridge.ForwardStats();
+
+  vLatency.resize( std::min<uint64_t>( stats.nHandled, vLatency.size() ) );
+  if ( !vLatency.empty() ) {
+    std::sort( vLatency.begin(), vLatency.end() );
+    stats.nsP50 = vLatency[ ( vLatency.size() - 1 ) * 50 / 100 ];
+    stats.nsP99 = vLatency[ ( vLatency.size() - 1 ) * 99 / 100 ];
+    stats.nsMax = vLatency.back();
+  }
+
+  return stats;
+}
+
+std::ostream& operator<<( std::ostream& os, const Replay::stats_t& stats ) {
+  os
+    << "messages=" << stats.nMessages
+    << ",handled=" << stats.nHandled
+    << ",octets in=" << stats.nOctetsIn
+    << ",octets out=" << stats.nOctetsOut
+    << ",seconds=" << stats.dSeconds
+    << ",messages/sec=" << (uint64_t)stats.MessagesPerSecond()
+    << ",p50 ns=" << stats.nsP50
+    << ",p99 ns=" << stats.nsP99
+    << ",max ns=" << stats.nsMax
+    << ",allocations/msg=" << stats.AllocationsPerMessage()
+    << "; " << stats.forward
+    ;
+  return os;
+}
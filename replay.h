@@ -0,0 +1,83 @@
+/*
+ * File:   replay.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 9:10 PM
+ */
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#include "common.h"
+#include "bridge.h"
+
+// Measures the controller without a switch, for the bench_replay program ( bench_replay.cpp ), not cppofc:
+//   a recorded switch to controller OpenFlow stream is written over a loopback
+//   connection into a tcp_session, so it goes through the same framing, ProcessPacket,
+//   dispatch and pipeline as live traffic; whatever the session transmits is read and discarded.
+// The recording is either
+//   a pcap (ethernet, linux cooked or loopback) of the tcp connection to port 6633 or 6653,
+//     only the first connection found is used, its octets re-assembled by sequence number,
+//   or a flight recorder segment, messages received on the first session in it are used,
+//   or a file of records, each a 4 octet big endian length followed by that many octets of the stream.
+// A HELLO is supplied if the recording does not start with one, so the bridge has its transmit path.
+// Barrier requests from the session are answered, as the switch would.
+// Every in_port found in a packet_in is given to the bridge as an access port in vlan 1.
+// The recording's messages are also what bench_match and bench_async run over, bench.h.
+
+class Replay {
+public:
+
+  struct stats_t {
+    uint64_t nMessages;    // written
+    uint64_t nHandled;     // reported handled by the session, barrier replies included
+    uint64_t nOctetsIn;    // written to the session
+    uint64_t nOctetsOut;   // transmitted by the session
+    uint64_t nAllocations; // operator new calls, all threads, while replaying
+    double dSeconds;       // first write to last message handled
+    uint64_t nsP50;        // handling latency, framed to handled
+    uint64_t nsP99;
+    uint64_t nsMax;
+    Bridge::forward_stats_t forward; // what new unicast flows cost on the wire
+    stats_t()
+    : nMessages( 0 ), nHandled( 0 ), nOctetsIn( 0 ), nOctetsOut( 0 ), nAllocations( 0 ),
+      dSeconds( 0.0 ), nsP50( 0 ), nsP99( 0 ), nsMax( 0 )
+    {}
+    double MessagesPerSecond() const { return ( 0.0 == dSeconds ) ? 0.0 : nHandled / dSeconds; }
+    double AllocationsPerMessage() const { return ( 0 == nHandled ) ? 0.0 : (double)nAllocations / nHandled; }
+  };
+
+  Replay( const std::string& sFileName ); // throws std::runtime_error when the file can not be used
+  virtual ~Replay();
+
+  typedef std::vector<vByte_t> vMessage_t;
+  const vMessage_t& Messages() const { return m_vMessage; }
+
+  // the recording is written nPasses times, HELLO and FEATURES_REPLY only on the first
+  stats_t Run( size_t nPasses = 1, Bridge::FirstPacket = Bridge::FirstPacket::direct );
+
+protected:
+private:
+
+  enum { max_write = 64 * 1024 }; // octets per write to the session
+
+  vMessage_t m_vMessage;
+
+  void LoadPcap( const vByte_t& );
+  void LoadRecorder( const std::string& sFileName );
+  void LoadRecords( const vByte_t& );
+  void Frame( const vByte_t& stream );
+
+  Replay( const Replay& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const Replay::stats_t& );
+
+#endif /* REPLAY_H */
@@ -0,0 +1,90 @@
+/*
+ * File:   spsc_ring.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 6:05 PM
+ */
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <utility>
+
+// Bounded single producer, single consumer ring.
+//   each side owns one index and only reads the other's,
+//   and keeps a cached copy of it so the shared cache line is
+//   only touched when the ring looks full (producer) or empty (consumer).
+
+template<typename T>
+class SpscRing {
+public:
+
+  explicit SpscRing( size_t nCapacity ) // nCapacity needs to be a power of two
+  : m_pSlots( new T[ nCapacity ] ), m_mask( nCapacity - 1 ),
+    m_ixHead( 0 ), m_ixTailCached( 0 ),
+    m_ixTail( 0 ), m_ixHeadCached( 0 )
+  {
+    assert( ( 2 <= nCapacity ) && ( 0 == ( nCapacity & m_mask ) ) );
+  }
+
+  size_t Capacity() const { return m_mask + 1; }
+
+  // producer: moves from t when successful, returns false when the ring is full
+  bool Push( T& t ) {
+    const size_t ixTail = m_ixTail.load( std::memory_order_relaxed );
+    if ( ( ixTail - m_ixHeadCached ) > m_mask ) {
+      m_ixHeadCached = m_ixHead.load( std::memory_order_acquire );
+      if ( ( ixTail - m_ixHeadCached ) > m_mask ) return false;
+    }
+    m_pSlots[ ixTail & m_mask ] = std::move( t );
+    m_ixTail.store( ixTail + 1, std::memory_order_release );
+    return true;
+  }
+
+  // consumer: returns false when the ring is empty
+  bool Pop( T& t ) {
+    const size_t ixHead = m_ixHead.load( std::memory_order_relaxed );
+    if ( ixHead == m_ixTailCached ) {
+      m_ixTailCached = m_ixTail.load( std::memory_order_acquire );
+      if ( ixHead == m_ixTailCached ) return false;
+    }
+    t = std::move( m_pSlots[ ixHead & m_mask ] );
+    m_ixHead.store( ixHead + 1, std::memory_order_release );
+    return true;
+  }
+
+  // either side, or an observer: a snapshot only
+  size_t Size() const {
+    const size_t ixHead = m_ixHead.load( std::memory_order_acquire );
+    return m_ixTail.load( std::memory_order_acquire ) - ixHead;
+  }
+
+  bool Empty() const { return 0 == Size(); }
+
+protected:
+private:
+
+  typedef char pad_t[ 64 ]; // keep the two sides on separate cache lines
+
+  pad_t m_pad0;
+  const std::unique_ptr<T[]> m_pSlots;
+  const size_t m_mask;
+  pad_t m_pad1;
+  std::atomic<size_t> m_ixHead; // consumer
+  size_t m_ixTailCached;
+  pad_t m_pad2;
+  std::atomic<size_t> m_ixTail; // producer
+  size_t m_ixHeadCached;
+  pad_t m_pad3;
+
+  SpscRing( const SpscRing& ) = delete;
+  SpscRing& operator=( const SpscRing& ) = delete;
+
+};
+
+#endif /* SPSC_RING_H */
+
@@ -9,8 +9,10 @@
 //
 
 #include <ostream>
+#include <sstream>
 #include <iomanip>
 #include <cstring>
+#include <thread>
 
 #include <boost/log/trivial.hpp>
 
@@ -20,9 +22,10 @@
 #include "codecs/ofp_hello.h"
 #include "codecs/ofp_switch_features.h"
 #include "codecs/ofp_async_config.h"
-#include "codecs/ofp_port_status.h"
 #include "codecs/ofp_flow_mod.h"
 #include "codecs/ofp_packet_out.h"
+#include "codecs/ofp_multipart.h"
+#include "codecs/ofp_flow_removed.h"
 
 #include "protocol/ethernet.h"
 #include "protocol/ethernet/vlan.h"
@@ -34,9 +37,10 @@
 #include "protocol/ipv6.h"
 
 #include "common.h"
-#include "hexdump.h"
+#include "logging.h"
 #include "tcp_session.h"
-#include "codecs/append.h"
+#include "codecs/builder.h"
+#include "dispatcher.h"
 
 namespace asio = boost::asio;
 
@@ -47,20 +51,95 @@ namespace asio = boost::asio;
 
 // 2018/12/08 test for more packet lengths.
 
-  tcp_session::tcp_session( Bridge& bridge, ip::tcp::socket socket)
+namespace {
+
+  // run on the logging thread, over a copy of the ofp_match
+  void FormatMatch( std::ostream& os, uint8_t* p, size_t n ) {
+    codec::ofp_match::match_fields fields;
+    codec::ofp_match::Decode( *new( p ) ofp141::ofp_match, p + n, fields );
+    os << fields;
+  }
+
+  // run on the logging thread, over a copy of the captured datagram
+  void FormatIpv4( std::ostream& os, uint8_t* p, size_t n ) {
+    protocol::ipv4::Packet ipv4( *p, n );
+    os << ipv4;
+    if ( ipv4.GetHeader().length <= n ) { // tcp and udp are shown only when captured whole
+      switch ( ipv4.GetHeader().protocol ) {
+        case 6: {// tcp
+          protocol::tcp::Packet tcp( ipv4.GetData(), ipv4.GetHeader().data_len() );
+          os << std::endl << tcp;
+          }
+          break;
+        case 17: {// udp
+          protocol::udp::Packet udp( ipv4.GetData() );
+          os << std::endl << udp;
+          }
+          break;
+      }
+    }
+  }
+
+  // octets captured from p to the end of the frame
+  size_t Captured( const Dispatcher::packet_in_t& packet, const uint8_t& p ) {
+    return packet.nCaptured - ( &p - packet.pPayload );
+  }
+
+}
+
+  tcp_session::tcp_session( Bridge& bridge, ip::tcp::socket socket, Recorder* pRecorder )
     : m_bridge( bridge ),
       m_socket( std::move( socket ) ),
-      m_transmitting( 0 )
+      m_framer( 2 * max_length ),
+      m_qTx( max_tx_queued ),
+      m_bWriterArmed( false ),
+      m_transactions( max_transactions ),
+      m_timerExpire( m_socket.get_executor() ),
+      m_bLendRxPayload( true ),
+      m_pRecorder( pRecorder ),
+      m_idSession( ( nullptr == pRecorder ) ? 0 : pRecorder->NewSession() ),
+      m_idDatapath( 0 ),
+      m_bUseSwitchBuffers( false ), m_nSwitchBuffers( 0 ),
+      m_policyAsync( DefaultAsyncPolicy() ),
+      m_intervalPortStats( 0 ),
+      m_timerPortStats( m_socket.get_executor() ),
+      m_bPosted( false ),
+      m_bPipeline( false )
   {
     BOOST_LOG_TRIVIAL(trace) << "tcp_session construction";
+    RegisterHandlers();
   }
 
   tcp_session::~tcp_session() {
-    BOOST_LOG_TRIVIAL(trace) << "tcp_session destruction";
+    if ( m_pPipeline ) {
+      m_pPipeline->Stop(); // workers use this session
+      for ( size_t ix = 0; ix < m_pPipeline->Workers(); ix++ ) {
+        BOOST_LOG_TRIVIAL(trace) << "tcp_session pipeline worker " << ix << ": " << m_pPipeline->Stats( ix );
+      }
+    }
+    BOOST_LOG_TRIVIAL(trace)
+      << "tcp_session destruction: rx " << m_framer.Stats()
+      << "; tx writes=" << m_statsTx.nWrites
+      << ",messages=" << m_statsTx.nMessages
+      << ",octets=" << m_statsTx.nOctets
+      << ",messages/write=" << m_statsTx.MessagesPerWrite()
+      << ",max messages/write=" << m_statsTx.nMaxMessagesPerWrite
+      << "; buffers " << m_bufferAvailable
+      ;
+    std::stringstream ss;
+    m_transactions.Stats( ss );
+    BOOST_LOG_TRIVIAL(trace) << "tcp_session transactions: " << ss.str();
+    if ( m_pPortStats ) {
+      BOOST_LOG_TRIVIAL(trace) << "tcp_session port stats: " << m_pPortStats->Stats();
+    }
   }
 
 void tcp_session::start() {
   try {
+    if ( m_bPipeline && !m_pPipeline ) {
+      m_pPipeline = std::make_unique<Pipeline>( pipeline_workers, pipeline_ring, [this]( Pipeline::job_t& job ){ ProcessJob( job ); } );
+    }
+    StartExpireTimer();
     do_read();
   }
   catch(...) {
@@ -68,81 +147,121 @@ void tcp_session::start() {
   }
 }
 
+// packet_in from the table miss entry and the intercepts' output to controller,
+//   ports coming and going, all flow_removed so the bridge's index stays whole;
+//   port modifications are left to ovsdb, slave masks are empty, this controller is master or equal
+codec::ofp_async_config::policy_t tcp_session::DefaultAsyncPolicy() {
+  typedef ofp141::ofp_async_config_prop_type type;
+  codec::ofp_async_config::policy_t policy;
+  policy.Set( type::OFPACPT_PACKET_IN_MASTER,
+      ( 1 << ofp141::ofp_packet_in_reason::OFPR_TABLE_MISS )
+    | ( 1 << ofp141::ofp_packet_in_reason::OFPR_APPLY_ACTION ) );
+  policy.Set( type::OFPACPT_PORT_STATUS_MASTER,
+      ( 1 << ofp141::ofp_port_reason::OFPPR_ADD )
+    | ( 1 << ofp141::ofp_port_reason::OFPPR_DELETE ) );
+  policy.Set( type::OFPACPT_FLOW_REMOVED_MASTER,
+      ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_IDLE_TIMEOUT )
+    | ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_HARD_TIMEOUT )
+    | ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_DELETE )
+    | ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_GROUP_DELETE )
+    | ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_METER_DELETE )
+    | ( 1 << ofp141::ofp_flow_removed_reason::OFPRR_EVICTION ) );
+  return policy;
+}
+
+void tcp_session::SetPortStats( std::chrono::milliseconds interval, PortStats::fPublish_t fPublish ) {
+  m_intervalPortStats = interval;
+  m_pPortStats = std::make_unique<PortStats>( std::move( fPublish ) );
+}
+
+// holds only a weak reference, the session goes when its socket does
+void tcp_session::StartPortStatsTimer( std::chrono::milliseconds delay ) {
+  std::weak_ptr<tcp_session> wpSelf( shared_from_this() );
+  m_timerPortStats.expires_after( delay );
+  m_timerPortStats.async_wait(
+    [wpSelf]( const boost::system::error_code& ec ){
+      if ( ec ) return; // cancelled
+      auto self( wpSelf.lock() );
+      if ( self ) self->PollPortStats();
+    } );
+}
+
+// the reply is decoded straight into the counter array, the next poll is timed from the end of this one
+void tcp_session::PollPortStats() {
+  PortStats* pPortStats( m_pPortStats.get() );
+  pPortStats->Begin();
+  codec::ofp_multipart::visitor_t visitor;
+  visitor.fPort = [pPortStats]( const codec::ofp_multipart::port_t& port ){ pPortStats->Visit( port ); };
+  std::weak_ptr<tcp_session> wpSelf( shared_from_this() );
+  Dump(
+    ofp141::ofp_multipart_type::OFPMP_PORT_STATS, visitor,
+    [wpSelf]( Multipart::status_t status, const Multipart::stats_t& ){
+      auto self( wpSelf.lock() );
+      if ( self ) {
+        self->m_pPortStats->End( Multipart::status_t::complete == status );
+        self->PollMeterStats();
+      }
+    } );
+}
+
+// meter records go straight to the bridge, which notes what each class shed since the previous poll
+void tcp_session::PollMeterStats() {
+  Bridge* pBridge( &m_bridge );
+  codec::ofp_multipart::visitor_t visitor;
+  visitor.fMeter = [pBridge]( const codec::ofp_multipart::meter_t& meter ){ pBridge->UpdateMeter( meter ); };
+  std::weak_ptr<tcp_session> wpSelf( shared_from_this() );
+  Dump(
+    ofp141::ofp_multipart_type::OFPMP_METER, visitor,
+    [wpSelf]( Multipart::status_t, const Multipart::stats_t& ){
+      auto self( wpSelf.lock() );
+      if ( self ) self->StartPortStatsTimer( self->m_intervalPortStats );
+    } );
+}
+
+// holds only a weak reference, the session goes when its socket does
+void tcp_session::StartExpireTimer() {
+  std::weak_ptr<tcp_session> wpSelf( shared_from_this() );
+  m_timerExpire.expires_after( std::chrono::milliseconds( expire_interval_ms ) );
+  m_timerExpire.async_wait(
+    [wpSelf]( const boost::system::error_code& ec ){
+      if ( ec ) return; // cancelled
+      auto self( wpSelf.lock() );
+      if ( self ) {
+        self->m_transactions.Expire();
+        self->StartExpireTimer();
+      }
+    } );
+}
+
 void tcp_session::do_read() {
   //std::cout << "do_read begin: " << std::endl;
-  // going to need to perform serialization as bytes come in (multiple packets joined together)?
+  // multiple packets may arrive joined together, or split across reads,
+  //   the framer keeps any partial message in place until the remainder arrives
   auto self(shared_from_this());
-  m_vRx.resize( max_length );  // TODO: supply multiple buffers?
-  m_socket.async_read_some(boost::asio::buffer(m_vRx),
+  m_socket.async_read_some(boost::asio::buffer( m_framer.Tail(), m_framer.TailSize() ),
       [this, self](boost::system::error_code ec, const std::size_t lenRead)
       {
         //std::cout << "async_read begin: " << std::endl;
         if (!ec) {
-          std::cout << ">>> total read length: " << lenRead << std::endl;
-
-          // inbound data arrives
-          // if reassembly data available;
-          //    append to reassembly buffer,
-          //    clear inbound buffer
-          //    move adjusted reassembly buffer to inbound buffer
-          // loop on input buffer:
-          //   if less then header size:
-          //     move remaining octets to reassembly buffer
-          //     exit loop for more
-          //   if less than header.length:
-          //     move remaining octets to reassembly buffer
-          //     exit loop for more
-          //   if >= header.length:
-          //     process packet
-          //     move beginning to end
-          //     loop for more
-
-          std::size_t length = lenRead;
-
-          if ( 0 != m_vReassembly.size() ) {
-            m_vReassembly.insert( m_vReassembly.end(), m_vRx.begin(), m_vRx.begin() + lenRead );
-            m_vRx.clear();
-            m_vRx = std::move( m_vReassembly );
-            length = m_vRx.size();
+          LOG_TRACE( ">>> total read length: {}", lenRead );
+
+          const bool bFramed = m_framer.Commit(
+            lenRead,
+            [this]( uint8_t* pBegin, const uint8_t* pEnd ){
+              ProcessPacket( pBegin, pEnd );
+            } );
+          if ( !bFramed ) {
+            LOG_WARNING( "message length shorter than its header, closing the session" );
+            boost::system::error_code ecClose;
+            m_socket.close( ecClose );
+            return; // no further read, the session goes once pending handlers let go of it
           }
 
-          vByte_iter_t iterBegin = m_vRx.begin();
-          vByte_iter_t iterEnd = iterBegin + length;
-
-          ofp141::ofp_header* pOfpHeader;
-          bool bReassemble( false );
-
-          bool bLooping( true );
-
-          while ( bLooping ) {
-
-            auto nOctetsRemaining = iterEnd - iterBegin;
-
-            if ( nOctetsRemaining < sizeof( ofp141::ofp_header ) ) bReassemble = true;
-            else {
-              pOfpHeader = new( &(*iterBegin) ) ofp141::ofp_header;
-              if ( nOctetsRemaining < pOfpHeader->length ) bReassemble = true;
-            }
-
-            if ( bReassemble ) {
-              // wait for more octets
-              m_vReassembly = std::move( m_vRx );
-              bLooping = false;
-            }
-            else {
-              // normal packet processing
-              uint8_t* pBegin = &(*iterBegin);
-              ProcessPacket( pBegin, pBegin + pOfpHeader->length );
-              iterBegin += pOfpHeader->length;
-              bLooping = iterBegin != iterEnd;
-           }
-          }
-
-          std::cout << "<<< end." << std::endl;
+          LOG_TRACE( "<<< end." );
 
         } // end if ( ec )
         else {
-          std::cout << "read error: " << ec.value() << "," << ec.message() << std::endl;
+          LOG_WARNING( "read error: {},{}", ec.value(), ec.message() );
           if ( 2 == ec.value() ) {
             assert( 0 );  // 'End of file', so need to re-open, or abort
           }
@@ -163,348 +282,435 @@ void tcp_session::ProcessPacket( uint8_t* pBegin, const uint8_t* pEnd ) {
   assert( 0 < diff );
   if ( pHeader->length <= diff ) {}
   else {
-    auto len = pHeader->length;
-    std::cout << "problem (expected,supplied): " << len << "," << diff << std::endl;
+    LOG_WARNING( "problem (expected,supplied): {},{}", (uint16_t)pHeader->length, (int64_t)diff );
     assert( 0 );
   }
 
-  if ( false ) {
-    std::cout
-      << "IN: "
-      << HexDump<const uint8_t*>( pBegin, pEnd )
-      << std::endl;
-  }
-
-  if ( false ) {
-    std::cout
-      <<  "  ver=" << (uint16_t)pHeader->version
-      << ", type=" << (uint16_t)pHeader->type
-      <<  ", len=" << pHeader->length
-      <<  ", xid=" << pHeader->xid
-      << std::endl;
-  }
-
-  if ( OFP_VERSION == pHeader->version ) {
-    switch (pHeader->type) {
-      case ofp141::ofp_type::OFPT_HELLO: {
-        // need to wrap following in try/catch
-        const auto pHello = new(pBegin) ofp141::ofp_hello;
-        codec::ofp_hello hello( *pHello );
-        // do some processing
-        //  then send hello back
-        QueueTxToWrite( std::move( codec::ofp_hello::Create( std::move( GetAvailableBuffer() ) ) ) );
-        QueueTxToWrite( std::move( codec::ofp_switch_features::CreateRequest( std::move( GetAvailableBuffer() ) ) ) );
-
-        // Start bridge to update groups and forwarding rules
-        // TODO: need a strand for the bridge?  What threads use the bridge?
-        //std::cout << "** tcp_session::m_bRulesInjectionActive calling StartRulesInjection" << std::endl;
-        m_bridge.StartRulesInjection(
-          // fAcquireBuffer
-          [this]()->vByte_t{
-            return std::move( GetAvailableBuffer() );
-          },
-          // fTransmitBuffer
-          [this]( vByte_t v ){
-            QueueTxToWrite( std::move( v ) );
-          } );
-
-        // this table miss entry then starts to generate Packet_in messages
-        vByte_t v = std::move( GetAvailableBuffer() );
-        v.clear();
-
-        auto* pMod = ofp::Append<codec::ofp_flow_mod::ofp_flow_mod_>( v );
-        pMod->init();
-        pMod->cookie = 0x101;
-
-        auto* pActions = ofp::Append<codec::ofp_flow_mod::ofp_instruction_actions_>( v );
-        pActions->init();
-
-        auto* pAction = ofp::Append<codec::ofp_flow_mod::ofp_action_output_>( v );
-        pAction->init();  // defaults to controller
-        pAction->max_len = ofp141::ofp_controller_max_len::OFPCML_NO_BUFFER;
-
-        pActions->len += sizeof( codec::ofp_flow_mod::ofp_action_output_ );
-
-        pMod->header.length = v.size();
-
-        std::cout
-          << "Sent MissFlow flow entry: "
-          << HexDump<vByte_iter_t>( v.begin(), v.end() )
-          << std::endl;
-        QueueTxToWrite( std::move( v ) );
-
-        // TODO:  install two flows (higher priority than default packet_in):
-        //   match src broadcast -> drop (should there be such an animal?)
-        //   match dst broadcast -> flood
+  LOG_TRACE( "IN: ver={} type={} len={} xid={}: {}",
+    (uint16_t)pHeader->version, (uint16_t)pHeader->type, (uint16_t)pHeader->length, (uint32_t)pHeader->xid,
+    logging::hex( pBegin, pEnd - pBegin ) );
 
-        }
-        break;
-      case ofp141::ofp_type::OFPT_PACKET_IN: { // v1.4.1 page 140
-
-        // rather than flood (output), re-use the table when possible
-        // now should be able to modularize this code
-
-        const auto pPacket = new(pBegin) ofp141::ofp_packet_in;
-        std::cout
-          << "packet in meta: "
-          << "bufid=" << std::hex << pPacket->buffer_id << std::dec
-          << ", total_len=" << pPacket->total_len
-          << ", reason=" << (uint16_t)pPacket->reason
-          << ", tabid=" << (uint16_t)pPacket->table_id
-          << ", cookie=" << pPacket->cookie
-          << ", match type=" << pPacket->match.type
-          << ", match len=" << pPacket->match.length
-          << ", match=" // section 7.2.2 page 63
-          << HexDump<boost::endian::big_uint8_t*>( pPacket->match.oxm_fields, pPacket->match.oxm_fields + pPacket->match.length - 4 )
-          << ::std::endl;
-
-        auto pMatch = new( &pPacket->match ) codec::ofp_flow_mod::ofp_match_;
-        const auto pPayload = pBegin + pPacket->header.length - pPacket->total_len;
-        std::cout
-          << "  content: "
-          << HexDump<uint8_t*>( pPayload, pPayload + pPacket->total_len )
-          << ::std::endl;
-
-        protocol::ethernet::header ethernet( *pPayload ); // pull out ethernet header
-        std::cout << ethernet << ::std::endl;
-
-        // expand on this to enable routing, for now, is just random information
-        uint16_t idVlan( 0 ); // init to 0 if no 802.1q header found (will need to deal with QinQ at some point)
-        uint8_t* pMessage( nullptr ); // depending upon 802.1q shim, calculate message location
-        uint16_t idEtherType( 0 );
-        bool bDecoded( false );
-
-        if ( protocol::ethernet::Ethertype::ieee8021q == ethernet.GetEthertype() ) {
-          ethernet::vlan vlan( ethernet.GetMessage() );
-          std::cout << "found vlan: " << vlan << ::std::endl;
-          idVlan = vlan.GetVID();
-          pMessage = &vlan.GetMessage();
-          idEtherType = vlan.GetEthertype();
-        }
-        else {
-          pMessage = &ethernet.GetMessage();
-          idEtherType = ethernet.GetEthertype();
-        }
+  if ( nullptr != m_pRecorder ) {
+    m_pRecorder->Record(
+      Recorder::rx, m_idSession, m_idDatapath.load( std::memory_order_relaxed ), pBegin, pHeader->length );
+  }
 
-        bool bForward( false );
-
-        switch ( idEtherType ) {
-          case protocol::ethernet::Ethertype::arp: { // dealt with further down
-
-            if ( 0x102 != pPacket->cookie ) {
-              std::cout << "**** arp, expected cookie 0x102, not " << pPacket->cookie << std::endl;
-            }
-
-            pMatch->decode(
-              [this, idVlan, &ethernet, pMessage, pPayload, length = pPacket->total_len](nPort_t nSrcPort) {
-
-                protocol::ipv4::arp::ethernet arp( *pMessage );
-                std::cout << arp << ::std::endl;
-
-                m_arpCache.Update( arp );
-
-                typedef protocol::ethernet::address MacAddress;
-
-                MacAddress macSrc( ethernet.GetSrcMac() );
-                MacAddress macDst( ethernet.GetDstMac() );
-
-                Bridge::MacStatus statusSrcLookup = m_bridge.Update( nSrcPort, idVlan, macSrc );
-                m_bridge.Forward( nSrcPort, idVlan, macSrc, macDst, pPayload, length );
-
-              } ); // process match fields via the lambda
-            bDecoded = true;
-
-            }
-            break;
-          case protocol::ethernet::Ethertype::ieee8021q: {  // 802.1q vlan (shouldn't be able to get here )
-            ethernet::vlan vlan( *pMessage );
-            std::cout << "bad vlan in vlan found: " << vlan << ::std::endl;
-            assert( 0 ); // not dealing with vlan in vlan
-            }
-            break;
-          case protocol::ethernet::Ethertype::ipv4: {
-              protocol::ipv4::Packet ipv4( *pMessage, pPacket->total_len - ( pMessage - pPayload ) );
-              std::cout << ipv4 << ::std::endl;
-
-              switch ( ipv4.GetHeader().protocol ) {
-                case 6: {// tcp
-                  protocol::tcp::Packet tcp( ipv4.GetData(), ipv4.GetHeader().data_len() );
-                  std::cout << tcp << ::std::endl;
-                  }
-                  break;
-                case 17: {// udp
-                  protocol::udp::Packet udp( ipv4.GetData() );
-                  std::cout << udp << ::std::endl;
-                  if (
-                    ( 53 == udp.GetHeader().dst_port ) ||
-                    ( 53 == udp.GetHeader().src_port )
-                    )
-                  {
-                    if ( 0x104 != pPacket->cookie ) {
-                      std::cout << "**** dns, expected cookie 0x104, not " << pPacket->cookie << std::endl;
-                    }
-
-                    pMatch->decode(
-                      [this, idVlan, &ethernet, &udp, pMessage, pPayload, length = pPacket->total_len](nPort_t nSrcPort){
-
-                        protocol::dns::Packet dns( udp.GetData() );
-                        std::cout << "cookie 104: " << dns << ::std::endl;
-
-                        typedef protocol::ethernet::address MacAddress;
-
-                        MacAddress macSrc( ethernet.GetSrcMac() );
-                        MacAddress macDst( ethernet.GetDstMac() );
-
-                        Bridge::MacStatus statusSrcLookup = m_bridge.Update( nSrcPort, idVlan, macSrc );
-                        m_bridge.Forward( nSrcPort, idVlan, macSrc, macDst, pPayload, length );
-                      }
-                    );
-                    bDecoded = true;
-                  }
-                  if (
-                    ( 67 == udp.GetHeader().dst_port ) || // to server
-                    ( 68 == udp.GetHeader().dst_port ) )  // to client
-                  {
-
-                    if ( 0x103 != pPacket->cookie ) {
-                      std::cout << "**** dhcp, expected cookie 0x103, not " << pPacket->cookie << std::endl;
-                    }
-
-                    pMatch->decode(
-                      [this, idVlan, &ethernet, &udp, pMessage, pPayload, length = pPacket->total_len](nPort_t nSrcPort){
-
-                        protocol::ipv4::dhcp::Packet dhcp( udp.GetData() );
-                        std::cout << "cookie 103: " << dhcp << ::std::endl;
-
-                        typedef protocol::ethernet::address MacAddress;
-
-                        MacAddress macSrc( ethernet.GetSrcMac() );
-                        MacAddress macDst( ethernet.GetDstMac() );
-
-                        Bridge::MacStatus statusSrcLookup = m_bridge.Update( nSrcPort, idVlan, macSrc );
-                        m_bridge.Forward( nSrcPort, idVlan, macSrc, macDst, pPayload, length );
-                      }
-                    );
-                    bDecoded = true;
-                  }
-                  break;
-                }
-              }
-            }
-            break;
-          case protocol::ethernet::Ethertype::ipv6: {
-            protocol::ipv6::Packet ipv6( *pMessage );
-            std::cout << ipv6 << ::std::endl;
-            }
-            break;
-        }
+  m_tpReceived = Pipeline::clock_t::now();
+  m_bPosted = false;
+  m_dispatcher.Dispatch( pBegin, pEnd );
+  if ( m_fHandled && !m_bPosted ) {
+    m_fHandled( Pipeline::clock_t::now() - m_tpReceived );
+  }
+  //do_read();  // keep the socket open with another read
+}
 
-        if ( !bDecoded ) { // TODO: factor out and 'Forward' based upon flag
-          if ( 0x101 == pPacket->cookie ) { // nSrcPort_ comes from match decode
-            pMatch->decode( // for decoding the IN_PORT to supply to the bridge
-              [this, idVlan, &ethernet, pPayload, length = pPacket->total_len](nPort_t nSrcPort) {
+// message handlers, by ofp_type, then packet_in by flow cookie
+void tcp_session::RegisterHandlers() {
+
+  m_dispatcher.Register<ofp141::ofp_hello>(
+    ofp141::ofp_type::OFPT_HELLO,
+    [this]( ofp141::ofp_hello& msg, const uint8_t* ){ HandleHello( msg ); } );
+  m_dispatcher.Register<ofp141::ofp_packet_in>(
+    ofp141::ofp_type::OFPT_PACKET_IN,
+    [this]( ofp141::ofp_packet_in& msg, const uint8_t* pEnd ){ HandlePacketIn( msg, pEnd ); } );
+  m_dispatcher.Register<ofp141::ofp_error_msg>(
+    ofp141::ofp_type::OFPT_ERROR,
+    [this]( ofp141::ofp_error_msg& msg, const uint8_t* ){ HandleError( msg ); } );
+  m_dispatcher.Register<ofp141::ofp_switch_features>(
+    ofp141::ofp_type::OFPT_FEATURES_REPLY,
+    [this]( ofp141::ofp_switch_features& msg, const uint8_t* ){ HandleFeaturesReply( msg ); } );
+  m_dispatcher.Register<ofp141::ofp_header>(
+    ofp141::ofp_type::OFPT_ECHO_REQUEST,
+    [this]( ofp141::ofp_header& msg, const uint8_t* ){ HandleEchoRequest( msg ); } );
+  m_dispatcher.Register<ofp141::ofp_async_config>(
+    ofp141::ofp_type::OFPT_GET_ASYNC_REPLY,
+    [this]( ofp141::ofp_async_config& msg, const uint8_t* pEnd ){ HandleGetAsyncReply( msg, pEnd ); } );
+  m_dispatcher.Register<ofp141::ofp_port_status>(
+    ofp141::ofp_type::OFPT_PORT_STATUS,
+    [this]( ofp141::ofp_port_status& msg, const uint8_t* ){ HandlePortStatus( msg ); } );
+  m_dispatcher.Register<ofp141::ofp_header>(
+    ofp141::ofp_type::OFPT_BARRIER_REPLY,
+    [this]( ofp141::ofp_header& msg, const uint8_t* pEnd ){ HandleBarrierReply( msg, pEnd ); } );
+  m_dispatcher.Register<ofp141::ofp_bundle_ctrl_msg>(
+    ofp141::ofp_type::OFPT_BUNDLE_CONTROL,
+    [this]( ofp141::ofp_bundle_ctrl_msg& msg, const uint8_t* pEnd ){ HandleBundleControl( msg, pEnd ); } );
+  m_dispatcher.Register<ofp141::ofp_flow_removed>(
+    ofp141::ofp_type::OFPT_FLOW_REMOVED,
+    [this]( ofp141::ofp_flow_removed& msg, const uint8_t* pEnd ){ HandleFlowRemoved( msg, pEnd ); } );
+  m_dispatcher.Register<ofp141::ofp_multipart_reply>(
+    ofp141::ofp_type::OFPT_MULTIPART_REPLY,
+    [this]( ofp141::ofp_multipart_reply& msg, const uint8_t* pEnd ){ HandleMultipartReply( msg, pEnd ); } );
+
+  // cookies of the flows sending to the controller
+  m_dispatcher.RegisterCookie( 0x101, [this]( Dispatcher::packet_in_t& packet ){ HandleTableMiss( packet ); } );
+  m_dispatcher.RegisterCookie( 0x102, [this]( Dispatcher::packet_in_t& packet ){ HandleArp( packet ); } );
+  m_dispatcher.RegisterCookie( 0x103, [this]( Dispatcher::packet_in_t& packet ){ HandleDhcp( packet ); } );
+  m_dispatcher.RegisterCookie( 0x104, [this]( Dispatcher::packet_in_t& packet ){ HandleDns( packet ); } );
+  m_dispatcher.RegisterCookieDefault(
+    []( Dispatcher::packet_in_t& packet ){
+      LOG_WARNING( "*****  undecoded packet with cookie {}", packet.msg.cookie );
+    } );
+}
 
-              typedef protocol::ethernet::address MacAddress;
+void tcp_session::HandleHello( ofp141::ofp_hello& msg ) {
+  // need to wrap following in try/catch
+  codec::ofp_hello hello( msg );
+  // do some processing
+  //  then send hello back
+  QueueTxToWrite( std::move( codec::ofp_hello::Create( std::move( GetAvailableBuffer( sizeof( codec::ofp_hello::ofp_hello_ ) ) ) ) ) );
+  QueueTxToWrite( std::move( codec::ofp_switch_features::CreateRequest( std::move( GetAvailableBuffer( sizeof( codec::ofp_header::ofp_header_ ) ) ) ) ) );
+
+  // Start bridge to update groups and forwarding rules
+  // TODO: need a strand for the bridge?  What threads use the bridge?
+  //std::cout << "** tcp_session::m_bRulesInjectionActive calling StartRulesInjection" << std::endl;
+  m_bridge.StartRulesInjection(
+    // fAcquireBuffer
+    [this]( size_t nOctets )->vByte_t{
+      return std::move( GetAvailableBuffer( nOctets ) );
+    },
+    // fTransmitBuffer
+    [this]( vByte_t v ){
+      QueueTxToWrite( std::move( v ) );
+    },
+    // fTransmitWithPayload
+    [this]( vByte_t v, const Bridge::payload_t& payload ){
+      QueueTxToWrite( std::move( v ), payload );
+    },
+    // fTransmitRequest
+    [this]( vByte_t v, Bridge::fCompletion_t fCompletion ){
+      Request(
+        std::move( v ), std::chrono::milliseconds( 5000 ),
+        [fCompletion]( const ofp141::ofp_header&, const uint8_t* ){ fCompletion( true ); },
+        [fCompletion]( const ofp141::ofp_error_msg* ){ fCompletion( false ); } );
+    },
+    // fTransmitTracked, an error reply fails it, the window passing quietly is its success;
+    //   with the transaction table full it goes untracked, and is taken as applied
+    [this]( vByte_t v, Bridge::fCompletion_t fCompletion ){
+      auto* pHeader = new( v.data() ) codec::ofp_header::ofp_header_;
+      const uint32_t xid = m_transactions.NewXid();
+      pHeader->xid = xid;
+      const bool bTracked = m_transactions.Track(
+        xid, ofp141::ofp_type( (uint8_t)pHeader->type ), std::chrono::milliseconds( tracked_window_ms ),
+        [fCompletion]( const ofp141::ofp_header&, const uint8_t* ){ fCompletion( true ); },
+        [fCompletion]( const ofp141::ofp_error_msg* pMsg ){ fCompletion( nullptr == pMsg ); } );
+      QueueTxToWrite( std::move( v ) );
+      if ( !bTracked ) fCompletion( true );
+    } );
+
+  // the table miss entry goes in once the features reply says whether the switch buffers
+
+  // TODO:  install two flows (higher priority than default packet_in):
+  //   match src broadcast -> drop (should there be such an animal?)
+  //   match dst broadcast -> flood
+}
 
-              MacAddress macSrc( ethernet.GetSrcMac() );
-              MacAddress macDst( ethernet.GetDstMac() );
+void tcp_session::HandlePacketIn( ofp141::ofp_packet_in& msg, const uint8_t* pEnd ) { // v1.4.1 page 140
 
-              Bridge::MacStatus statusSrcLookup = m_bridge.Update( nSrcPort, idVlan, macSrc );
-              m_bridge.Forward( nSrcPort, idVlan, macSrc, macDst, pPayload, length );
+  if ( m_pPipeline ) { // decode and forward on a worker, keyed by in_port to keep per port order
+    Pipeline::job_t job;
+    job.tpReceived = m_tpReceived;
+    job.pHolder = m_framer.Lend();
+    if ( job.pHolder ) {
+      job.pBegin = reinterpret_cast<uint8_t*>( &msg );
+      job.pEnd = pEnd;
+    }
+    else { // all receive slabs are held, take a copy
+      auto pCopy = std::make_shared<vByte_t>( reinterpret_cast<const uint8_t*>( &msg ), pEnd );
+      job.pBegin = pCopy->data();
+      job.pEnd = pCopy->data() + pCopy->size();
+      job.pHolder = std::move( pCopy );
+    }
+    m_pPipeline->Post( codec::ofp_match::InPort( msg.match, pEnd ), job ); // the one field needed here
+    m_bPosted = true;
+  }
+  else {
+    DispatchPacketIn( msg, pEnd, nullptr );
+  }
+}
 
-              }
-            );
-          }
-          else {
-            std::cout << "*****  undecoded packet with cookie " << pPacket->cookie << std::endl;
-          }
-        }
+// on a pipeline worker
+void tcp_session::ProcessJob( Pipeline::job_t& job ) {
+  auto* pMsg = new( job.pBegin ) ofp141::ofp_packet_in;
+  DispatchPacketIn( *pMsg, job.pEnd, job.pHolder );
+  if ( m_fHandled ) {
+    m_fHandled( Pipeline::clock_t::now() - job.tpReceived );
+  }
+}
 
-        if ( bForward ) {
-          // some thinking to do, as the nSrcPort is needed here
-          // may not need the lambda's any more?  depends upon sophistication of the match parsing.
-          // in addition to setting bFoward, need to assign nSrcPort for availability here
-          // or pass into the lambda, the forwarding function
-        }
+// the one decode of a packet_in, on a pipeline worker or, without one, on the socket thread
+void tcp_session::DispatchPacketIn( ofp141::ofp_packet_in& msg, const uint8_t* pEnd, std::shared_ptr<const vByte_t> pHolder ) {
 
-        break;
-        }
-      case ofp141::ofp_type::OFPT_ERROR: { // v1.4.1 page 148
-        const auto pError = new(pBegin) ofp141::ofp_error_msg;
-        std::cout
-          << "Error type " << pError->type
-          << " code " << pError->code
-          << std::endl;
-        break;
-        }
-      case ofp141::ofp_type::OFPT_FEATURES_REPLY: {
-        const auto pReply = new(pBegin) ofp141::ofp_switch_features;
-        codec::ofp_switch_features features( *pReply );
-
-        // 1.4.1 page 138
-        vByte_t v = std::move( GetAvailableBuffer() );
-        v.resize( sizeof( codec::ofp_header::ofp_header_ ) );
-        auto* p = new( v.data() ) codec::ofp_header::ofp_header_;
-        p->init();
-        p->type = ofp141::ofp_type::OFPT_GET_ASYNC_REQUEST;
-        codec::ofp_header::NewXid( *p );
-        QueueTxToWrite( std::move( v ) );
+  // rather than flood (output), re-use the table when possible
 
+  if ( ( reinterpret_cast<const uint8_t*>( &msg.match ) + 4 ) <= pEnd ) { // match header present
+    const size_t nOxm = std::min<size_t>( msg.match.length - 4, pEnd - reinterpret_cast<const uint8_t*>( msg.match.oxm_fields ) );
+    LOG_TRACE(
+      "packet in meta: bufid={}, total_len={}, reason={}, tabid={}, cookie={}, match type={}, match len={}, match={}",
+      logging::hex( &msg.buffer_id, sizeof( msg.buffer_id ), 0 ), msg.total_len, msg.reason, msg.table_id, msg.cookie,
+      msg.match.type, msg.match.length, logging::hex( msg.match.oxm_fields, nOxm ) // section 7.2.2 page 63
+      );
+  }
+
+  if ( !Dispatcher::packet_in_t::Valid( msg, pEnd ) ) {
+    LOG_WARNING( "**** packet_in too short for its match and an ethernet header" );
+    return;
+  }
+
+  Dispatcher::packet_in_t packet( msg, pEnd );
+  packet.pHolder = std::move( pHolder );
+
+  if ( !packet.Complete() && ( OFP_NO_BUFFER == packet.idBuffer ) ) {
+    LOG_WARNING( "**** truncated packet_in without a buffer_id" );
+  }
+  LOG_TRACE( "  content: {}", logging::hex( packet.pPayload, packet.nCaptured ) );
+  LOG_TRACE( "{}", logging::Deferred<protocol::ethernet::header>( packet.pPayload, packet.nCaptured ) );
+  if ( 0 != packet.idVlan ) {
+    LOG_TRACE( "found vlan: {}", packet.idVlan );
+  }
+
+  m_dispatcher.Dispatch( packet );
+}
+
+// cookie 0x101, the table miss flow
+void tcp_session::HandleTableMiss( Dispatcher::packet_in_t& packet ) {
+
+  // expand on this to enable routing, for now, is just random information
+  switch ( packet.idEtherType ) {
+    case protocol::ethernet::Ethertype::arp: {
+      protocol::ipv4::arp::ethernet arp( *packet.pMessage );
+      LOG_TRACE( "{}", logging::Deferred<protocol::ipv4::arp::ethernet>( packet.pMessage, Captured( packet, *packet.pMessage ) ) );
+      m_arpCache.Update( arp );
+      }
+      break;
+    case protocol::ethernet::Ethertype::ieee8021q: {  // 802.1q vlan (shouldn't be able to get here )
+      LOG_ERROR( "bad vlan in vlan found: {}", logging::Deferred<ethernet::vlan>( packet.pMessage, Captured( packet, *packet.pMessage ) ) );
+      assert( 0 ); // not dealing with vlan in vlan
+      }
+      break;
+    case protocol::ethernet::Ethertype::ipv4:
+      LOG_TRACE( "{}", logging::deferred( FormatIpv4, packet.pMessage, Captured( packet, *packet.pMessage ) ) );
+      break;
+    case protocol::ethernet::Ethertype::ipv6:
+      LOG_TRACE( "{}", logging::Deferred<protocol::ipv6::Packet>( packet.pMessage, Captured( packet, *packet.pMessage ) ) );
+      break;
+  }
+
+  ForwardPacketIn( packet );
+}
+
+// cookie 0x102, arp intercept
+void tcp_session::HandleArp( Dispatcher::packet_in_t& packet ) {
+  if ( protocol::ethernet::Ethertype::arp == packet.idEtherType ) {
+    protocol::ipv4::arp::ethernet arp( *packet.pMessage );
+    LOG_TRACE( "{}", logging::Deferred<protocol::ipv4::arp::ethernet>( packet.pMessage, Captured( packet, *packet.pMessage ) ) );
+    m_arpCache.Update( arp );
+  }
+  else {
+    const boost::endian::big_uint16_t idEtherType( packet.idEtherType );
+    LOG_WARNING( "**** cookie 0x102, expected arp, not ethertype {}", logging::hex( &idEtherType, sizeof( idEtherType ), 0 ) );
+  }
+  ForwardPacketIn( packet );
+}
+
+// cookie 0x103, dhcp intercept
+void tcp_session::HandleDhcp( Dispatcher::packet_in_t& packet ) {
+  bool bDecoded( false );
+  if ( ( protocol::ethernet::Ethertype::ipv4 == packet.idEtherType ) && packet.Complete() ) { // dhcp is decoded past the headers
+    protocol::ipv4::Packet ipv4( *packet.pMessage, packet.msg.total_len - ( packet.pMessage - packet.pPayload ) );
+    if ( 17 == ipv4.GetHeader().protocol ) {
+      protocol::udp::Packet udp( ipv4.GetData() );
+      LOG_TRACE( "cookie 103: {}", logging::Deferred<protocol::ipv4::dhcp::Packet>( &udp.GetData(), Captured( packet, udp.GetData() ) ) );
+      bDecoded = true;
+    }
+  }
+  if ( !bDecoded ) {
+    LOG_WARNING( "**** cookie 0x103, expected a complete dhcp frame" );
+  }
+  ForwardPacketIn( packet );
+}
+
+// cookie 0x104, dns intercept
+void tcp_session::HandleDns( Dispatcher::packet_in_t& packet ) {
+  bool bDecoded( false );
+  if ( ( protocol::ethernet::Ethertype::ipv4 == packet.idEtherType ) && packet.Complete() ) { // dns is decoded past the headers
+    protocol::ipv4::Packet ipv4( *packet.pMessage, packet.msg.total_len - ( packet.pMessage - packet.pPayload ) );
+    if ( 17 == ipv4.GetHeader().protocol ) {
+      protocol::udp::Packet udp( ipv4.GetData() );
+      LOG_TRACE( "cookie 104: {}", logging::Deferred<protocol::dns::Packet>( &udp.GetData(), Captured( packet, udp.GetData() ) ) );
+      bDecoded = true;
+    }
+  }
+  if ( !bDecoded ) {
+    LOG_WARNING( "**** cookie 0x104, expected a complete dns frame" );
+  }
+  ForwardPacketIn( packet );
+}
+
+// learn the source, then forward towards the destination
+void tcp_session::ForwardPacketIn( Dispatcher::packet_in_t& packet ) {
+  if ( codec::ofp_match::result_t::ok != packet.resultMatch ) {
+    LOG_WARNING( "**** packet_in match: {}", codec::ofp_match::Name( packet.resultMatch ) );
+  }
+  if ( !packet.fields.Has( ofp141::oxm_ofb_match_fields::OFPXMT_OFB_IN_PORT ) ) {
+    LOG_WARNING( "**** packet_in without an in_port" );
+    return;
+  }
+  LOG_TRACE( "packet_in match: {}", logging::deferred( FormatMatch, &packet.msg.match, packet.msg.match.length ) );
+
+  typedef protocol::ethernet::address MacAddress;
+
+  const nPort_t nSrcPort( packet.fields.value.in_port );
+  MacAddress macSrc( packet.ethernet.GetSrcMac() );
+  MacAddress macDst( packet.ethernet.GetDstMac() );
+
+  Bridge::MacStatus statusSrcLookup = m_bridge.Update( nSrcPort, packet.idVlan, macSrc );
+  m_bridge.Forward( nSrcPort, packet.idVlan, macSrc, macDst, Payload( packet ) );
+}
+
+void tcp_session::HandleError( ofp141::ofp_error_msg& msg ) { // v1.4.1 page 148
+  if ( m_transactions.Fail( msg ) ) return; // the request's fError reports it
+  LOG_WARNING( "error type {} code {} xid {}", (uint16_t)msg.type, (uint16_t)msg.code, (uint32_t)msg.header.xid );
+}
+
+void tcp_session::HandleFeaturesReply( ofp141::ofp_switch_features& msg ) {
+  codec::ofp_switch_features features( msg );
+  LOG_INFO( "features: datapath {} buffers {} tables {} capabilities {}",
+    logging::hex( &msg.datapath_id, sizeof( msg.datapath_id ), 0 ),
+    (uint32_t)msg.n_buffers, (uint16_t)msg.n_tables, (uint32_t)msg.capabilities );
+
+  m_nSwitchBuffers = features.Buffers();
+  m_idDatapath.store( features.DatapathId(), std::memory_order_relaxed );
+  InsertTableMiss();
+
+  // only the asynchronous messages something here consumes, 1.4.1 page 139
+  QueueTxToWrite( std::move( codec::ofp_async_config::CreateSet( std::move( GetAvailableBuffer( codec::ofp_async_config::SetSize() ) ), m_policyAsync ) ) );
+
+  // read back, to confirm the switch took it, 1.4.1 page 138
+  vByte_t v = std::move( GetAvailableBuffer( sizeof( codec::ofp_header::ofp_header_ ) ) );
+  v.resize( sizeof( codec::ofp_header::ofp_header_ ) );
+  auto* p = new( v.data() ) codec::ofp_header::ofp_header_;
+  p->init();
+  p->type = ofp141::ofp_type::OFPT_GET_ASYNC_REQUEST;
+  const codec::ofp_async_config::policy_t policy( m_policyAsync );
+  Request(
+    std::move( v ), std::chrono::milliseconds( 5000 ),
+    [policy]( const ofp141::ofp_header& header, const uint8_t* pEnd ){
+      codec::ofp_async_config::policy_t policySwitch;
+      if ( !codec::ofp_async_config::Decode( reinterpret_cast<const ofp141::ofp_async_config&>( header ), pEnd, policySwitch ) ) {
+        LOG_WARNING( "OFPT_GET_ASYNC_REPLY malformed" );
+      }
+      else {
+        if ( policy == policySwitch ) {
+          LOG_INFO( "async config set: packet_in mask {} port_status mask {} flow_removed mask {}",
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PACKET_IN_MASTER ),
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PORT_STATUS_MASTER ),
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_FLOW_REMOVED_MASTER ) );
         }
-        break;
-      case ofp141::ofp_type::OFPT_ECHO_REQUEST: {
-        std::cout
-          << "ofp141::ofp_type::OFPT_ECHO_REQUEST received/replied"
-          << std::endl;
-        const auto pEcho = new(pBegin) ofp141::ofp_header;
-        vByte_t v = std::move( GetAvailableBuffer() );
-        v.resize( sizeof( codec::ofp_header::ofp_header_ ) );
-        auto* p = new( v.data() ) codec::ofp_header::ofp_header_;
-        p->init();
-        p->type = ofp141::ofp_type::OFPT_ECHO_REPLY;
-        p->xid = pEcho->xid;
-        if ( pEcho->length != p->length ) {
-          std::cout << "Echo request len=" << pEcho->length << " reply len=" << p->length << std::endl;
-        }
-        QueueTxToWrite( std::move( v ) );
-        }
-        break;
-      case ofp141::ofp_type::OFPT_GET_ASYNC_REPLY: {
-        std::cout
-          << "ofp141::ofp_type::OFPT_GET_ASYNC_REPLY (after features_reply):"
-          << std::endl;
-        const auto pAsyncReply = new(pBegin) ofp141::ofp_async_config;
-        codec::ofp_async_config config( *pAsyncReply );
-        }
-        break;
-      case ofp141::ofp_type::OFPT_PORT_STATUS: {
-        // multiple messages stacked, so need to change code in this whole section
-        //   to sequentially parse the inbound bytes -- 2018/11/13 I think this is taken care of now
-        // TODO: use this to update the gui, to confirm what other parts of the engine are saying (ovsdb code does something similar)
-        const auto pStatus = new(pBegin) ofp141::ofp_port_status;
-        codec::ofp_port_status status( *pStatus );
-        std::cout
-          << "ofp141::ofp_type::OFPT_PORT_STATUS"
-          << std::endl;
-        }
-        break;
-      case ofp141::ofp_type::OFPT_BARRIER_REPLY: {
-        std::cout
-          << "ofp141::ofp_type::OFPT_BARRIER_REPLY"
-          << std::endl;
+        else {
+          LOG_WARNING( "async config differs from what was set: packet_in mask {} ({}) port_status mask {} ({}) flow_removed mask {} ({})",
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PACKET_IN_MASTER ),
+            policy.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PACKET_IN_MASTER ),
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PORT_STATUS_MASTER ),
+            policy.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_PORT_STATUS_MASTER ),
+            policySwitch.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_FLOW_REMOVED_MASTER ),
+            policy.Mask( ofp141::ofp_async_config_prop_type::OFPACPT_FLOW_REMOVED_MASTER ) );
         }
-        break;
-      default:
-        std::cout << "do_read unprocessed packet type: " << (uint16_t)pHeader->type << std::endl;
-        break;
-    }
+      }
+    },
+    []( const ofp141::ofp_error_msg* pMsg ){
+      if ( nullptr == pMsg ) {
+        LOG_WARNING( "OFPT_GET_ASYNC_REQUEST timed out" );
+      }
+      else {
+        LOG_WARNING( "OFPT_GET_ASYNC_REQUEST error type {} code {}", (uint16_t)pMsg->type, (uint16_t)pMsg->code );
+      }
+    } );
+
+  if ( m_pPortStats && ( 0 < m_intervalPortStats.count() ) ) {
+    StartPortStatsTimer( std::chrono::milliseconds( 0 ) );
   }
-  else {
-    //std::cout << "do_read no match on version: " << (uint16_t)pHeader->version << std::endl;
+
+  // what the switch holds already, from a previous connection
+  auto pActive = std::make_shared<uint64_t>( 0 );
+  codec::ofp_multipart::visitor_t visitor;
+  visitor.fTable = [pActive]( const ofp141::ofp_table_stats& stats ){ *pActive += stats.active_count; };
+  Dump(
+    ofp141::ofp_multipart_type::OFPMP_TABLE, visitor,
+    [pActive]( Multipart::status_t status, const Multipart::stats_t& stats ){
+      std::stringstream ss;
+      ss << status << " " << stats;
+      LOG_INFO( "table stats {}: {} flows active", ss.str(), *pActive );
+    } );
+}
+
+void tcp_session::HandleEchoRequest( ofp141::ofp_header& msg ) {
+  LOG_TRACE( "echo request xid {} replied", (uint32_t)msg.xid );
+  vByte_t v = std::move( GetAvailableBuffer( sizeof( codec::ofp_header::ofp_header_ ) ) );
+  v.resize( sizeof( codec::ofp_header::ofp_header_ ) );
+  auto* p = new( v.data() ) codec::ofp_header::ofp_header_;
+  p->init();
+  p->type = ofp141::ofp_type::OFPT_ECHO_REPLY;
+  p->xid = msg.xid;
+  if ( msg.length != p->length ) {
+    LOG_TRACE( "echo request len={} reply len={}", (uint16_t)msg.length, (uint16_t)p->length );
   }
-  //do_read();  // keep the socket open with another read
+  QueueTxToWrite( std::move( v ) );
+}
+
+void tcp_session::HandleGetAsyncReply( ofp141::ofp_async_config& msg, const uint8_t* pEnd ) {
+  if ( m_transactions.Complete( msg.header, pEnd ) ) return;
+  LOG_WARNING( "OFPT_GET_ASYNC_REPLY xid {} with no request", (uint32_t)msg.header.xid );
 }
 
+void tcp_session::HandlePortStatus( ofp141::ofp_port_status& msg ) {
+  // TODO: use this to update the gui, to confirm what other parts of the engine are saying (ovsdb code does something similar)
+  LOG_INFO( "port status: port {} {} reason {}",
+    (uint32_t)msg.desc.port_no, std::string( msg.desc.name, ::strnlen( msg.desc.name, sizeof( msg.desc.name ) ) ), (uint16_t)msg.reason );
+}
+
+void tcp_session::HandleBarrierReply( ofp141::ofp_header& msg, const uint8_t* pEnd ) {
+  if ( m_transactions.Complete( msg, pEnd ) ) return;
+  LOG_WARNING( "barrier reply xid {} with no request", (uint32_t)msg.xid );
+}
+
+// open and commit replies to the bridge's bundles, failures arrive as OFPET_BUNDLE_FAILED errors
+void tcp_session::HandleBundleControl( ofp141::ofp_bundle_ctrl_msg& msg, const uint8_t* pEnd ) {
+  if ( m_transactions.Complete( msg.header, pEnd ) ) return;
+  LOG_TRACE( "bundle {} control type {}", msg.bundle_id, msg.type );
+}
+
+// each part goes to the Multipart which asked for it, the transaction stays open until the last
+void tcp_session::HandleMultipartReply( ofp141::ofp_multipart_reply& msg, const uint8_t* pEnd ) {
+  if ( m_transactions.Complete( msg.header, pEnd, !codec::ofp_multipart::More( msg ) ) ) return;
+  LOG_WARNING( "multipart reply type {} xid {} with no request", (uint16_t)msg.type, (uint32_t)msg.header.xid );
+}
+
+// flows installed with OFPFF_SEND_FLOW_REM, v1.4.1 page 142
+void tcp_session::HandleFlowRemoved( ofp141::ofp_flow_removed& msg, const uint8_t* pEnd ) {
+  codec::ofp_flow_removed::removed_t removed;
+  const codec::ofp_match::result_t result( codec::ofp_flow_removed::Decode( msg, pEnd, removed ) );
+  if ( codec::ofp_match::result_t::ok != result ) {
+    LOG_WARNING( "flow_removed cookie {} match {}", (uint64_t)msg.cookie, codec::ofp_match::Name( result ) );
+    return;
+  }
+  if ( !m_bridge.FlowRemoved( removed ) ) {
+    LOG_TRACE(
+      "flow_removed cookie {} reason {} packets {} bytes {}",
+      removed.cookie, codec::ofp_flow_removed::Reason( removed.reason ), removed.packet_count, removed.byte_count );
+  }
+}
+
+void tcp_session::Dump(
+  ofp141::ofp_multipart_type type, const codec::ofp_multipart::visitor_t& visitor, Multipart::fDone_t fDone
+) {
+  vByte_t v = std::move( GetAvailableBuffer( codec::ofp_multipart::RequestSize( type ) ) );
+  codec::ofp_multipart::Request( v, type );
+  auto pMultipart = std::make_shared<Multipart>( type, visitor, std::move( fDone ) );
+  Request(
+    std::move( v ), std::chrono::milliseconds( multipart_timeout_ms ),
+    [pMultipart]( const ofp141::ofp_header& header, const uint8_t* pEnd ){ pMultipart->Part( header, pEnd ); },
+    [pMultipart]( const ofp141::ofp_error_msg* pMsg ){ pMultipart->Error( pMsg ); } );
+}
 
 //void tcp_session::do_write(std::size_t length) {
 //  auto self(shared_from_this());
@@ -536,30 +742,64 @@ void tcp_session::ProcessPacket( uint8_t* pBegin, const uint8_t* pEnd ) {
 void tcp_session::do_write() {
   auto self( shared_from_this() );
   //std::cout << "do_write start: " << std::endl;
-  if ( 0 == m_bufferTxQueue.Front().size() ) {
-    assert( 0 );
+
+  // drain whatever has been queued into a single gather write
+  assert( m_vTxInFlight.empty() );
+  size_t nOctets( 0 );
+  size_t nBuffers( 0 );
+  const tx_t* pFront;
+  while (
+       ( nullptr != ( pFront = m_qTx.Front() ) )
+    && ( max_gather_buffers >= ( nBuffers + pFront->Buffers() ) )
+    && ( m_vTxInFlight.empty() || ( max_gather_octets >= ( nOctets + pFront->Octets() ) ) )
+  ) {
+    LOG_TRACE( "OUT: {}", logging::hex( pFront->v.data(), pFront->v.size() ) );
+    if ( nullptr != m_pRecorder ) {
+      m_pRecorder->Record(
+        Recorder::tx, m_idSession, m_idDatapath.load( std::memory_order_relaxed ),
+        pFront->v.data(), pFront->v.size(), pFront->pPayload, pFront->nPayload );
+    }
+    nOctets += pFront->Octets();
+    nBuffers += pFront->Buffers();
+    m_vTxInFlight.emplace_back();
+    m_qTx.Pop( m_vTxInFlight.back() );
+  }
+
+  if ( m_vTxInFlight.empty() ) { // a producer has claimed a slot but not yet filled it
+    DisarmWriter();
+    return;
   }
-  if ( false ) {
-    std::cout
-      << "OUT: " << std::endl
-      << "00 01 02 03 04 05 06 07 08 09 0a 0b 0c 0d 0e 0f" << std::endl
-      << HexDump<vByte_t::const_iterator>( m_bufferTxQueue.Front().begin(), m_bufferTxQueue.Front().end() )
-      << std::endl;
+
+  m_vTxGather.clear();
+  for ( const tx_t& tx: m_vTxInFlight ) {
+    m_vTxGather.emplace_back( asio::buffer( tx.v ) );
+    if ( tx.pHolder ) {
+      m_vTxGather.emplace_back( asio::buffer( tx.pPayload, tx.nPayload ) );
+    }
+  }
+
+  m_statsTx.nWrites++;
+  m_statsTx.nMessages += m_vTxInFlight.size();
+  m_statsTx.nOctets += nOctets;
+  if ( m_statsTx.nMaxMessagesPerWrite < m_vTxInFlight.size() ) {
+    m_statsTx.nMaxMessagesPerWrite = m_vTxInFlight.size();
   }
 
   asio::async_write(
-    m_socket, boost::asio::buffer( m_bufferTxQueue.Front() ),  // rather than class variable, pass contents into lambda
+    m_socket, m_vTxGather,
       [this, self]( boost::system::error_code ec, std::size_t len )
       {
-        std::unique_lock<std::mutex> lock( m_mutex );
-        vByte_t v = std::move( m_bufferTxQueue.ObtainBuffer() );
-        v.clear();
-        m_bufferAvailable.AddBuffer( v );
-//        std::cout << "do_write atomic: " <<
-        if ( 2 <= m_transmitting.fetch_sub( 1, std::memory_order_release ) ) {
-          //std::cout << "do_write with atomic at " << m_transmitting.load( std::memory_order_acquire ) << std::endl;
-          //m_vTxInWrite = std::move( m_bufferTxQueue.ObtainBuffer() );
-          do_write();
+        for ( tx_t& tx: m_vTxInFlight ) {
+          tx.v.clear();
+          m_bufferAvailable.AddBuffer( tx.v );
+          tx.pHolder.reset(); // receive buffer can be re-used once all its holders are done
+        }
+        m_vTxInFlight.clear();
+        if ( m_qTx.Empty() ) {
+          DisarmWriter();
+        }
+        else {
+          do_write(); // more was queued while this write was in flight
         }
         //std::cout << "do_write complete:" << ec << "," << len << std::endl;
         //if (!ec) {
@@ -568,22 +808,123 @@ void tcp_session::do_write() {
       });
 }
 
-vByte_t tcp_session::GetAvailableBuffer() {
-  std::unique_lock<std::mutex> lock( m_mutex );
-  return m_bufferAvailable.ObtainBuffer();
+// release the write path, then take it straight back if something was queued
+//   by a producer which saw the writer still armed
+void tcp_session::DisarmWriter() {
+  m_bWriterArmed.store( false, std::memory_order_seq_cst );
+  std::atomic_thread_fence( std::memory_order_seq_cst ); // pairs with the fence in QueueTxToWrite
+  if ( !m_qTx.Empty() ) {
+    if ( !m_bWriterArmed.exchange( true, std::memory_order_acq_rel ) ) {
+      do_write();
+    }
+  }
+}
+
+void tcp_session::Request(
+  vByte_t v, std::chrono::milliseconds timeout,
+  Transactions::fComplete_t fComplete, Transactions::fError_t fError
+) {
+  assert( sizeof( codec::ofp_header::ofp_header_ ) <= v.size() );
+  auto* pHeader = new( v.data() ) codec::ofp_header::ofp_header_;
+  const uint32_t xid = m_transactions.NewXid();
+  pHeader->xid = xid;
+  if ( m_transactions.Track(
+    xid, ofp141::ofp_type( (uint8_t)pHeader->type ), timeout, std::move( fComplete ), fError )
+  ) {
+    QueueTxToWrite( std::move( v ) );
+  }
+  else {
+    LOG_WARNING( "transaction table full, request type {} not sent", (uint8_t)pHeader->type );
+    if ( nullptr != fError ) fError( nullptr );
+  }
+}
+
+vByte_t tcp_session::GetAvailableBuffer( size_t nOctets ) {
+  return m_bufferAvailable.ObtainBuffer( nOctets );
 }
 
-// TODO: run these methods in a strand?
 void tcp_session::QueueTxToWrite( vByte_t v ) { // TODO: look at changing to lvalue ref or rvalue ref
-  std::unique_lock<std::mutex> lock( m_mutex );
-  //std::cout << "QTTW: " << m_transmitting.load( std::memory_order_acquire ) << std::endl;
   if ( 0 == v.size() ) {
     assert( 0 );
   }
-  m_bufferTxQueue.AddBuffer( v );
-  if ( 0 == m_transmitting.fetch_add( 1, std::memory_order_acquire ) ) {
-    //std::cout << "QTTW1: " << std::endl;
+  tx_t tx( std::move( v ) );
+  QueueTxToWrite( tx );
+}
+
+void tcp_session::QueueTxToWrite( vByte_t v, const Bridge::payload_t& payload ) {
+  if ( 0 == v.size() ) {
+    assert( 0 );
+  }
+  assert( payload.pHolder );
+  tx_t tx( std::move( v ), payload );
+  QueueTxToWrite( tx );
+}
+
+void tcp_session::QueueTxToWrite( tx_t& tx ) {
+  while ( !m_qTx.Push( tx ) ) {
+    std::this_thread::yield(); // queue is full, the writer will drain it
+  }
+  std::atomic_thread_fence( std::memory_order_seq_cst ); // pairs with the fence in DisarmWriter
+  if ( !m_bWriterArmed.exchange( true, std::memory_order_acq_rel ) ) {
     do_write();
   }
 }
 
+// the switch's buffer_id is referenced when it kept the frame,
+//   otherwise the message's buffer is shared when allowed, otherwise the bridge copies the payload
+Bridge::payload_t tcp_session::Payload( const Dispatcher::packet_in_t& packet ) {
+  if ( OFP_NO_BUFFER != packet.idBuffer ) {
+    return Bridge::payload_t( nullptr, packet.pPayload, packet.nCaptured, packet.idBuffer );
+  }
+  if ( !m_bLendRxPayload ) {
+    return Bridge::payload_t( nullptr, packet.pPayload, packet.nCaptured );
+  }
+  if ( packet.pHolder ) { // already held, as by a pipeline job
+    return Bridge::payload_t( packet.pHolder, packet.pPayload, packet.nCaptured );
+  }
+  return Bridge::payload_t( m_framer.Lend(), packet.pPayload, packet.nCaptured ); // socket thread only
+}
+
+// this table miss entry then starts to generate Packet_in messages
+//   when the switch buffers, only the headers are sent up, the packet_out references the buffer_id
+void tcp_session::InsertTableMiss() {
+
+  const bool bTruncate( m_bUseSwitchBuffers && ( 0 != m_nSwitchBuffers ) );
+
+  const uint32_t idMeter( m_bridge.Meter( Bridge::MeterClass::meterMiss ) ); // installed by the bridge at hello
+
+  typedef ofp::Match<> matchMiss_t; // matches everything
+  typedef ofp::Actions<codec::ofp_flow_mod::ofp_action_output_> actionsMiss_t;
+
+  const size_t nMeter( ( 0 == idMeter ) ? 0 : sizeof( codec::ofp_flow_mod::ofp_instruction_meter_ ) );
+  const size_t nOctets( ofp::FlowModSize<matchMiss_t>( actionsMiss_t::size ) + nMeter );
+
+  vByte_t v = std::move( GetAvailableBuffer( nOctets ) );
+  ofp::Builder build( v, nOctets );
+
+  auto* pMod = build.Append<codec::ofp_flow_mod::ofp_flow_mod_>();
+  pMod->init();
+  pMod->cookie = 0x101;
+
+  if ( 0 != idMeter ) {
+    auto* pMeter = build.Append<codec::ofp_flow_mod::ofp_instruction_meter_>();
+    pMeter->init( idMeter );
+  }
+
+  auto* pActions = build.Append<codec::ofp_flow_mod::ofp_instruction_actions_>();
+  pActions->init();
+
+  auto* pAction = build.Append<codec::ofp_flow_mod::ofp_action_output_>();
+  pAction->init();  // defaults to controller
+  pAction->max_len = bTruncate ? (uint16_t)max_len_miss : (uint16_t)ofp141::ofp_controller_max_len::OFPCML_NO_BUFFER;
+
+  pActions->len = sizeof( ofp141::ofp_instruction_actions ) + actionsMiss_t::size;
+
+  pMod->header.length = nOctets;
+  assert( build.Complete() );
+
+  LOG_TRACE(
+    "Sent MissFlow flow entry ({}, meter={}, switch buffers={}): {}",
+    bTruncate ? "switch buffered" : "no buffer", idMeter, m_nSwitchBuffers, logging::hex( v.data(), v.size() ) );
+  QueueTxToWrite( std::move( v ) );
+}
@@ -9,18 +9,29 @@
 #ifndef TCP_SESSION_H
 #define TCP_SESSION_H
 
-#include <queue>
-#include <mutex>
 #include <atomic>
+#include <chrono>
+#include <memory>
 
 #include <boost/asio/ip/tcp.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/enable_shared_from_this.hpp>
 
 #include "protocol/ipv4/arp.h"
 
+#include "codecs/ofp_async_config.h"
+
 #include "common.h"
 #include "Buffer.h"
 #include "bridge.h"
+#include "framer.h"
+#include "dispatcher.h"
+#include "pipeline.h"
+#include "recorder.h"
+#include "multipart.h"
+#include "port_stats.h"
+#include "transactions.h"
+#include "bounded_queue.h"
 
 namespace asio = boost::asio;
 namespace ip = asio::ip;
@@ -30,15 +41,65 @@ class tcp_session
 {
 public:
 
-  tcp_session( Bridge& bridge, ip::tcp::socket socket);
+  tcp_session( Bridge& bridge, ip::tcp::socket socket, Recorder* pRecorder = nullptr ); // messages are recorded when supplied
   virtual ~tcp_session();
 
   void start();
 
+  // called as each inbound message finishes being handled, with the time since it was framed,
+  //   on the socket thread, or on a pipeline worker for a posted packet_in; set before start()
+  typedef std::function<void(Pipeline::clock_t::duration)> fHandled_t;
+  void SetHandled( fHandled_t f ) { m_fHandled = std::move( f ); }
+
+  // multipart request for everything of the type, records are visited as each reply part arrives,
+  //   fDone once, on the thread delivering the last part, the error, or the timeout
+  void Dump( ofp141::ofp_multipart_type, const codec::ofp_multipart::visitor_t&, Multipart::fDone_t );
+
+  // the asynchronous messages the switch is asked for with OFPT_SET_ASYNC after the features reply;
+  //   set before start()
+  static codec::ofp_async_config::policy_t DefaultAsyncPolicy();
+  void SetAsyncPolicy( const codec::ofp_async_config::policy_t& policy ) { m_policyAsync = policy; }
+
+  // interface counters, one OFPMP_PORT_STATS request for OFPP_ANY per interval,
+  //   the interval counted from the end of the previous poll, polling starts with the features reply;
+  //   fPublish gets only the ports which changed, on the socket thread; set before start()
+  //   the bridge's meters are polled with OFPMP_METER after each port poll, for what they shed
+  void SetPortStats( std::chrono::milliseconds interval, PortStats::fPublish_t );
+
+  // table miss packet_in truncated to max_len_miss, the packet_out referring to the switch's buffer_id,
+  //   when the features reply shows the switch buffers; off, full frames both ways; set before start()
+  void SetUseSwitchBuffers( bool bUseSwitchBuffers ) { m_bUseSwitchBuffers = bUseSwitchBuffers; }
+
+  // packet_in decoded and forwarded on pipeline_workers threads of their own, keyed by in_port,
+  //   rather than on the socket thread; off by default; set before start()
+  void SetPipeline( bool bPipeline ) { m_bPipeline = bPipeline; }
+
+  // a buffer, then a complete message queued for the switch, from any thread, as the bridge transmits
+  vByte_t AcquireBuffer( size_t nOctets ) { return GetAvailableBuffer( nOctets ); }
+  void Transmit( vByte_t v ) { QueueTxToWrite( std::move( v ) ); }
+
 private:
 
   enum { max_length = 65560 };  // total header and data for ipv4 is 65535
 
+  // limits on how much of the transmit queue is coalesced into one gather write
+  enum { max_gather_buffers = 64 };  // asio passes at most 64 iovecs per writev
+  enum { max_gather_octets = 256 * 1024 };
+
+  enum { max_tx_queued = 4096 }; // power of two, producers yield while it is full
+
+  enum { max_transactions = 1024 }; // requests awaiting a reply, power of two
+  enum { expire_interval_ms = 100 }; // how often overdue requests are looked for
+  enum { multipart_timeout_ms = 10000 }; // to the first reply part, then between parts
+  enum { tracked_window_ms = 1000 }; // a message answered only on failure is taken as applied after this
+
+  enum { pipeline_workers = 2 };
+  enum { pipeline_ring = 1024 }; // packet_in per worker, power of two, the socket thread yields while it is full
+
+  // octets of a table miss packet_in when the switch buffers the frame:
+  //   ethernet, 802.1q, ipv4 with options, udp, dhcp fixed fields and magic cookie (more than a dns header)
+  enum { max_len_miss = 14 + 4 + 60 + 8 + 240 };
+
 // need to use a function object instead so that the functions are embedded.
 // can be stack based function object or a heap based function object
 // supplied by the primary data structure being built
@@ -55,34 +116,125 @@ private:
   // TODO:  need a write queue, need to update the xid value in the header
   //    so, create a method or class for handling queued messages and transactions
   //void do_write( vChar_t& v );
-  void do_write();
+  void do_write(); // only called by the thread which armed the writer
+  void DisarmWriter();
 
   ip::tcp::socket m_socket;
 
-  vByte_t m_vRx;
-  vByte_t m_vReassembly;
+  Framer m_framer; // inbound octets, framed in place into complete messages
   typedef vByte_t::iterator vByte_iter_t;
 
-  // TODO: run stuff using these constructs through a strand instead
-  // TODO: given the mutex, may not need the atomic
-  std::atomic<uint32_t> m_transmitting;
+  // a queued message: the buffer, optionally followed by a payload still sitting in a receive buffer
+  struct tx_t {
+    vByte_t v;
+    std::shared_ptr<const vByte_t> pHolder; // nullptr when the buffer is the whole message
+    const uint8_t* pPayload;
+    size_t nPayload;
+    tx_t(): pPayload( nullptr ), nPayload( 0 ) {}
+    explicit tx_t( vByte_t&& v_ ): v( std::move( v_ ) ), pPayload( nullptr ), nPayload( 0 ) {}
+    tx_t( vByte_t&& v_, const Bridge::payload_t& payload )
+    : v( std::move( v_ ) ), pHolder( payload.pHolder ), pPayload( payload.pBegin ), nPayload( payload.nOctets ) {}
+    size_t Buffers() const { return pHolder ? 2 : 1; }
+    size_t Octets() const { return v.size() + nPayload; }
+  };
+
+  std::vector<tx_t> m_vTxInFlight; // queued messages taken by the current gather write
+  std::vector<asio::const_buffer> m_vTxGather;
+
+  struct tx_stats_t {
+    uint64_t nWrites;
+    uint64_t nMessages;
+    uint64_t nOctets;
+    uint64_t nMaxMessagesPerWrite;
+    tx_stats_t(): nWrites( 0 ), nMessages( 0 ), nOctets( 0 ), nMaxMessagesPerWrite( 0 ) {}
+    double MessagesPerWrite() const { return ( 0 == nWrites ) ? 0.0 : (double)nMessages / nWrites; }
+  };
+  tx_stats_t m_statsTx;
 
-  std::mutex m_mutex;
+  // multiple producers (io threads, ovsdb thread via the bridge), one consumer:
+  //   whoever flips m_bWriterArmed from false to true owns the write path
+  //   until the queue has been drained and the flag is released
+  BoundedQueue<tx_t> m_qTx;
+  std::atomic<bool> m_bWriterArmed;
 
   protocol::ipv4::arp::Cache m_arpCache;
 
-  Buffer m_bufferAvailable;
-  Buffer m_bufferTxQueue;
+  Buffer m_bufferAvailable; // thread cached, no lock required
 
   Bridge& m_bridge;
 
-  vByte_t GetAvailableBuffer(); // use std::move out of buffer
+  vByte_t GetAvailableBuffer( size_t nOctets ); // size hint, use std::move out of buffer
   void QueueTxToWrite( vByte_t );  // use std::move into buffer
+  void QueueTxToWrite( vByte_t, const Bridge::payload_t& ); // payload is gathered in behind the buffer
+  void QueueTxToWrite( tx_t& );
+
+  // requests expecting a reply: the header's xid is replaced with a tracked one, then queued;
+  //   when the table is full, nothing is sent and fError( nullptr ) is called
+  void Request(
+    vByte_t, std::chrono::milliseconds timeout,
+    Transactions::fComplete_t, Transactions::fError_t = nullptr );
+
+  Transactions m_transactions;
+  asio::steady_timer m_timerExpire;
+  void StartExpireTimer();
+
+  bool m_bLendRxPayload; // packet_out payloads are sent from the receive buffer rather than copied
+  Bridge::payload_t Payload( const Dispatcher::packet_in_t& );
+
+  Recorder* m_pRecorder;
+  const uint32_t m_idSession;
+  std::atomic<uint64_t> m_idDatapath; // from the features reply, recorded with each message
+
+  bool m_bUseSwitchBuffers; // truncate table miss packet_in, reference the switch's buffer_id in the packet_out
+  uint32_t m_nSwitchBuffers; // from the features reply, 0 falls back to full frames
+  void InsertTableMiss();
+
+  codec::ofp_async_config::policy_t m_policyAsync;
+
+  std::chrono::milliseconds m_intervalPortStats; // 0 when not polled
+  std::unique_ptr<PortStats> m_pPortStats;
+  asio::steady_timer m_timerPortStats;
+  void StartPortStatsTimer( std::chrono::milliseconds );
+  void PollPortStats();
+  void PollMeterStats();
 
   //asio::io_context::strand m_ioStrand;
 
+  Dispatcher m_dispatcher;
+
   void ProcessPacket( uint8_t* pBegin, const uint8_t* pEnd );
 
+  fHandled_t m_fHandled;
+  Pipeline::clock_t::time_point m_tpReceived; // of the message being dispatched on the socket thread
+  bool m_bPosted; // the message being dispatched was handed to the pipeline
+
+  void RegisterHandlers();
+
+  void HandleHello( ofp141::ofp_hello& );
+  void HandlePacketIn( ofp141::ofp_packet_in&, const uint8_t* pEnd );
+  void HandleError( ofp141::ofp_error_msg& );
+  void HandleFeaturesReply( ofp141::ofp_switch_features& );
+  void HandleEchoRequest( ofp141::ofp_header& );
+  void HandleGetAsyncReply( ofp141::ofp_async_config&, const uint8_t* pEnd );
+  void HandlePortStatus( ofp141::ofp_port_status& );
+  void HandleBarrierReply( ofp141::ofp_header&, const uint8_t* pEnd );
+  void HandleBundleControl( ofp141::ofp_bundle_ctrl_msg&, const uint8_t* pEnd );
+  void HandleMultipartReply( ofp141::ofp_multipart_reply&, const uint8_t* pEnd );
+  void HandleFlowRemoved( ofp141::ofp_flow_removed&, const uint8_t* pEnd );
+
+  // packet_in, by cookie
+  void HandleTableMiss( Dispatcher::packet_in_t& );
+  void HandleArp( Dispatcher::packet_in_t& );
+  void HandleDhcp( Dispatcher::packet_in_t& );
+  void HandleDns( Dispatcher::packet_in_t& );
+  void ForwardPacketIn( Dispatcher::packet_in_t& );
+
+  void DispatchPacketIn( ofp141::ofp_packet_in&, const uint8_t* pEnd, std::shared_ptr<const vByte_t> pHolder );
+
+  bool m_bPipeline; // packet_in decode and forwarding run on pipeline workers rather than the socket thread
+  std::unique_ptr<Pipeline> m_pPipeline; // from start() with m_bPipeline; last, so workers are stopped before anything they use is destroyed
+  void ProcessJob( Pipeline::job_t& );
+
 };
 
 
@@ -0,0 +1,201 @@
+/*
+ * File:   transactions.cpp
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 11:05 PM
+ */
+
+#include <cassert>
+#include <ostream>
+
+#include "transactions.h"
+
+Transactions::Transactions( size_t nCapacity )
+: m_xid( 0 ),
+  m_vEntry( nCapacity ), m_mask( nCapacity - 1 ), m_nInFlight( 0 ),
+  m_tpDeadlineEarliest( clock_t::time_point::max() ),
+  m_nUnmatched( 0 ), m_nRejected( 0 )
+{
+  assert( 0 == ( nCapacity & m_mask ) );
+}
+
+Transactions::~Transactions() {
+}
+
+size_t Transactions::Find( uint32_t xid ) const {
+  size_t ix = xid & m_mask;
+  while ( 0 != m_vEntry[ ix ].xid ) {
+    if ( xid == m_vEntry[ ix ].xid ) return ix;
+    ix = ( ix + 1 ) & m_mask;
+  }
+  return m_vEntry.size();
+}
+
+// backward shift: pull later entries of the probe sequence into the hole
+void Transactions::Remove( size_t ix ) {
+  size_t ixHole = ix;
+  size_t ixNext = ( ix + 1 ) & m_mask;
+  while ( 0 != m_vEntry[ ixNext ].xid ) {
+    const size_t ixHome = m_vEntry[ ixNext ].xid & m_mask;
+    // move when the entry's home is not in the cyclic range (ixHole, ixNext]
+    if ( ( ( ixNext - ixHome ) & m_mask ) >= ( ( ixNext - ixHole ) & m_mask ) ) {
+      m_vEntry[ ixHole ] = std::move( m_vEntry[ ixNext ] );
+      ixHole = ixNext;
+    }
+    ixNext = ( ixNext + 1 ) & m_mask;
+  }
+  m_vEntry[ ixHole ] = entry_t();
+  m_nInFlight--;
+}
+
+void Transactions::Latency( stats_t& stats, clock_t::time_point tpSent, clock_t::time_point now ) {
+  const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>( now - tpSent ).count();
+  stats.nsLatency += ns;
+  if ( stats.nsLatencyMax < ns ) stats.nsLatencyMax = ns;
+}
+
+bool Transactions::Track(
+  uint32_t xid, ofp141::ofp_type typeRequest, clock_t::duration timeout,
+  fComplete_t fComplete, fError_t fError
+) {
+  assert( 0 != ( nTracked & xid ) );
+  assert( (size_t)nTypes > (size_t)typeRequest );
+  const clock_t::time_point now = clock_t::now();
+  std::lock_guard<std::mutex> lock( m_mutex );
+  if ( ( m_nInFlight + 1 ) >= m_vEntry.size() ) { // keep a vacancy, so probes terminate
+    m_nRejected.fetch_add( 1, std::memory_order_relaxed );
+    return false;
+  }
+  size_t ix = xid & m_mask;
+  while ( 0 != m_vEntry[ ix ].xid ) {
+    assert( xid != m_vEntry[ ix ].xid );
+    ix = ( ix + 1 ) & m_mask;
+  }
+  entry_t& entry( m_vEntry[ ix ] );
+  entry.xid = xid;
+  entry.type = typeRequest;
+  entry.tpSent = now;
+  entry.tpDeadline = now + timeout;
+  entry.timeout = timeout;
+  entry.fComplete = std::move( fComplete );
+  entry.fError = std::move( fError );
+  if ( m_tpDeadlineEarliest > entry.tpDeadline ) m_tpDeadlineEarliest = entry.tpDeadline;
+  m_nInFlight++;
+  m_rStats[ typeRequest ].nRequests++;
+  return true;
+}
+
+bool Transactions::Complete( const ofp141::ofp_header& header, const uint8_t* pEnd, bool bFinal ) {
+  const uint32_t xid = header.xid;
+  if ( 0 == ( nTracked & xid ) ) return false; // not one of ours
+  fComplete_t fComplete;
+  {
+    const clock_t::time_point now = clock_t::now();
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const size_t ix = Find( xid );
+    if ( m_vEntry.size() == ix ) {
+      m_nUnmatched.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+    entry_t& entry( m_vEntry[ ix ] );
+    stats_t& stats( m_rStats[ entry.type ] );
+    if ( bFinal ) {
+      stats.nReplies++;
+      Latency( stats, entry.tpSent, now );
+      fComplete = std::move( entry.fComplete );
+      Remove( ix );
+    }
+    else {
+      fComplete = entry.fComplete; // called again for the next part
+      entry.tpDeadline = now + entry.timeout; // later than before, m_tpDeadlineEarliest remains a lower bound
+    }
+  }
+  if ( nullptr != fComplete ) fComplete( header, pEnd );
+  return true;
+}
+
+bool Transactions::Fail( const ofp141::ofp_error_msg& msg ) {
+  const uint32_t xid = msg.header.xid;
+  if ( 0 == ( nTracked & xid ) ) return false;
+  fError_t fError;
+  {
+    const clock_t::time_point now = clock_t::now();
+    std::lock_guard<std::mutex> lock( m_mutex );
+    const size_t ix = Find( xid );
+    if ( m_vEntry.size() == ix ) {
+      m_nUnmatched.fetch_add( 1, std::memory_order_relaxed );
+      return false;
+    }
+    entry_t& entry( m_vEntry[ ix ] );
+    stats_t& stats( m_rStats[ entry.type ] );
+    stats.nErrors++;
+    Latency( stats, entry.tpSent, now );
+    fError = std::move( entry.fError );
+    Remove( ix );
+  }
+  if ( nullptr != fError ) fError( &msg );
+  return true;
+}
+
+size_t Transactions::Expire( clock_t::time_point now ) {
+  std::vector<fError_t> vError;
+  {
+    std::lock_guard<std::mutex> lock( m_mutex );
+    if ( now < m_tpDeadlineEarliest ) return 0;
+    m_tpDeadlineEarliest = clock_t::time_point::max();
+    size_t ix( 0 );
+    while ( ix < m_vEntry.size() ) {
+      entry_t& entry( m_vEntry[ ix ] );
+      if ( ( 0 != entry.xid ) && ( entry.tpDeadline <= now ) ) {
+        m_rStats[ entry.type ].nTimeouts++;
+        vError.emplace_back( std::move( entry.fError ) );
+        Remove( ix ); // something else may have shifted into ix, look again
+      }
+      else {
+        if ( ( 0 != entry.xid ) && ( m_tpDeadlineEarliest > entry.tpDeadline ) ) {
+          m_tpDeadlineEarliest = entry.tpDeadline;
+        }
+        ix++;
+      }
+    }
+  }
+  for ( fError_t& fError: vError ) {
+    if ( nullptr != fError ) fError( nullptr );
+  }
+  return vError.size();
+}
+
+size_t Transactions::InFlight() const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return m_nInFlight;
+}
+
+Transactions::stats_t Transactions::Stats( ofp141::ofp_type type ) const {
+  assert( (size_t)nTypes > (size_t)type );
+  std::lock_guard<std::mutex> lock( m_mutex );
+  return m_rStats[ type ];
+}
+
+void Transactions::Stats( std::ostream& os ) const {
+  std::lock_guard<std::mutex> lock( m_mutex );
+  os << "in flight=" << m_nInFlight << ",unmatched=" << Unmatched() << ",rejected=" << Rejected();
+  for ( size_t ix = 0; ix < m_rStats.size(); ix++ ) {
+    if ( 0 != m_rStats[ ix ].nRequests ) {
+      os << "; type " << ix << ":" << m_rStats[ ix ];
+    }
+  }
+}
+
+std::ostream& operator<<( std::ostream& os, const Transactions::stats_t& stats ) {
+  const uint64_t nAnswered = stats.nReplies + stats.nErrors;
+  os
+    << "requests=" << stats.nRequests
+    << ",replies=" << stats.nReplies
+    << ",errors=" << stats.nErrors
+    << ",timeouts=" << stats.nTimeouts
+    << ",latency ns avg=" << ( ( 0 == nAnswered ) ? 0 : stats.nsLatency / nAnswered )
+    << ",latency ns max=" << stats.nsLatencyMax
+    ;
+  return os;
+}
@@ -0,0 +1,119 @@
+/*
+ * File:   transactions.h
+ * Author: Raymond Burkholder
+ *         raymond@burkholder.net
+ *
+ * Created on October 17, 2026, 11:05 PM
+ */
+
+#ifndef TRANSACTIONS_H
+#define TRANSACTIONS_H
+
+#include <array>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <iosfwd>
+#include <vector>
+#include <cstdint>
+#include <functional>
+
+#include "openflow/openflow-spec1.4.1.h"
+
+// A session's requests awaiting a reply from the switch.
+//   xids handed out here have the high bit set, codec::ofp_header::NewXid keeps to the
+//     lower half, so untracked messages on the same connection can not collide with a tracked one.
+//   requests in flight are held in an open addressed table keyed by xid (linear probing,
+//     backward shift on removal), each with a deadline, a completion and an error continuation.
+//   continuations are called without the table locked, on the thread delivering the reply,
+//     or on the thread calling Expire().
+//   request to reply latency is kept per request type.
+
+class Transactions {
+public:
+
+  typedef std::chrono::steady_clock clock_t;
+
+  // the reply, [ofp_header,pEnd)
+  typedef std::function<void(const ofp141::ofp_header&, const uint8_t* pEnd)> fComplete_t;
+  // the switch's error message, nullptr when the deadline passed first
+  typedef std::function<void(const ofp141::ofp_error_msg*)> fError_t;
+
+  struct stats_t {
+    uint64_t nRequests;
+    uint64_t nReplies;
+    uint64_t nErrors;
+    uint64_t nTimeouts;
+    uint64_t nsLatency;    // total, over replies and errors
+    uint64_t nsLatencyMax;
+    stats_t(): nRequests( 0 ), nReplies( 0 ), nErrors( 0 ), nTimeouts( 0 ), nsLatency( 0 ), nsLatencyMax( 0 ) {}
+  };
+
+  Transactions( size_t nCapacity = 1024 ); // power of two
+  virtual ~Transactions();
+
+  uint32_t NewXid() { return nTracked | ( ++m_xid & ~nTracked ); }
+
+  // false, with nothing tracked, when the table is full
+  bool Track(
+    uint32_t xid, ofp141::ofp_type typeRequest, clock_t::duration timeout,
+    fComplete_t fComplete, fError_t fError = nullptr );
+
+  // false when the xid is not in flight;
+  //   bFinal false keeps the request in flight for further replies, as with multipart,
+  //     and restarts its deadline, so the timeout bounds the gap between parts, not the whole
+  bool Complete( const ofp141::ofp_header&, const uint8_t* pEnd, bool bFinal = true );
+  bool Fail( const ofp141::ofp_error_msg& );
+
+  size_t Expire( clock_t::time_point now = clock_t::now() ); // calls fError( nullptr ) on overdue requests
+
+  size_t InFlight() const;
+  uint64_t Unmatched() const { return m_nUnmatched.load( std::memory_order_relaxed ); }
+  uint64_t Rejected() const { return m_nRejected.load( std::memory_order_relaxed ); }
+  stats_t Stats( ofp141::ofp_type ) const;
+
+  // types with any requests
+  void Stats( std::ostream& ) const;
+
+protected:
+private:
+
+  static const uint32_t nTracked = 0x80000000;
+
+  enum { nTypes = ofp141::ofp_type::OFPT_BUNDLE_ADD_MESSAGE + 1 };
+
+  struct entry_t {
+    uint32_t xid;  // 0 when vacant, tracked xids are never 0
+    ofp141::ofp_type type;
+    clock_t::time_point tpSent;
+    clock_t::time_point tpDeadline;
+    clock_t::duration timeout;
+    fComplete_t fComplete;
+    fError_t fError;
+    entry_t(): xid( 0 ), type( ofp141::ofp_type::OFPT_HELLO ) {}
+  };
+
+  std::atomic<uint32_t> m_xid;
+
+  mutable std::mutex m_mutex;
+  std::vector<entry_t> m_vEntry;
+  const size_t m_mask;
+  size_t m_nInFlight;
+  clock_t::time_point m_tpDeadlineEarliest; // Expire has nothing to do before this
+
+  std::array<stats_t,nTypes> m_rStats;
+
+  std::atomic<uint64_t> m_nUnmatched;
+  std::atomic<uint64_t> m_nRejected;
+
+  size_t Find( uint32_t xid ) const; // index, or m_vEntry.size() when absent
+  void Remove( size_t ix );
+  void Latency( stats_t&, clock_t::time_point tpSent, clock_t::time_point now );
+
+  Transactions( const Transactions& ) = delete;
+
+};
+
+std::ostream& operator<<( std::ostream&, const Transactions::stats_t& );
+
+#endif /* TRANSACTIONS_H */